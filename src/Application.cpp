@@ -51,6 +51,14 @@ void CApplication::on_activate()
   // not be found, so a C interface is used instead.
 
   g_signal_connect( this->gobj(), "shutdown", G_CALLBACK( shutdown ), this );
+
+  // The game map is saved by another thread, which uses a Dispatcher to
+  // signal the main loop once the game map file has been written.
+
+  iReadMaps = FALSE;
+
+  iSaveDispatcher.connect( sigc::mem_fun( *this,
+                                          &CApplication::On_Map_Saved ));
   
   // Create a MainWindow.  Since only a reference to this window is passed
 	// to the base class, ownership is retained by the derived class,
@@ -420,13 +428,11 @@ void CApplication::On_Maps()
 { 
 	// Save the current game map to a file, which ensures that the remaining
 	// item count shown in its map description correctly reflects the current
-	// game.
-
-	iMap->SaveFile();
-
-	// Prepare the MapsView.
+	// game.  The MapsView is prepared once the file has been written.
 
-	iMapsView->ReadMaps();
+	iReadMaps = TRUE;
+	iMap->StartSaveFile( sigc::mem_fun( iSaveDispatcher,
+	                                    &Glib::Dispatcher::emit ));
 
 	// Make the MapsView view visible.
 
@@ -523,6 +529,26 @@ void CApplication::On_Game_Load()
 	return;
 }
 
+//*---------------------------------------------------------------*
+//* This method is called once the game map file has been written *
+//* by the saving thread.                                         *
+//*---------------------------------------------------------------*
+
+void CApplication::On_Map_Saved()
+{
+  iMap->FinishSaveFile();
+
+  // Prepare the MapsView if it was waiting for the game map to be saved.
+
+  if ( iReadMaps )
+  {
+    iReadMaps = FALSE;
+    iMapsView->ReadMaps();
+  }
+
+  return;
+}
+
 //*------------------------------------------------------------------*
 //* This method is the signal handler for the game "Save" menu item. * 
 //*------------------------------------------------------------------*
@@ -532,8 +558,15 @@ void CApplication::On_Game_Save()
   Gtk::ResponseType Response = iGameDialog->Run( CGameDialog::ID::ESave );
 
   if ( Response == Gtk::RESPONSE_OK )
+  {
     iMap->Save();
 
+    // Write the saved game to the game map file while the game continues.
+
+    iMap->StartSaveFile( sigc::mem_fun( iSaveDispatcher,
+                                        &Glib::Dispatcher::emit ));
+  }
+
 	return;
 }
 
@@ -49,6 +49,7 @@ class CApplication : public Gtk::Application
     void On_Item_Selected( std::list<CMapItem>::iterator aItem );
     void On_Maps();
     void On_Map_Load( const std::string aFilename );
+    void On_Map_Saved();
     void On_About();
     void On_Help();
     void On_Settings();
@@ -88,6 +89,8 @@ class CApplication : public Gtk::Application
     int iSettingsViewNumber;                          // SettingsView page number.
     int iHelpViewNumber;                              // HelpView page number.
     gboolean iStartupScreen;                          // TRUE to show startup screen.
+    gboolean iReadMaps;                               // TRUE to read maps once saved.
+    Glib::Dispatcher iSaveDispatcher;                 // Game map saved signal.
 };
 
 #endif // __APPLICATION_H__
@@ -0,0 +1,837 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file contains the main entry point for the headless benchmark.  The
+// benchmark runs the game map model code without any game window, timing
+// map loading, object and item lookups, viewing cone filling, controller
+// execution, and image mesh decoding.  In scaling mode, generated game maps
+// of growing size are used instead, showing how each benchmark scales with
+// the number of objects.
+// Results are written to standard output in JSON format.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+#include <sys/resource.h>
+#include <gtkmm.h>
+#include "Map.h"
+#include "MapGenerator.h"
+#include "ViewCone.h"
+
+//*---------------------*
+//* Local declarations. *
+//*---------------------*
+
+#define KMapDirectory  "Maps"
+#define KIterations    3          // Default number of iterations.
+#define KLookups       100000     // Random object lookups per map.
+#define KScaleLookups  1000       // Random object lookups per generated map.
+#define KSweepPoints   64         // Viewing cone locations per map.
+#define KScaleSweep    8          // Viewing cone locations per generated map.
+#define KScans         1000       // Item and teleporter lookups per map.
+#define KScaleMinimum  1000       // Objects in smallest generated map.
+#define KRandomSeed    20210101   // Fixed seed for repeatable lookups.
+
+static const char* KScaleFilename = "enigma-bench-scaling.ewc";
+
+static const gint KDepths[] = { 2, 4, 6, 8 };
+
+// Count of C++ heap allocations made by the benchmark.  Allocations made
+// directly through GLib are not included.
+
+static guint64 Allocations = 0;
+
+//*-----------------------------------------------------------*
+//* Replacement global allocation functions, which count each *
+//* allocation before passing it on to the C library.         *
+//*-----------------------------------------------------------*
+
+void* operator new( std::size_t aSize )
+{
+  ++ Allocations;
+
+  void* Memory = std::malloc( aSize ? aSize : 1 );
+
+  if ( Memory == NULL )
+    throw std::bad_alloc();
+
+  return Memory;
+}
+
+void* operator new[]( std::size_t aSize )
+{
+  return operator new( aSize );
+}
+
+void operator delete( void* aMemory ) noexcept
+{
+  std::free( aMemory );
+  return;
+}
+
+void operator delete[]( void* aMemory ) noexcept
+{
+  std::free( aMemory );
+  return;
+}
+
+void operator delete( void* aMemory, std::size_t aSize ) noexcept
+{
+  std::free( aMemory );
+  return;
+}
+
+void operator delete[]( void* aMemory, std::size_t aSize ) noexcept
+{
+  std::free( aMemory );
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This class measures one benchmark.  The elapsed time and the *
+//* number of allocations are accumulated between each Resume()  *
+//* and Pause(), so setup work can be excluded from the results. *
+//*--------------------------------------------------------------*
+
+class CBenchmark
+{
+  public:
+    // Public methods.
+
+    CBenchmark( const std::string& aName );
+    void Resume();
+    void Pause( guint64 aOperations );
+
+    // Public data.
+
+    std::string iName;                 // Benchmark name.
+    guint64 iOperations;               // Number of operations timed.
+    gint64 iNanoseconds;               // Total elapsed time.
+    guint64 iAllocations;              // Total allocations.
+
+  private:
+    // Private data.
+
+    std::chrono::steady_clock::time_point iStartTime;
+    guint64 iStartAllocations;
+};
+
+//*------------------------*
+//* C++ constructor.       *
+//*------------------------*
+//* aName: Benchmark name. *
+//*------------------------*
+
+CBenchmark::CBenchmark( const std::string& aName )
+{
+  iName             = aName;
+  iOperations       = 0;
+  iNanoseconds      = 0;
+  iAllocations      = 0;
+  iStartAllocations = 0;
+  return;
+}
+
+//*----------------------------------------*
+//* This method starts or resumes timing.  *
+//*----------------------------------------*
+
+void CBenchmark::Resume()
+{
+  iStartAllocations = Allocations;
+  iStartTime        = std::chrono::steady_clock::now();
+  return;
+}
+
+//*------------------------------------------------------------*
+//* This method pauses timing, adding to the benchmark totals. *
+//*------------------------------------------------------------*
+//* aOperations: Number of operations since Resume().          *
+//*------------------------------------------------------------*
+
+void CBenchmark::Pause( guint64 aOperations )
+{
+  std::chrono::steady_clock::time_point StopTime =
+    std::chrono::steady_clock::now();
+
+  iNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>
+                    ( StopTime - iStartTime ).count();
+
+  iAllocations += Allocations - iStartAllocations;
+  iOperations  += aOperations;
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This function loads every game map repeatedly, both fully   *
+//* and as a summary.                                           *
+//*-------------------------------------------------------------*
+//* aFilenames:  Game map filenames.                            *
+//* aIterations: Number of times each game map is loaded.       *
+//* aResults:    Benchmark results list.                        *
+//*-------------------------------------------------------------*
+
+void BenchLoad( const std::vector<std::string>& aFilenames,
+                guint aIterations,
+                std::vector<CBenchmark>& aResults )
+{
+  std::unique_ptr<CMap> Map( new CMap );
+  std::vector<std::string>::const_iterator Filename;
+
+  aResults.emplace_back( "map_load" );
+  aResults.back().Resume();
+
+  for ( guint Count = 0; Count < aIterations; ++ Count )
+  {
+    for ( Filename = aFilenames.begin();
+          Filename != aFilenames.end();
+          ++ Filename )
+    {
+      Map->LoadFile( *Filename );
+    }
+  }
+
+  aResults.back().Pause( (guint64)aIterations * aFilenames.size() );
+
+  aResults.emplace_back( "map_summary" );
+  aResults.back().Resume();
+
+  for ( guint Count = 0; Count < aIterations; ++ Count )
+  {
+    for ( Filename = aFilenames.begin();
+          Filename != aFilenames.end();
+          ++ Filename )
+    {
+      Map->LoadSummary( *Filename );
+    }
+  }
+
+  aResults.back().Pause( (guint64)aIterations * aFilenames.size() );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This function reads objects at random locations within each *
+//* game map boundary.  A fixed seed makes the locations        *
+//* repeatable between runs.                                    *
+//*-------------------------------------------------------------*
+//* aMaps:       Loaded game maps.                              *
+//* aIterations: Number of lookup passes over each game map.    *
+//* aLookups:    Number of lookups in each pass.                *
+//* aResults:    Benchmark results list.                        *
+//*-------------------------------------------------------------*
+
+void BenchObjectRead( std::vector<std::shared_ptr<CMap>>& aMaps,
+                      guint aIterations,
+                      guint aLookups,
+                      std::vector<CBenchmark>& aResults )
+{
+  Glib::Rand Random( KRandomSeed );
+  std::vector<CMapLocation> Locations( aLookups );
+  std::list<CMapObjectList::iterator> Buffer;
+  std::vector<std::shared_ptr<CMap>>::iterator Map;
+
+  aResults.emplace_back( "object_read" );
+
+  for ( Map = aMaps.begin(); Map != aMaps.end(); ++ Map )
+  {
+    // Choose random locations within the map boundary before timing, so
+    // only the lookups themselves are measured.
+
+    const CMapLocation& Lower = (*Map)->LowerBounds();
+    const CMapLocation& Upper = (*Map)->UpperBounds();
+
+    for ( guint Index = 0; Index < aLookups; ++ Index )
+    {
+      Locations[ Index ].iEast  = Random.get_int_range( Lower.iEast,
+                                                        Upper.iEast + 1 );
+      Locations[ Index ].iNorth = Random.get_int_range( Lower.iNorth,
+                                                        Upper.iNorth + 1 );
+      Locations[ Index ].iAbove = Random.get_int_range( Lower.iAbove,
+                                                        Upper.iAbove + 1 );
+    }
+
+    aResults.back().Resume();
+
+    for ( guint Count = 0; Count < aIterations; ++ Count )
+    {
+      for ( guint Index = 0; Index < aLookups; ++ Index )
+      {
+        Buffer.clear();
+        (*Map)->Objects().Touch( Locations[ Index ], 0 );
+        (*Map)->Objects().Read( Locations[ Index ], Buffer );
+      }
+    }
+
+    aResults.back().Pause( (guint64)aIterations * aLookups );
+  }
+
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This function fills a viewing cone at evenly spaced object   *
+//* locations in each game map, looking in all six directions.   *
+//* The sweep is repeated for several viewing cone depths.       *
+//*--------------------------------------------------------------*
+//* aMaps:       Loaded game maps.                               *
+//* aIterations: Number of sweeps over each game map.            *
+//* aPoints:     Number of viewing locations in each sweep.      *
+//* aResults:    Benchmark results list.                         *
+//*--------------------------------------------------------------*
+
+void BenchViewCone( std::vector<std::shared_ptr<CMap>>& aMaps,
+                    guint aIterations,
+                    guint aPoints,
+                    std::vector<CBenchmark>& aResults )
+{
+  std::vector<std::shared_ptr<CMap>>::iterator Map;
+  std::vector<CMapLocation> Locations;
+  CMapObjectList::iterator Object;
+  CViewCone ViewCone;
+
+  for ( guint Depth = 0; Depth < G_N_ELEMENTS( KDepths ); ++ Depth )
+  {
+    ViewCone.SetDepth( KDepths[ Depth ] );
+
+    aResults.emplace_back( Glib::ustring::compose( "view_fill_depth_%1",
+                                                   KDepths[ Depth ] ));
+
+    for ( Map = aMaps.begin(); Map != aMaps.end(); ++ Map )
+    {
+      // Collect viewing locations from the map objects.
+
+      CMapObjectList& Objects = (*Map)->Objects();
+      gsize Step  = ( Objects.size() / aPoints ) + 1;
+      gsize Index = 0;
+
+      Locations.clear();
+
+      for ( Object = Objects.begin(); Object != Objects.end(); ++ Object )
+      {
+        if (( Index % Step ) == 0 )
+          Locations.push_back( (*Object).iLocation );
+
+        ++ Index;
+      }
+
+      // Move the active player through all viewing locations, filling the
+      // viewing cone in each direction.
+
+      ViewCone.SetMap( *Map );
+      std::list<CMapPlayer>::iterator Player = (*Map)->Players().GetActive();
+      guint64 Operations = 0;
+
+      aResults.back().Resume();
+
+      for ( guint Count = 0; Count < aIterations; ++ Count )
+      {
+        for ( Index = 0; Index < Locations.size(); ++ Index )
+        {
+          (*Map)->Players().Move( Player, Locations[ Index ] );
+
+          for ( int Rotation = (int)EnigmaWC::Direction::ENorth;
+                Rotation <= (int)EnigmaWC::Direction::EBelow;
+                ++ Rotation )
+          {
+            (*Player).iRotation = (EnigmaWC::Direction)Rotation;
+            ViewCone.Fill( 1 );
+            ++ Operations;
+          }
+        }
+      }
+
+      aResults.back().Pause( Operations );
+    }
+  }
+
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This function reads items and teleporters at their own       *
+//* locations, then marks items as found.  Each lookup examines  *
+//* the whole item or teleporter list, as does finding an item.  *
+//*--------------------------------------------------------------*
+//* aMaps:       Loaded game maps.                               *
+//* aIterations: Number of passes over each game map.            *
+//* aResults:    Benchmark results list.                         *
+//*--------------------------------------------------------------*
+
+void BenchItems( std::vector<std::shared_ptr<CMap>>& aMaps,
+                 guint aIterations,
+                 std::vector<CBenchmark>& aResults )
+{
+  std::vector<std::shared_ptr<CMap>>::iterator Map;
+  std::vector<std::list<CMapItem>::iterator> Items;
+  std::vector<CMapLocation> Locations;
+  std::list<std::list<CMapItem>::iterator> ItemBuffer;
+  std::list<std::list<CMapTeleporter>::iterator> TeleporterBuffer;
+  std::list<CMapItem>::iterator Item;
+  std::list<CMapTeleporter>::iterator Teleporter;
+  gsize Index;
+  gsize Step;
+
+  CBenchmark ItemRead( "item_read" );
+  CBenchmark TeleporterRead( "teleporter_read" );
+  CBenchmark ItemFound( "item_set_found" );
+
+  for ( Map = aMaps.begin(); Map != aMaps.end(); ++ Map )
+  {
+    // Collect evenly spaced items, then read items at their locations.
+
+    CMapItemList& ItemList = (*Map)->Items();
+    Step  = ( ItemList.size() / KScans ) + 1;
+    Index = 0;
+
+    Items.clear();
+    Locations.clear();
+
+    for ( Item = ItemList.begin(); Item != ItemList.end(); ++ Item )
+    {
+      if (( Index % Step ) == 0 )
+      {
+        Items.push_back( Item );
+        Locations.push_back( (*Item).iLocation );
+      }
+
+      ++ Index;
+    }
+
+    ItemRead.Resume();
+
+    for ( guint Count = 0; Count < aIterations; ++ Count )
+    {
+      for ( Index = 0; Index < Locations.size(); ++ Index )
+      {
+        ItemBuffer.clear();
+        ItemList.Read( Locations[ Index ], ItemBuffer );
+      }
+    }
+
+    ItemRead.Pause( (guint64)aIterations * Locations.size() );
+
+    // Mark the same items as found, then restart them between passes.
+
+    for ( guint Count = 0; Count < aIterations; ++ Count )
+    {
+      ItemFound.Resume();
+
+      for ( Index = 0; Index < Items.size(); ++ Index )
+        ItemList.SetFound( Items[ Index ], 0 );
+
+      ItemFound.Pause( Items.size() );
+      ItemList.Restart();
+    }
+
+    // Collect evenly spaced teleporters, then read teleporters at
+    // their locations.
+
+    CMapTeleporterList& TeleporterList = (*Map)->Teleporters();
+    Step  = ( TeleporterList.size() / KScans ) + 1;
+    Index = 0;
+
+    Locations.clear();
+
+    for ( Teleporter = TeleporterList.begin();
+          Teleporter != TeleporterList.end();
+          ++ Teleporter )
+    {
+      if (( Index % Step ) == 0 )
+        Locations.push_back( (*Teleporter).iLocation );
+
+      ++ Index;
+    }
+
+    TeleporterRead.Resume();
+
+    for ( guint Count = 0; Count < aIterations; ++ Count )
+    {
+      for ( Index = 0; Index < Locations.size(); ++ Index )
+      {
+        TeleporterBuffer.clear();
+        TeleporterList.Read( Locations[ Index ], TeleporterBuffer );
+      }
+    }
+
+    TeleporterRead.Pause( (guint64)aIterations * Locations.size() );
+  }
+
+  aResults.push_back( ItemRead );
+  aResults.push_back( TeleporterRead );
+  aResults.push_back( ItemFound );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This function runs the main bytecode of every controller in *
+//* each game map.                                              *
+//*-------------------------------------------------------------*
+//* aMaps:       Loaded game maps.                              *
+//* aIterations: Number of runs of each controller.             *
+//* aResults:    Benchmark results list.                        *
+//*-------------------------------------------------------------*
+
+void BenchControllers( std::vector<std::shared_ptr<CMap>>& aMaps,
+                       guint aIterations,
+                       std::vector<CBenchmark>& aResults )
+{
+  std::vector<std::shared_ptr<CMap>>::iterator Map;
+  std::list<CMapController>::iterator Controller;
+  guint64 Operations = 0;
+
+  aResults.emplace_back( "controller_run" );
+  aResults.back().Resume();
+
+  for ( guint Count = 0; Count < aIterations; ++ Count )
+  {
+    for ( Map = aMaps.begin(); Map != aMaps.end(); ++ Map )
+    {
+      CMapControllerList& Controllers = (*Map)->Controllers();
+
+      for ( Controller = Controllers.begin();
+            Controller != Controllers.end();
+            ++ Controller )
+      {
+        (*Controller).Run( (*Controller).iMainCode );
+        ++ Operations;
+      }
+    }
+  }
+
+  aResults.back().Pause( Operations );
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This function decodes the image meshes of the objects in each *
+//* game map, as is done by the mesh preload thread when a game   *
+//* map is played.  Copying the meshes into OpenGL buffers is not *
+//* included, since the benchmark has no OpenGL context.          *
+//*---------------------------------------------------------------*
+//* aMaps:       Loaded game maps.                                *
+//* aIterations: Number of passes over each game map.             *
+//* aResults:    Benchmark results list.                          *
+//*---------------------------------------------------------------*
+
+void BenchMeshDecode( std::vector<std::shared_ptr<CMap>>& aMaps,
+                      guint aIterations,
+                      std::vector<CBenchmark>& aResults )
+{
+  std::vector<std::shared_ptr<CMap>>::iterator Map;
+  std::vector<EnigmaWC::ID> IDs;
+  guint64 Operations = 0;
+
+  aResults.emplace_back( "mesh_decode" );
+
+  for ( Map = aMaps.begin(); Map != aMaps.end(); ++ Map )
+  {
+    (*Map)->ListIDs( IDs );
+    aResults.back().Resume();
+
+    for ( guint Count = 0; Count < aIterations; ++ Count )
+    {
+      for ( EnigmaWC::ID ID : IDs )
+      {
+        CMesh Mesh;
+        CMeshList::Decode( ID, Mesh );
+        ++ Operations;
+      }
+    }
+
+    aResults.back().Pause( Operations );
+    Operations = 0;
+  }
+
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This function writes a list of benchmark results as a JSON  *
+//* array.                                                      *
+//*-------------------------------------------------------------*
+//* aResults: Benchmark results list.                           *
+//* aIndent:  Indentation before each line.                     *
+//*-------------------------------------------------------------*
+
+void WriteBenchmarks( const std::vector<CBenchmark>& aResults,
+                      const std::string& aIndent )
+{
+  std::vector<CBenchmark>::const_iterator Result;
+
+  std::cout << "[" << std::endl;
+
+  for ( Result = aResults.begin(); Result != aResults.end(); ++ Result )
+  {
+    double Operations = (double)( Result->iOperations ? Result->iOperations
+                                                       : 1 );
+
+    std::cout << aIndent << "  { \"name\": \"" << Result->iName << "\""
+              << ", \"ops\": " << Result->iOperations
+              << ", \"ns_per_op\": " << ( Result->iNanoseconds / Operations )
+              << ", \"allocations\": " << Result->iAllocations
+              << ", \"allocations_per_op\": "
+              << ( Result->iAllocations / Operations )
+              << " }"
+              << (( Result + 1 ) != aResults.end() ? "," : "" )
+              << std::endl;
+  }
+
+  std::cout << aIndent << "]";
+  return;
+}
+
+//*-------------------------------------------------------*
+//* This function writes the benchmark results as JSON.   *
+//*-------------------------------------------------------*
+//* aMaps:       Number of game maps.                     *
+//* aIterations: Number of iterations.                    *
+//* aResults:    Benchmark results list.                  *
+//*-------------------------------------------------------*
+
+void WriteResults( gsize aMaps,
+                   guint aIterations,
+                   const std::vector<CBenchmark>& aResults )
+{
+  struct rusage Usage;
+  getrusage( RUSAGE_SELF, &Usage );
+
+  std::cout << std::fixed << std::setprecision( 2 );
+  std::cout << "{" << std::endl;
+  std::cout << "  \"maps\": " << aMaps << "," << std::endl;
+  std::cout << "  \"iterations\": " << aIterations << "," << std::endl;
+  std::cout << "  \"benchmarks\": ";
+  WriteBenchmarks( aResults, "  " );
+  std::cout << "," << std::endl;
+  std::cout << "  \"peak_rss_kb\": " << Usage.ru_maxrss << std::endl;
+  std::cout << "}" << std::endl;
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This function writes the scaling benchmark results as JSON,  *
+//* with one set of results for each generated game map.         *
+//*--------------------------------------------------------------*
+//* aObjects:    Number of objects in each generated game map.   *
+//* aIterations: Number of iterations.                           *
+//* aResults:    Benchmark results list for each game map.       *
+//*--------------------------------------------------------------*
+
+void WriteScaling( const std::vector<gsize>& aObjects,
+                   guint aIterations,
+                   const std::vector<std::vector<CBenchmark>>& aResults )
+{
+  struct rusage Usage;
+  getrusage( RUSAGE_SELF, &Usage );
+
+  std::cout << std::fixed << std::setprecision( 2 );
+  std::cout << "{" << std::endl;
+  std::cout << "  \"iterations\": " << aIterations << "," << std::endl;
+  std::cout << "  \"scaling\": [" << std::endl;
+
+  for ( gsize Index = 0; Index < aResults.size(); ++ Index )
+  {
+    std::cout << "    { \"objects\": " << aObjects[ Index ] << ","
+              << std::endl;
+    std::cout << "      \"benchmarks\": ";
+    WriteBenchmarks( aResults[ Index ], "      " );
+    std::cout << " }"
+              << (( Index + 1 ) < aResults.size() ? "," : "" )
+              << std::endl;
+  }
+
+  std::cout << "  ]," << std::endl;
+  std::cout << "  \"peak_rss_kb\": " << Usage.ru_maxrss << std::endl;
+  std::cout << "}" << std::endl;
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This function runs all benchmarks on generated game maps,    *
+//* from a small map up to the largest, with ten times as many   *
+//* objects in each map as the last.  Each map is saved to a     *
+//* temporary file so its loading can be timed too.              *
+//*--------------------------------------------------------------*
+//* aMaximum:    Largest number of objects.                      *
+//* aIterations: Number of iterations.                           *
+//* RETURN:      Program exit status.                            *
+//*--------------------------------------------------------------*
+
+int BenchScaling( guint64 aMaximum, guint aIterations )
+{
+  std::string Filename = Glib::build_filename( Glib::get_tmp_dir(),
+                                               KScaleFilename );
+  std::vector<std::string> Filenames( 1, Filename );
+  std::vector<std::vector<CBenchmark>> Results;
+  std::vector<gsize> Objects;
+
+  for ( guint64 Total = KScaleMinimum; Total <= aMaximum; Total *= 10 )
+  {
+    // Generate the game map, and save it through the normal game map
+    // writer.  The generated map is released before the saved map is
+    // loaded for benchmarking.
+
+    std::shared_ptr<CMap> Map( new CMap );
+    CMapGenerator Generator;
+
+    Generator.SetObjects( Total );
+    Generator.Generate( *Map );
+    Map->SetFileName( Filename );
+
+    if ( !Map->SaveFile( Filename ))
+    {
+      std::cerr << Filename << ": could not be written" << std::endl;
+      return 1;
+    }
+
+    Map->Clear();
+
+    // Run all benchmarks on the saved game map.
+
+    Results.emplace_back();
+    BenchLoad( Filenames, aIterations, Results.back() );
+
+    Map->LoadFile( Filename );
+    std::vector<std::shared_ptr<CMap>> Maps( 1, Map );
+
+    BenchObjectRead( Maps, aIterations, KScaleLookups, Results.back() );
+    BenchViewCone( Maps, aIterations, KScaleSweep, Results.back() );
+    BenchItems( Maps, aIterations, Results.back() );
+    BenchControllers( Maps, aIterations, Results.back() );
+
+    Objects.push_back( Map->Objects().size() );
+  }
+
+  std::remove( Filename.c_str() );
+
+  WriteScaling( Objects, aIterations, Results );
+  return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+  // Read the optional iteration count and scaling limit, followed by
+  // optional game map filenames.  All game maps in the game map directory
+  // are used if no filenames are given.
+
+  guint Iterations = KIterations;
+  guint64 Maximum  = 0;
+  gboolean Valid   = TRUE;
+  int Argument     = 1;
+
+  while (( Argument + 1 < argc ) && ( argv[ Argument ][ 0 ] == '-' ))
+  {
+    if ( g_strcmp0( argv[ Argument ], "-n" ) == 0 )
+      Iterations = (guint)g_ascii_strtoull( argv[ Argument + 1 ], NULL, 10 );
+    else if ( g_strcmp0( argv[ Argument ], "-s" ) == 0 )
+    {
+      Maximum = g_ascii_strtoull( argv[ Argument + 1 ], NULL, 10 );
+      Valid   = ( Maximum >= KScaleMinimum );
+    }
+    else
+      Valid = FALSE;
+
+    Argument += 2;
+  }
+
+  if ( !Valid
+    || ( Iterations == 0 )
+    || (( Argument < argc ) && ( argv[ Argument ][ 0 ] == '-' ))
+    || (( Argument < argc ) && ( Maximum != 0 )))
+  {
+    std::cerr << "Usage: " << argv[ 0 ] << " [-n ITERATIONS] [MAP...]"
+              << std::endl;
+    std::cerr << "       " << argv[ 0 ] << " [-n ITERATIONS] -s MAXIMUM"
+              << std::endl;
+    std::cerr << "Benchmark game map loading, object and item lookups,"
+              << " viewing cone filling," << std::endl;
+    std::cerr << "controller execution, and image mesh decoding.  Results are"
+              << " written as JSON." << std::endl;
+    std::cerr << "With -s, generated game maps of " << KScaleMinimum
+              << " up to MAXIMUM objects are used." << std::endl;
+    return 2;
+  }
+
+  if ( Maximum != 0 )
+    return BenchScaling( Maximum, Iterations );
+
+  std::vector<std::string> Filenames;
+
+  if ( Argument < argc )
+    Filenames.assign( argv + Argument, argv + argc );
+  else
+  {
+    try
+    {
+      Glib::Dir Directory( KMapDirectory );
+      Glib::DirIterator Entry;
+
+      for ( Entry = Directory.begin(); Entry != Directory.end(); ++ Entry )
+        Filenames.push_back( Glib::build_filename( KMapDirectory, *Entry ));
+    }
+    catch( Glib::Error error )
+    {
+    }
+
+    std::sort( Filenames.begin(), Filenames.end() );
+  }
+
+  // Load all valid game maps for the query benchmarks.  Invalid files are
+  // dropped so every benchmark uses the same set of game maps.
+
+  std::vector<std::shared_ptr<CMap>> Maps;
+  std::vector<std::string> Loaded;
+  std::vector<std::string>::iterator Filename;
+
+  for ( Filename = Filenames.begin(); Filename != Filenames.end(); ++ Filename )
+  {
+    std::shared_ptr<CMap> Map( new CMap );
+    Map->LoadFile( *Filename );
+
+    if ( Map->GetLoaded() )
+    {
+      Maps.push_back( Map );
+      Loaded.push_back( *Filename );
+    }
+    else
+      std::cerr << *Filename << ": not a valid game map" << std::endl;
+  }
+
+  if ( Maps.empty() )
+  {
+    std::cerr << "No game maps found." << std::endl;
+    return 1;
+  }
+
+  // Run all benchmarks, then report the results.
+
+  std::vector<CBenchmark> Results;
+
+  BenchLoad( Loaded, Iterations, Results );
+  BenchObjectRead( Maps, Iterations, KLookups, Results );
+  BenchViewCone( Maps, Iterations, KSweepPoints, Results );
+  BenchItems( Maps, Iterations, Results );
+  BenchControllers( Maps, Iterations, Results );
+  BenchMeshDecode( Maps, Iterations, Results );
+
+  WriteResults( Maps.size(), Iterations, Results );
+  return 0;
+}
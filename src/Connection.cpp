@@ -45,63 +45,88 @@ CConnection::CConnection()
 //* This method establishes a connection to a fully-qualified map controller *
 //* signal name (eg. "Controller:Signal").  Even if the connection could not *
 //* be established, the signal name is saved for later retrieval when the    *
-//* map is saved.                                                            *
+//* map is saved.  The name is examined in place, so it may point directly   *
+//* into a game map file buffer.  The controller symbol table must have been *
+//* built with CMapControllerList::Index().                                  *
 //*--------------------------------------------------------------------------*
 //* aControllers: List of map controllers.                                   *
-//* aName:        Signal name.                                               *
+//* aName:        Signal name (need not be terminated).                      *
+//* aLength:      Signal name length.                                        *
 //*--------------------------------------------------------------------------*
 
 void CConnection::Connect( CMapControllerList& aControllers,
-                           const std::string& aName )
+                           const gchar* aName,
+                           gsize aLength )
+{
+  Disconnect();
+
+  // If the name consists only of the "T" character, set the local state to
+  // TRUE.  Otherwise, the local state remains FALSE (name either consists
+  // of only the "F" character, or cannot be connected to a controller).
+
+  if (( aLength == 1 ) && ( aName[ 0 ] == 'T' ))
+    iState = TRUE;
+
+  // Share the interned name record, which is looked up in the controller
+  // symbol table only the first time the name is used.
+
+  iName = aControllers.Intern( aName, aLength );
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This method establishes a connection using a name record     *
+//* that has already been interned (eg. while reading an indexed *
+//* game map file).                                              *
+//*--------------------------------------------------------------*
+//* aName: Interned signal name record.                          *
+//*--------------------------------------------------------------*
+
+void CConnection::Connect( const CMapControllerList::CSignalName* aName )
 {
   Disconnect();
   iName = aName;
-  
-  // Locate the character separating the controller and signal name.
-  
-  std::string::size_type Separator = aName.find( ':', 0 );
+  return;
+}
 
-  if ( Separator == std::string::npos )
-  {
-    // The string name does not have a separator character.  If the name
-    // consists only of the "T" character, set the local state to TRUE.
-    // Otherwise, set the local state to FALSE (name either consists of
-    // only the "F" character, or is missing its map controller name).
-    
-    if ( aName == "T" )
-      iState = TRUE;
-  }
-  else
-  {
-    // The string name does have a separator character.  Search for the
-    // controller name in the list.
-
-    std::string String = aName.substr( 0, Separator ); 
-
-    for ( iController = aControllers.begin();
-          iController != aControllers.end();
-          iController ++ )
-    {
-      if ( String == (*iController).iName )
-        break;
-    }
-    
-    if ( iController != aControllers.end() )
-    {
-      // The named map controller was found, and an iterator to it has been
-      // stored.  Now find the named signal in this map controller.
-      
-      iSignal = (*iController).GetSignalIndex( aName.substr( Separator + 1,
-                                               aName.size() - Separator )); 
-
-      // If the signal name could not be found in the controller, the signal
-      // index will be G_MAXUINT16 to indicate an unconnected connection.
-    }
-  }
-  
+//*---------------------------------------------------------------*
+//* This method restores a connection from an interned name       *
+//* record and an unconnected local state, such as those kept for *
+//* a packed map object.  The signal generation is not changed.   *
+//*---------------------------------------------------------------*
+//* aName:  Interned signal name record, or NULL if unnamed.      *
+//* aState: Unconnected local state.                              *
+//*---------------------------------------------------------------*
+
+void CConnection::Restore( const CMapControllerList::CSignalName* aName,
+                           gboolean aState )
+{
+  iName  = aName;
+  iState = aState;
   return;
 }
 
+//*--------------------------------------------------------------*
+//* This method returns the interned signal name record.         *
+//*--------------------------------------------------------------*
+//* RETURN: Interned signal name record, or NULL if unnamed.     *
+//*--------------------------------------------------------------*
+
+const CMapControllerList::CSignalName* CConnection::Interned() const
+{
+  return iName;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the local state, which is the connection *
+//* state if the connection is not connected to a controller.    *
+//*--------------------------------------------------------------*
+
+gboolean CConnection::GetLocalState() const
+{
+  return iState;
+}
+
 //*---------------------------------------------------------------*
 //* This method clears the signal name and returns the connection *
 //* to a disconnected state.                                      *
@@ -109,9 +134,8 @@ void CConnection::Connect( CMapControllerList& aControllers,
 
 void CConnection::Disconnect()
 {
-  iName.clear();
-  iSignal = G_MAXUINT16;
-  iState  = FALSE;
+  iName  = NULL;
+  iState = FALSE;
   return;
 }
 
@@ -121,16 +145,37 @@ void CConnection::Disconnect()
 
 gboolean CConnection::Connected()
 {
-  return ( iSignal != G_MAXUINT16 );
+  return (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ));
+}
+
+//*---------------------------------------------------------------*
+//* This method returns the connected map controller.  The result *
+//* is only valid if the connection is connected.                 *
+//*---------------------------------------------------------------*
+
+std::list<CMapController>::iterator CConnection::Controller()
+{
+  return iName->iController;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the connected map controller signal      *
+//* index, or G_MAXUINT16 if the connection is not connected.    *
+//*--------------------------------------------------------------*
+
+guint16 CConnection::Signal()
+{
+  return ( iName != NULL ) ? iName->iSignal : G_MAXUINT16;
 }
 
 //*----------------------------------------------------------------*
 //* This method returns a reference to the connection signal name. *
 //*----------------------------------------------------------------*
 
-std::string& CConnection::Name()
+const std::string& CConnection::Name() const
 {
-  return iName;
+  static const std::string Empty;
+  return ( iName != NULL ) ? iName->iName : Empty;
 }
 
 //*------------------------------------------------------*
@@ -144,13 +189,13 @@ gboolean CConnection::SetState( gboolean aState )
 {
   gboolean Change;
 
-  if ( iSignal != G_MAXUINT16 )
+  if (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ))
   {
     // The connection is connected to a controller.  Set the signal
     // state in the controller, which will return TRUE if the signal
     // state changed.
     
-    Change = (*iController).SetSignalState( iSignal, aState );
+    Change = (*iName->iController).SetSignalState( iName->iSignal, aState );
   }
   else
   {
@@ -159,6 +204,9 @@ gboolean CConnection::SetState( gboolean aState )
     
     Change = ( iState != aState );
     iState = aState;
+
+    if ( Change )
+      CMapController::NextGeneration();
   }
   
   return Change;
@@ -173,8 +221,125 @@ gboolean CConnection::GetState() const
   // If the connection is connected to a controller, return the signal
   // state from the controller.  Otherwise, return the local state.
 
-  if ( iSignal != G_MAXUINT16 )
-    return (*iController).GetSignalState( iSignal );
+  if (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ))
+    return (*iName->iController).GetSignalState( iName->iSignal );
   else
     return iState;
 }
+
+//*---------------------------------------------------------------*
+//* ConnectionRef constructor.  The connection refers to a signal *
+//* name and local state bit held by a packed map object.         *
+//*---------------------------------------------------------------*
+//* aName:   Interned signal name record, or NULL if unnamed.     *
+//* aStates: Packed local states of the map object.               *
+//* aMask:   Bit of the local state within aStates.               *
+//*---------------------------------------------------------------*
+
+CConnectionRef::CConnectionRef( const CMapControllerList::CSignalName* aName,
+                                guint8& aStates,
+                                guint8 aMask )
+  : iName( aName ), iStates( aStates ), iMask( aMask )
+{
+  return;
+}
+
+//*------------------------------------------------------*
+//* This method sets the state of the connection signal. *
+//*------------------------------------------------------*
+//* aState: Connection state to be set.                  *
+//* RETURN: TRUE if the signal state changed.            *
+//*------------------------------------------------------*
+
+gboolean CConnectionRef::SetState( gboolean aState )
+{
+  // A connection to a controller sets the controller signal.  Otherwise,
+  // the local state bit is set.
+
+  if (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ))
+    return (*iName->iController).SetSignalState( iName->iSignal, aState );
+
+  gboolean Change = ( ( ( iStates & iMask ) != 0 ) != ( aState != FALSE ));
+
+  if ( aState )
+    iStates |= iMask;
+  else
+    iStates &= ~iMask;
+
+  if ( Change )
+    CMapController::NextGeneration();
+
+  return Change;
+}
+
+//*---------------------------------------------------------*
+//* This method returns the state of the connection signal. *
+//*---------------------------------------------------------*
+
+gboolean CConnectionRef::GetState() const
+{
+  if (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ))
+    return (*iName->iController).GetSignalState( iName->iSignal );
+  else
+    return (( iStates & iMask ) != 0 );
+}
+
+//*----------------------------------------------------------------*
+//* This method returns a reference to the connection signal name. *
+//*----------------------------------------------------------------*
+
+const std::string& CConnectionRef::Name() const
+{
+  static const std::string Empty;
+  return ( iName != NULL ) ? iName->iName : Empty;
+}
+
+//*----------------------------------------------------------------------*
+//* This method returns TRUE if the signal is connected to a controller. *
+//*----------------------------------------------------------------------*
+
+gboolean CConnectionRef::Connected()
+{
+  return (( iName != NULL ) && ( iName->iSignal != G_MAXUINT16 ));
+}
+
+//*---------------------------------------------------------------*
+//* This method returns the connected map controller.  The result *
+//* is only valid if the connection is connected.                 *
+//*---------------------------------------------------------------*
+
+std::list<CMapController>::iterator CConnectionRef::Controller()
+{
+  return iName->iController;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the connected map controller signal      *
+//* index, or G_MAXUINT16 if the connection is not connected.    *
+//*--------------------------------------------------------------*
+
+guint16 CConnectionRef::Signal()
+{
+  return ( iName != NULL ) ? iName->iSignal : G_MAXUINT16;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the interned signal name record.         *
+//*--------------------------------------------------------------*
+//* RETURN: Interned signal name record, or NULL if unnamed.     *
+//*--------------------------------------------------------------*
+
+const CMapControllerList::CSignalName* CConnectionRef::Interned() const
+{
+  return iName;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the local state, which is the connection *
+//* state if the connection is not connected to a controller.    *
+//*--------------------------------------------------------------*
+
+gboolean CConnectionRef::GetLocalState() const
+{
+  return (( iStates & iMask ) != 0 );
+}
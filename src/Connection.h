@@ -2,7 +2,8 @@
 // Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
 // 
 // This file is the Connection class header.  The Connection class handles
-// a connection to a map controller.
+// a connection to a map controller.  The ConnectionRef class handles the
+// same connection for an object packed in a MapObjectList.
 //
 // This program is free software: you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -31,19 +32,55 @@ class CConnection
     CConnection();
     gboolean SetState( gboolean aState );
     gboolean GetState() const;
-    std::string& Name();
+    const std::string& Name() const;
     gboolean Connected();
     void Disconnect();
     void Connect( CMapControllerList& aControllers,
-                  const std::string& aName );
+                  const gchar* aName,
+                  gsize aLength );
+
+    void Connect( const CMapControllerList::CSignalName* aName );
+
+    void Restore( const CMapControllerList::CSignalName* aName,
+                  gboolean aState );
+
+    const CMapControllerList::CSignalName* Interned() const;
+    gboolean GetLocalState() const;
+
+    std::list<CMapController>::iterator Controller();
+    guint16 Signal();
 
   private:
     // Private data.
     
-    std::string iName;                                // Connection signal name.
-    std::list<CMapController>::iterator iController;  // Controller iterator.
-    guint16 iSignal;                                  // Controller signal index.
+    const CMapControllerList::CSignalName* iName;     // Interned signal name.
     gboolean iState;                                  // Unconnected local state.
 };
 
+class CConnectionRef
+{ 
+  public:		
+    // Public methods.
+    
+    CConnectionRef( const CMapControllerList::CSignalName* aName,
+                    guint8& aStates,
+                    guint8 aMask );
+
+    gboolean SetState( gboolean aState );
+    gboolean GetState() const;
+    const std::string& Name() const;
+    gboolean Connected();
+    std::list<CMapController>::iterator Controller();
+    guint16 Signal();
+    const CMapControllerList::CSignalName* Interned() const;
+    gboolean GetLocalState() const;
+
+  private:
+    // Private data.
+    
+    const CMapControllerList::CSignalName* iName;     // Interned signal name.
+    guint8& iStates;                                  // Packed local states.
+    guint8 iMask;                                     // Local state bit.
+};
+
 #endif // __CONNECTION_H__
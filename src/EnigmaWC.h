@@ -19,6 +19,8 @@
 #ifndef __ENIGMAWC_H__
 #define __ENIGMAWC_H__
 
+#include <glib.h>
+
 namespace EnigmaWC
 {
   enum class Key        // Key definitions.
@@ -58,7 +60,7 @@ namespace EnigmaWC
     TOTAL
   };
 
-  enum class ID         // Object, Item, Player ID key values.
+  enum class ID : guint8  // Object, Item, Player ID key values.
   {
     ENone = 0,
     EWineCellar,
@@ -143,7 +145,7 @@ namespace EnigmaWC
     TOTAL
   };
 
-  enum class Direction  // Object surface and rotation key values.
+  enum class Direction : guint8  // Object surface and rotation key values.
   {
     ENone = 0,
     ENorth,
@@ -156,7 +158,7 @@ namespace EnigmaWC
     TOTAL
   };
 
-  enum class Category   // Item category key values.
+  enum class Category : guint8   // Item category key values.
   {
     ENone = 0,
     ERequired,          // Item is required.
@@ -711,7 +711,7 @@ void CInventoryView::On_Row_Activated( const Gtk::TreeModelFilter::Path& aPath,
         // of the selected item.
 
         Item = Row[ iColumnRecord.iItem ];
-        (*(*Item)).iOwner = (*iOtherPlayer).iNumber;
+        iMap->Items().SetOwner( *Item, (*iOtherPlayer).iNumber );
 
         // If an InnerTube or HydrogenBalloon item was given to another
         // player, update the InnerTube and HydrogenBalloon selected state
@@ -17,10 +17,129 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <unordered_map>
 #include "EnigmaWC.h"
 #include "Map.h"
 #include "Connection.h"
 
+// Indexed game map (.ewcx) layout.  All values are little-endian.  A fixed
+// header is followed by a section directory, with each directory entry
+// holding a section key, file offset, and size.
+
+static const char* KIndexedCode      = "ewcx";
+static const char* KIndexedExtension = ".ewcx";
+
+#define KIndexedVersion       1
+#define KIndexedSections      7
+#define KIndexedHeaderSize    24
+#define KIndexedEntrySize     12
+#define KIndexedSavable       ( 1 << 0 )   // Header flag bits.
+#define KIndexedBounded       ( 1 << 1 )
+
+#define KObjectRecordSize     28           // Fixed record sizes.
+#define KTeleporterRecordSize 36
+#define KItemRecordSize       36
+#define KPlayerRecordSize     48
+
+#define KUnconnected          G_MAXUINT32  // Connection codes.
+#define KNamedConnection      0x80000000
+
+#define KItemActive           ( 1 << 0 )   // Item record flag bits.
+#define KItemActiveSaved      ( 1 << 1 )
+#define KItemActiveRestart    ( 1 << 2 )
+#define KItemSelected         ( 1 << 3 )
+#define KItemSelectedSaved    ( 1 << 4 )
+#define KItemSelectedRestart  ( 1 << 5 )
+#define KItemUsed             ( 1 << 6 )
+#define KItemUsedSaved        ( 1 << 7 )
+#define KItemUsedRestart      ( 1 << 8 )
+
+#define KPlayerActive         ( 1 << 0 )   // Player record flag bits.
+#define KPlayerActiveSaved    ( 1 << 1 )
+#define KPlayerActiveRestart  ( 1 << 2 )
+#define KPlayerOutdoor        ( 1 << 3 )
+#define KPlayerOutdoorSaved   ( 1 << 4 )
+#define KPlayerOutdoorRestart ( 1 << 5 )
+
+// Indexed game maps with more structural objects than the stream budget
+// are streamed one map region at a time, keeping only recently used
+// regions in memory.
+
+#define KStreamBudget         262144       // Resident objects when streaming.
+
+// Saving a game map over its own file appends the changed item, player,
+// and controller records to a journal beside it.  The journal is compacted
+// back into the game map file once it becomes large.
+
+static const char* KJournalCode      = "ewcj";
+static const char* KJournalExtension = ".journal";
+
+#define KJournalVersion       1
+#define KJournalHeaderSize    24
+#define KJournalLimit         262144       // Journal size before compaction.
+#define KJournalRecordSize    5            // Journal record key and index.
+#define KJournalItemSize      4            // Fixed journal record data sizes.
+#define KJournalPlayerSize    17
+
+//*---------------------------------------------------------------*
+//* This private class holds a copy of the game map state that    *
+//* changes during a game.  A game map file is written from the   *
+//* copy, so a game can continue while the file is being written. *
+//*---------------------------------------------------------------*
+
+class CMapSnapshot
+{
+  public:
+    void Take( CMap& aMap );
+
+    std::vector<std::string> iCurrentCodes;   // Controller signal states.
+    std::vector<std::string> iSavedCodes;     // Controller saved states.
+    std::list<CMapPlayer> iPlayers;           // Player states.
+    std::list<CMapItem> iItems;               // Item states.
+};
+
+//*---------------------------------------------------------------*
+//* This private class describes a save being written, which is   *
+//* either a block appended to the journal, or a complete game    *
+//* map file.                                                     *
+//*---------------------------------------------------------------*
+
+class CSaveJob
+{
+  public:
+    std::string iFileName;            // Game map filename.
+    gboolean iJournal;                // TRUE if writing to the journal.
+    gboolean iBase;                   // TRUE if writing over the game map.
+    gboolean iAppend;                 // TRUE if appending to the journal.
+    std::string iFileData;            // Journal data to be written.
+    CMapSnapshot iSnapshot;           // Game map state to be written.
+    gboolean iWritten;                // TRUE once successfully written.
+};
+
+//*-----------------------------------------------------------*
+//* This method copies the changing state of a game map.      *
+//*-----------------------------------------------------------*
+//* aMap: Game map.                                           *
+//*-----------------------------------------------------------*
+
+void CMapSnapshot::Take( CMap& aMap )
+{
+  // The signal states of every controller are copied as bytecode, which
+  // is how they are stored in a game map file.
+
+  for ( CMapController& Controller : aMap.Controllers() )
+  {
+    iCurrentCodes.emplace_back();
+    Controller.CreateSignalCode( iCurrentCodes.back() );
+    iSavedCodes.push_back( Controller.iSavedCode );
+  }
+
+  iPlayers.assign( aMap.Players().begin(), aMap.Players().end() );
+  iItems.assign( aMap.Items().begin(), aMap.Items().end() );
+  return;
+}
+
 //*----------------------*
 //* Default constructor. *
 //*----------------------*
@@ -29,6 +148,21 @@ CMap::CMap()
 {	
   // Initialize instance data.
 
+  iSummary      = FALSE;
+  iStreamBudget = KStreamBudget;
+  iMappedFile   = NULL;
+  Clear();
+  return;
+}
+
+//*---------------------*
+//* Default destructor. *
+//*---------------------*
+
+CMap::~CMap()
+{
+  // Release the game map file of a streamed map.
+
   Clear();
   return;
 }
@@ -78,6 +212,66 @@ CMapPlayerList& CMap::Players()
   return iPlayers;
 }
 
+//*---------------------------------------------------------------*
+//* This method returns a reference to the MapBricks, which are   *
+//* built again whenever the structural objects have changed.     *
+//*---------------------------------------------------------------*
+
+CMapBricks& CMap::Bricks()
+{
+  if ( iBricks.GetVersion() != iObjects.GetVersion() )
+    iBricks.Build( iObjects, iTeleporters, iItems );
+
+  return iBricks;
+}
+
+//*------------------------------------------------------------*
+//* This method lists the IDs of all objects, teleporters,     *
+//* items, and players in the game map.  Each ID is listed     *
+//* once, in ID order.  The objects of a streamed map are      *
+//* listed from all object records, not just loaded regions.   *
+//*------------------------------------------------------------*
+//* aIDs: Buffer to receive IDs.                               *
+//*------------------------------------------------------------*
+
+void CMap::ListIDs( std::vector<EnigmaWC::ID>& aIDs )
+{
+  gboolean Present[ (int)EnigmaWC::ID::TOTAL ] = { FALSE };
+
+  for ( CMapObjectList::CObject Object : iObjects )
+    Present[ (int)Object.iID ] = TRUE;
+
+  // The ID is the first byte of each object record.  Damaged records are
+  // skipped when their regions are read, so their IDs are ignored here.
+
+  for ( guint32 Index = 0; Index < iObjectTotal; ++ Index )
+  {
+    guint8 ID = iObjectRecords[ (gsize)Index * KObjectRecordSize ];
+
+    if ( ID < (guint8)EnigmaWC::ID::TOTAL )
+      Present[ ID ] = TRUE;
+  }
+
+  for ( CMapTeleporter& Teleporter : iTeleporters )
+    Present[ (int)Teleporter.iID ] = TRUE;
+
+  for ( CMapItem& Item : iItems )
+    Present[ (int)Item.iID ] = TRUE;
+
+  for ( CMapPlayer& Player : iPlayers )
+    Present[ (int)Player.iID ] = TRUE;
+
+  aIDs.clear();
+
+  for ( gint ID = 0; ID < (int)EnigmaWC::ID::TOTAL; ++ ID )
+  {
+    if ( Present[ ID ] )
+      aIDs.push_back( (EnigmaWC::ID)ID );
+  }
+
+  return;
+}
+
 //*---------------------------------------------------------*
 //* This method returns a reference to the map description. *
 //*---------------------------------------------------------*
@@ -93,14 +287,19 @@ std::string& CMap::Description()
 
 void CMap::Clear()
 {
+  // Wait for a save still being written from the game map.
+
+  FinishSaveFile();
+
   // Clear all data storage.
 
   iFileName.clear();
-  iControllers.clear();
+  iControllers.Clear();
   iObjects.Clear();
   iTeleporters.Clear();
   iItems.Clear();
   iPlayers.Clear();
+  iBricks.Clear();
   iDescription.clear();
 
   // Initialize map variables.
@@ -110,6 +309,24 @@ void CMap::Clear()
   iLowerBounds.Clear();
   iUpperBounds.Clear();
 
+  // Stop streaming map regions, and release the game map file.
+
+  iDecoder.reset();
+  iObjectRecords = NULL;
+  iObjectTotal   = 0;
+
+  // Forget the game map file identity recorded for its journal.
+
+  iBaseSize     = -1;
+  iBaseModified = -1;
+  iJournalSize  = 0;
+
+  if ( iMappedFile != NULL )
+  {
+    g_mapped_file_unref( iMappedFile );
+    iMappedFile = NULL;
+  }
+
   return;
 }
 
@@ -127,6 +344,20 @@ gboolean CMap::GetLoaded()
   return ( iFileName.size() != 0 );
 }
 
+//*----------------------------------------------------------------*
+//* This method sets the game map filename.  It is used for a game *
+//* map built in memory rather than loaded from a file, so the     *
+//* game map is considered loaded and can be saved.                *
+//*----------------------------------------------------------------*
+//* aFileName: Game map filename.                                  *
+//*----------------------------------------------------------------*
+
+void CMap::SetFileName( const std::string& aFileName )
+{
+  iFileName = aFileName;
+  return;
+}
+
 //*----------------------------------------*
 //* This method return the Savable state.  *
 //*----------------------------------------*
@@ -142,26 +373,29 @@ gboolean CMap::GetSavable()
 //* This private function returns the number of bytes in a string line *
 //* of a line ending with the newline '\n' or \x00 characters.         *  
 //*--------------------------------------------------------------------*
-//* RETURN: Line length, or zero if no line is available.              *
+//* aSource: Game map data.                                            *
+//* aSize:   Game map data size.                                       *
+//* aIndex:  Index to first character in line.                         *
+//* RETURN:  Line length, or zero if no line is available.             *
 //*--------------------------------------------------------------------*
 
-guint FindLine( std::string& aSource, guint aIndex )
+gsize FindLine( const guint8* aSource, gsize aSize, gsize aIndex )
 {
   // Count the number of characters before the line terminator.
   
-  guint Index = aIndex;
+  gsize Index = aIndex;
   
-  while (( Index < aSource.size() )
-    && ( aSource.at( Index ) != '\n' )
-    && ( aSource.at( Index ) != '\x00' ))
+  while (( Index < aSize )
+    && ( aSource[ Index ] != '\n' )
+    && ( aSource[ Index ] != '\x00' ))
   {
     ++ Index;
   }
 
   // Include the line terminator in the final count, unless the end  of the
-  // source string has been reached.
+  // source data has been reached.
 
-  if ( Index >= aSource.size() )
+  if ( Index >= aSize )
     return ( Index - aIndex );
   else
     return ( 1 + Index - aIndex );
@@ -211,21 +445,94 @@ void CMap::Save()
   return;
 }
 
+//*-------------------------------------------------------------*
+//* This private function skips over an element in new version  *
+//* game map data without recording any of its information.  It *
+//* is used when only a game map summary is being read.         *
+//*-------------------------------------------------------------*
+//* aFileData: Keyvalue stream.                                 *
+//* aFileSize: Keyvalue stream size.                            *
+//* aIndex:    KeyValue index.                                  *
+//* RETURN:    FALSE if the keyvalue stream is truncated.       *
+//*-------------------------------------------------------------*
+
+gboolean SkipElement( const guint8* aFileData,
+                      gsize aFileSize,
+                      gsize& aIndex )
+{
+  // Skip the element header keyvalue.
+
+  aIndex += 2;
+
+  // Skip keyvalues until an element header or keyvalue sequence terminator
+  // is encountered.  Only connection names have data following a keyvalue.
+
+  EnigmaWC::Key Key;
+  guint8 Value;
+  gboolean Done = FALSE;
+
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
+  {
+    Key   = (EnigmaWC::Key)aFileData[ aIndex ];
+    Value = aFileData[ aIndex + 1 ];
+
+    switch( Key )
+    {
+      case EnigmaWC::Key::ESense:
+      case EnigmaWC::Key::EState:
+      case EnigmaWC::Key::EVisibility:
+      case EnigmaWC::Key::EPresence:
+        // A connection name follows this keyvalue pair.  Value has the
+        // name's length.
+
+        aIndex += 2;
+
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
+        aIndex += Value;
+        break;
+
+      case EnigmaWC::Key::EObject:
+      case EnigmaWC::Key::ETeleporter:
+      case EnigmaWC::Key::EPlayer:
+      case EnigmaWC::Key::EItem:
+      case EnigmaWC::Key::EDescription:
+      case EnigmaWC::Key::EController:
+      case EnigmaWC::Key::EEnd:
+        // An element keyvalue or array end keyvalue has been encountered.
+        // Leave the array index on this keyvalue.
+
+        Done = TRUE;
+        break;
+
+      default:
+        aIndex += 2;
+        break;
+    }
+  }
+
+  return TRUE;
+}
+
 //*-------------------------------------------------------------*
 //* This private function extracts a MapObject from new version *
 //* game map data.                                              *
 //*-------------------------------------------------------------*
 //* aFileData:    Keyvalue stream.                              *
+//* aFileSize:    Keyvalue stream size.                         *
 //* aIndex:       KeyValue index.                               *
 //* aControllers: Reference to map controller list.             *
 //* aObject:      Reference to MapObject.                       *
 //* RETURN:       MapObject filled with keyvalue information.   *
+//*               FALSE if the keyvalue stream is truncated.    *
 //*-------------------------------------------------------------*
 
-void ExtractNewObject( const std::string& aFileData,
-                       guint& aIndex,
-                       CMapControllerList& aControllers,
-                       CMapObject& aObject )
+gboolean ExtractNewObject( const guint8* aFileData,
+                           gsize aFileSize,
+                           gsize& aIndex,
+                           CMapControllerList& aControllers,
+                           CMapObject& aObject )
 {
   // Clear all Object connections, but leave intact the remaining
   // information from a previous Object.  This allows minimizing
@@ -244,7 +551,7 @@ void ExtractNewObject( const std::string& aFileData,
   // Record information from the header keyvalue.
   
   ++ aIndex;
-  aObject.iID = (EnigmaWC::ID)aFileData.at( aIndex );
+  aObject.iID = (EnigmaWC::ID)aFileData[ aIndex ];
   ++ aIndex;
   
   // Record Object information from the keyvalue stream until an element
@@ -256,12 +563,12 @@ void ExtractNewObject( const std::string& aFileData,
   guint16 HighValue;
   gboolean Done = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
     
     switch( Key )
@@ -309,8 +616,12 @@ void ExtractNewObject( const std::string& aFileData,
         // An object Sense connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iSense.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -318,8 +629,12 @@ void ExtractNewObject( const std::string& aFileData,
         // An object State connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
         
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iState.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
          
         aIndex += Value;
         break;
@@ -328,8 +643,12 @@ void ExtractNewObject( const std::string& aFileData,
         // An object Visibility connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iVisibility.Connect( aControllers,
-                                     aFileData.substr( aIndex, Value ));
+                                     (const gchar*)aFileData + aIndex,
+                                     Value );
         aIndex += Value;
         break;
         
@@ -337,8 +656,12 @@ void ExtractNewObject( const std::string& aFileData,
         // An object Presence connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
         
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iPresence.Connect( aControllers,
-                                   aFileData.substr( aIndex, Value ));
+                                   (const gchar*)aFileData + aIndex,
+                                   Value );
         
         aIndex += Value;
         break;
@@ -362,7 +685,7 @@ void ExtractNewObject( const std::string& aFileData,
     }
   }
   
-  return;
+  return TRUE;
 }
 
 //*-----------------------------------------------------------------*
@@ -370,16 +693,19 @@ void ExtractNewObject( const std::string& aFileData,
 //* game map data.                                                  *
 //*-----------------------------------------------------------------*
 //* aFileData:    Keyvalue stream.                                  *
+//* aFileSize:    Keyvalue stream size.                             *
 //* aIndex:       KeyValue index.                                   *
 //* aControllers: Reference to map controller list.                 *
 //* aObject:      Reference to MapTeleporter.                       *
 //* RETURN:       MapTeleporter filled with keyvalue information.   *
+//*               FALSE if the keyvalue stream is truncated.        *
 //*-----------------------------------------------------------------*
 
-void ExtractNewTeleporter( const std::string& aFileData,
-                           guint& aIndex,
-                           CMapControllerList& aControllers,
-                           CMapTeleporter& aObject )
+gboolean ExtractNewTeleporter( const guint8* aFileData,
+                               gsize aFileSize,
+                               gsize& aIndex,
+                               CMapControllerList& aControllers,
+                               CMapTeleporter& aObject )
 {
   // Initialize all Object connections.
   
@@ -407,7 +733,7 @@ void ExtractNewTeleporter( const std::string& aFileData,
   // Record information from the header keyvalue.
   
   ++ aIndex;
-  aObject.iID = (EnigmaWC::ID)aFileData.at( aIndex );
+  aObject.iID = (EnigmaWC::ID)aFileData[ aIndex ];
   ++ aIndex;
   
   // Record Object information from the keyvalue stream until an element
@@ -420,12 +746,12 @@ void ExtractNewTeleporter( const std::string& aFileData,
   guint16 HighValue;
   gboolean Done = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
 
     switch( Key )
@@ -523,8 +849,12 @@ void ExtractNewTeleporter( const std::string& aFileData,
         // An object Sense connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iSense.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -532,8 +862,12 @@ void ExtractNewTeleporter( const std::string& aFileData,
         // An object State connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iState.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -541,8 +875,12 @@ void ExtractNewTeleporter( const std::string& aFileData,
         // An object Visibility connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iVisibility.Connect( aControllers,
-                                     aFileData.substr( aIndex, Value ));
+                                     (const gchar*)aFileData + aIndex,
+                                     Value );
         aIndex += Value;
         break;
         
@@ -550,8 +888,12 @@ void ExtractNewTeleporter( const std::string& aFileData,
         // An object Presence connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
         
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iPresence.Connect( aControllers,
-                                   aFileData.substr( aIndex, Value ));
+                                   (const gchar*)aFileData + aIndex,
+                                   Value );
         
         aIndex += Value;
         break;
@@ -575,7 +917,7 @@ void ExtractNewTeleporter( const std::string& aFileData,
     }
   }
   
-  return;
+  return TRUE;
 }
 
 //*-----------------------------------------------------------*
@@ -583,18 +925,21 @@ void ExtractNewTeleporter( const std::string& aFileData,
 //* game map data.                                            *
 //*-----------------------------------------------------------*
 //* aFileData:    Keyvalue stream.                            *
+//* aFileSize:    Keyvalue stream size.                       *
 //* aIndex:       KeyValue index.                             *
 //* aControllers: Reference to map controller list.           *
 //* aObject:      Reference to MapItem.                       *
 //* aSavable:     Reference to Savable map control.           *
 //* RETURN:       MapItem filled with keyvalue information.   *
+//*               FALSE if the keyvalue stream is truncated.  *
 //*-----------------------------------------------------------*
 
-void ExtractNewItem( const std::string& aFileData,
-                     guint& aIndex,
-                     CMapControllerList& aControllers,
-                     CMapItem& aObject,
-                     gboolean& aSavable )
+gboolean ExtractNewItem( const guint8* aFileData,
+                         gsize aFileSize,
+                         gsize& aIndex,
+                         CMapControllerList& aControllers,
+                         CMapItem& aObject,
+                         gboolean& aSavable )
 {
   // Clear all Object connections, but leave intact the remaining
   // information from a previous Object.  This allows minimizing
@@ -613,7 +958,7 @@ void ExtractNewItem( const std::string& aFileData,
   // Record information from the header keyvalue.
   
   ++ aIndex;
-  aObject.iID = (EnigmaWC::ID)aFileData.at( aIndex );
+  aObject.iID = (EnigmaWC::ID)aFileData[ aIndex ];
   ++ aIndex;
   
   // Record Object information from the keyvalue stream until an element
@@ -626,12 +971,12 @@ void ExtractNewItem( const std::string& aFileData,
   guint16 HighValue;
   gboolean Done = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
     
     switch( Key )
@@ -752,8 +1097,12 @@ void ExtractNewItem( const std::string& aFileData,
         // An object Sense connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iSense.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -761,8 +1110,12 @@ void ExtractNewItem( const std::string& aFileData,
         // An object State connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iState.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -770,8 +1123,12 @@ void ExtractNewItem( const std::string& aFileData,
         // An object Visibility connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iVisibility.Connect( aControllers,
-                                     aFileData.substr( aIndex, Value ));
+                                     (const gchar*)aFileData + aIndex,
+                                     Value );
         aIndex += Value;
         break;
         
@@ -779,8 +1136,12 @@ void ExtractNewItem( const std::string& aFileData,
         // An object Presence connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iPresence.Connect( aControllers,
-                                   aFileData.substr( aIndex, Value ));
+                                   (const gchar*)aFileData + aIndex,
+                                   Value );
         aIndex += Value;
         break;
       
@@ -803,7 +1164,7 @@ void ExtractNewItem( const std::string& aFileData,
     }
   }
   
-  return;
+  return TRUE;
 }
 
 //*-------------------------------------------------------------*
@@ -811,18 +1172,21 @@ void ExtractNewItem( const std::string& aFileData,
 //* game map data.                                              *
 //*-------------------------------------------------------------*
 //* aFileData:    Keyvalue stream.                              *
+//* aFileSize:    Keyvalue stream size.                         *
 //* aIndex:       KeyValue index.                               *
 //* aControllers: Reference to map controller list.             *
 //* aObject:      Reference to MapPlayer.                       *
 //* aSavable:     Reference to Savable map control.             *
 //* RETURN:       MapPlayer filled with keyvalue information.   *
+//*               FALSE if the keyvalue stream is truncated.    *
 //*-------------------------------------------------------------*
 
-void ExtractNewPlayer( const std::string& aFileData,
-                       guint& aIndex,
-                       CMapControllerList& aControllers,
-                       CMapPlayer& aObject,
-                       gboolean& aSavable )
+gboolean ExtractNewPlayer( const guint8* aFileData,
+                           gsize aFileSize,
+                           gsize& aIndex,
+                           CMapControllerList& aControllers,
+                           CMapPlayer& aObject,
+                           gboolean& aSavable )
 {
   // Clear all Object connections, but leave intact the remaining
   // information from a previous Object.  This allows minimizing
@@ -841,7 +1205,7 @@ void ExtractNewPlayer( const std::string& aFileData,
   // Record information from the header keyvalue.
   
   ++ aIndex;
-  aObject.iID = (EnigmaWC::ID)aFileData.at( aIndex );
+  aObject.iID = (EnigmaWC::ID)aFileData[ aIndex ];
   ++ aIndex;
   
   // Record Object information from the keyvalue stream until an element
@@ -854,12 +1218,12 @@ void ExtractNewPlayer( const std::string& aFileData,
   guint16 HighValue;
   gboolean Done = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
 
     switch( Key )
@@ -1024,8 +1388,12 @@ void ExtractNewPlayer( const std::string& aFileData,
         // An object Sense connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iSense.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -1033,8 +1401,12 @@ void ExtractNewPlayer( const std::string& aFileData,
         // An object State connection name follows this keyvalue pair.  Value
         // has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iState.Connect( aControllers,
-                                aFileData.substr( aIndex, Value ));
+                                (const gchar*)aFileData + aIndex,
+                                Value );
         aIndex += Value;
         break;
         
@@ -1042,8 +1414,12 @@ void ExtractNewPlayer( const std::string& aFileData,
         // An object Visibility connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iVisibility.Connect( aControllers,
-                                     aFileData.substr( aIndex, Value ));
+                                     (const gchar*)aFileData + aIndex,
+                                     Value );
         aIndex += Value;
         break;
         
@@ -1051,8 +1427,12 @@ void ExtractNewPlayer( const std::string& aFileData,
         // An object Presence connection name follows this keyvalue pair.
         // Value has the name's length.  Connect the object to a controller.
 
+        if ( Value > ( aFileSize - aIndex ))
+          return FALSE;
+
         aObject.iPresence.Connect( aControllers,
-                                   aFileData.substr( aIndex, Value ));
+                                   (const gchar*)aFileData + aIndex,
+                                   Value );
         aIndex += Value;
         break;
       
@@ -1075,7 +1455,7 @@ void ExtractNewPlayer( const std::string& aFileData,
     }
   }
   
-  return;
+  return TRUE;
 }
 
 //*---------------------------------------------------------------*
@@ -1083,14 +1463,17 @@ void ExtractNewPlayer( const std::string& aFileData,
 //* game map data.                                                *
 //*---------------------------------------------------------------*
 //* aFileData: Keyvalue stream.                                   *
+//* aFileSize: Keyvalue stream size.                              *
 //* aIndex:    KeyValue index.                                    *
 //* aObject:   Reference to string buffer.                        *
 //* RETURN:    String buffer filled with description text.        *
+//*            FALSE if the keyvalue stream is truncated.         *
 //*---------------------------------------------------------------*
 
-void ExtractNewDescription( const std::string& aFileData,
-                       guint& aIndex,
-                       std::string& aDescription )
+gboolean ExtractNewDescription( const guint8* aFileData,
+                                gsize aFileSize,
+                                gsize& aIndex,
+                                std::string& aDescription )
 {
   // Skip over the header keyvalue.  At present, the language value
   // is ignored.
@@ -1106,12 +1489,12 @@ void ExtractNewDescription( const std::string& aFileData,
   guint16 Length = 0;
   gboolean Done  = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
 
     switch( Key )
@@ -1124,7 +1507,10 @@ void ExtractNewDescription( const std::string& aFileData,
       case EnigmaWC::Key::EData:
         // The keyvalue is followed by a block of description data.
         
-        aDescription = aFileData.substr( aIndex, Length );
+        if ( Length > ( aFileSize - aIndex ))
+          return FALSE;
+
+        aDescription.assign( (const gchar*)aFileData + aIndex, Length );
         aIndex += Length;
         break;
         
@@ -1157,7 +1543,7 @@ void ExtractNewDescription( const std::string& aFileData,
     }
   }
   
-  return;
+  return TRUE;
 }
 
 //*--------------------------------------------------------------*
@@ -1165,23 +1551,29 @@ void ExtractNewDescription( const std::string& aFileData,
 //* game map data.                                               *
 //*--------------------------------------------------------------*
 //* aFileData: Keyvalue stream.                                  *
+//* aFileSize: Keyvalue stream size.                             *
 //* aIndex:    KeyValue index.                                   *
 //* aObject:   Reference to MapController.                       *
 //* RETURN:    MapController filled with keyvalue information.   *
+//*            FALSE if the keyvalue stream is truncated.        *
 //*--------------------------------------------------------------*
 
-void ExtractNewController( const std::string& aFileData,
-                           guint& aIndex,
-                           CMapController& aController )
+gboolean ExtractNewController( const guint8* aFileData,
+                               gsize aFileSize,
+                               gsize& aIndex,
+                               CMapController& aController )
 {
   // A controller name follows the new element keyvalue pair.
   // Prepare the controller to receive new information.
  
   ++ aIndex;
-  guint8 Value = aFileData.at( aIndex );
+  guint8 Value = aFileData[ aIndex ];
   ++ aIndex;
   
-  aController.iName = aFileData.substr( aIndex, Value );
+  if ( Value > ( aFileSize - aIndex ))
+    return FALSE;
+
+  aController.iName.assign( (const gchar*)aFileData + aIndex, Value );
   aController.iSignalNames.resize(0);
   aController.iRestartCode.resize(0);
   aController.iMainCode.resize(0);
@@ -1194,15 +1586,16 @@ void ExtractNewController( const std::string& aFileData,
   EnigmaWC::Key BankState = EnigmaWC::Key::ENone;
   EnigmaWC::Key DataState = EnigmaWC::Key::ENone;
   EnigmaWC::Key Key;
+  const gchar* Data;
   guint16 Length = 0;
   gboolean Done  = FALSE;
   
-  while ((( aFileData.size() - aIndex ) >= 2 ) && !Done )
+  while ((( aFileSize - aIndex ) >= 2 ) && !Done )
   {
-    Key = (EnigmaWC::Key)aFileData.at( aIndex );
+    Key = (EnigmaWC::Key)aFileData[ aIndex ];
     aIndex ++;
 
-    Value = aFileData.at( aIndex );
+    Value = aFileData[ aIndex ];
     aIndex ++;
 
     switch( Key )
@@ -1236,16 +1629,21 @@ void ExtractNewController( const std::string& aFileData,
       case EnigmaWC::Key::EData:
         // The keyvalue is followed by a block of data.
 
+        if ( Length > ( aFileSize - aIndex ))
+          return FALSE;
+
+        Data = (const gchar*)aFileData + aIndex;
+
         if ( DataState == EnigmaWC::Key::ECode )
-          aController.iMainCode.assign( aFileData, aIndex, Length );
+          aController.iMainCode.assign( Data, Length );
         else if ( DataState == EnigmaWC::Key::ECurrent )
-          aController.iCurrentCode.assign( aFileData, aIndex, Length );
+          aController.iCurrentCode.assign( Data, Length );
         else if ( DataState == EnigmaWC::Key::ESaved )
-          aController.iSavedCode.assign( aFileData, aIndex, Length );
+          aController.iSavedCode.assign( Data, Length );
         else if ( DataState == EnigmaWC::Key::ERestart )
-          aController.iRestartCode.assign( aFileData, aIndex, Length );
+          aController.iRestartCode.assign( Data, Length );
         else if ( DataState == EnigmaWC::Key::ESignal )
-          aController.iSignalNames.assign( aFileData, aIndex, Length );
+          aController.iSignalNames.assign( Data, Length );
         
         // Move the array index over the data block.
         
@@ -1270,6 +1668,8 @@ void ExtractNewController( const std::string& aFileData,
         break;
     }
   }
+
+  return TRUE;
 }
 
 //*---------------------------------------------------------------*
@@ -1333,57 +1733,89 @@ const CMapLocation& CMap::LowerBounds()
   return iLowerBounds;
 }
 
-//*-------------------------------*
-//* Load a game map from a file.  *
-//*-------------------------------*
-//* aFileName: Game map filename. *
-//*-------------------------------*
+//*--------------------------------------------------------------*
+//* This method sets the number of structural objects an indexed *
+//* game map may have before it is streamed.  A budget of zero   *
+//* disables streaming.  The budget applies to game maps loaded  *
+//* afterwards, and also limits the objects kept in memory.      *
+//*--------------------------------------------------------------*
+//* aBudget: Structural object budget.                           *
+//*--------------------------------------------------------------*
 
-void CMap::LoadFile( const std::string& aFileName )
+void CMap::SetStreamBudget( gsize aBudget )
 {
-  // Prepare an empty game map.
-	
-  Clear();
-  
-  // Load game map file.  Return if unsuccessful.
+  iStreamBudget = aBudget;
+  return;
+}
 
-  std::string FileData;
-  
-  try
-  {
-    FileData = Glib::file_get_contents( aFileName );
-  }
-    catch( Glib::Error error )
-  {
+//*--------------------------------------------------------------*
+//* This method keeps the map regions around a viewing location  *
+//* and all players resident in a streamed game map, then evicts *
+//* the least recently used regions to stay within budget.  Any  *
+//* held object iterators outside these regions become invalid.  *
+//*--------------------------------------------------------------*
+//* aLocation: Viewing location.                                 *
+//* aReach:    Number of rooms visible around the location.      *
+//*--------------------------------------------------------------*
+
+void CMap::Stream( const CMapLocation& aLocation, guint16 aReach )
+{
+  if ( !iObjects.GetStreamed() )
     return;
+
+  // The rooms around every player are examined whenever a player is
+  // prepared or moved, so their regions must stay resident.
+
+  std::list<CMapPlayer>::iterator Player;
+
+  for ( Player = iPlayers.begin(); Player != iPlayers.end(); ++ Player )
+  {
+    iObjects.Touch( (*Player).iLocation, 1 );
+    iObjects.Touch( (*Player).iLocationNext, 1 );
   }
-  
-  // Return immediately if the first line of the game map file does not have
+
+  iObjects.Touch( aLocation, aReach );
+  iObjects.Trim( iStreamBudget );
+  return;
+}
+
+//*----------------------------------------------------------------*
+//* This private method reads a game map from keyvalue array data. *
+//*----------------------------------------------------------------*
+//* aFileData: Game map file data.                                 *
+//* aFileSize: Game map file data size.                            *
+//* RETURN:    TRUE if the game map data was valid.                *
+//*----------------------------------------------------------------*
+
+gboolean CMap::ReadKeyValueData( const guint8* aFileData, gsize aFileSize )
+{
+  // Return immediately if the first line of the game map data does not have
   // the proper indentification code.
 
-  if ( !FileData.compare( "ewc\n" ) )
-    return;
+  if (( aFileSize < 4 ) || ( memcmp( aFileData, "ewc\n", 4 ) != 0 ))
+    return FALSE;
 
   // Confirm that the file header has the correct ending.
 
-  guint Index = 0;
-  guint Size  = 0;
-  guint FoundHeader;
+  gsize Index = 0;
+  gsize Size  = 0;
+  gboolean FoundHeader;
   
   do
   {
-    Size        = FindLine( FileData, Index );
-    FoundHeader = FileData.compare( Index, Size, "end_header\n" );
+    Size        = FindLine( aFileData, aFileSize, Index );
+    FoundHeader = (( Size == 11 )
+                && ( memcmp( aFileData + Index, "end_header\n", 11 ) == 0 ));
     Index += Size;
   }
-  while (( Size != 0 ) && ( FoundHeader != 0 ));
+  while (( Size != 0 ) && !FoundHeader );
   
-	// Return immediately if the end of the header was not found.  Otherwise,
+  // Return immediately if the end of the header was not found.  Otherwise,
   // the index now points to the beginning of a KeyValue array (key and
   // value byte pairs) describing the map.
   
-  if ( FoundHeader != 0 )
-    return;
+  if ( !FoundHeader )
+    return FALSE;
 
   // Initialize a MapObject to receive keyvalue array information.
 
@@ -1441,11 +1873,15 @@ void CMap::LoadFile( const std::string& aFileName )
 
   CMapPlayer Player;
   
-  Player.iID           = EnigmaWC::ID::ENone;
-  Player.iSurface      = EnigmaWC::Direction::ENone;
-  Player.iRotation     = EnigmaWC::Direction::ENone;
-  Player.iSurfaceNext  = EnigmaWC::Direction::ENone;
-  Player.iRotationNext = EnigmaWC::Direction::ENone;
+  Player.iID              = EnigmaWC::ID::ENone;
+  Player.iSurface         = EnigmaWC::Direction::ENone;
+  Player.iRotation        = EnigmaWC::Direction::ENone;
+  Player.iSurfaceSaved    = EnigmaWC::Direction::ENone;
+  Player.iRotationSaved   = EnigmaWC::Direction::ENone;
+  Player.iSurfaceRestart  = EnigmaWC::Direction::ENone;
+  Player.iRotationRestart = EnigmaWC::Direction::ENone;
+  Player.iSurfaceNext     = EnigmaWC::Direction::ENone;
+  Player.iRotationNext    = EnigmaWC::Direction::ENone;
 
   Player.iLocation.Clear();  
   Player.iLocationSaved.Clear();
@@ -1469,25 +1905,48 @@ void CMap::LoadFile( const std::string& aFileName )
   
   gboolean ValidData = TRUE;
   gboolean Done      = FALSE;
+  gboolean Indexed   = FALSE;
   EnigmaWC::Key Key;
   guint8 Value;
   
-  while ((( FileData.size() - Index ) >= 2 ) && !Done )
+  while ((( aFileSize - Index ) >= 2 ) && !Done )
   {
     // A complete keyvalue pair is available.  Read the keyvalue,
     // but keep the keyvalue array index on the element header. 
   
-    Key   = (EnigmaWC::Key)FileData.at( Index );
-    Value = (guint8)FileData.at( Index + 1 );
+    Key   = (EnigmaWC::Key)aFileData[ Index ];
+    Value = aFileData[ Index + 1 ];
+
+    // Controllers come before all other elements.  Build the controller
+    // symbol table once they have all been read, so connections in the
+    // remaining elements are resolved without searching.
+
+    if (( Key != EnigmaWC::Key::EController ) && !Indexed )
+    {
+      iControllers.Index();
+      Indexed = TRUE;
+    }
     
     switch( Key )
     {      
       case EnigmaWC::Key::EObject:
-        // An Object element header has been encountered.
-        
-        ExtractNewObject( FileData, Index, iControllers, Object );
+        // An Object element header has been encountered.  Objects are not
+        // needed in a game map summary.
         
-        if  (( (int)Object.iID < (int)EnigmaWC::ID::TOTAL )
+        if ( iSummary )
+        {
+          if ( !SkipElement( aFileData, aFileSize, Index ))
+          {
+            ValidData = FALSE;
+            Done      = TRUE;
+          }
+        }
+        else if  ( ExtractNewObject( aFileData,
+                                aFileSize,
+                                Index,
+                                iControllers,
+                                Object )
+          && ( (int)Object.iID < (int)EnigmaWC::ID::TOTAL )
           && ( (int)Object.iSurface < (int)EnigmaWC::Direction::TOTAL )
           && ( (int)Object.iRotation < (int)EnigmaWC::Direction::TOTAL ))
         {            
@@ -1509,11 +1968,23 @@ void CMap::LoadFile( const std::string& aFileName )
         break;
         
       case EnigmaWC::Key::ETeleporter:
-        // An Object element header has been encountered.
+        // An Object element header has been encountered.  Teleporters are
+        // not needed in a game map summary.
         
-        ExtractNewTeleporter( FileData, Index, iControllers, Teleporter );
-        
-        if  (( (int)Teleporter.iID < (int)EnigmaWC::ID::TOTAL )
+        if ( iSummary )
+        {
+          if ( !SkipElement( aFileData, aFileSize, Index ))
+          {
+            ValidData = FALSE;
+            Done      = TRUE;
+          }
+        }
+        else if  ( ExtractNewTeleporter( aFileData,
+                                    aFileSize,
+                                    Index,
+                                    iControllers,
+                                    Teleporter )
+          && ( (int)Teleporter.iID < (int)EnigmaWC::ID::TOTAL )
           && ( (int)Teleporter.iSurface < (int)EnigmaWC::Direction::TOTAL )
           && ( (int)Teleporter.iRotation < (int)EnigmaWC::Direction::TOTAL )
           && ( (int)Teleporter.iSurfaceArrival < (int)EnigmaWC::Direction::TOTAL )
@@ -1540,9 +2011,13 @@ void CMap::LoadFile( const std::string& aFileName )
       case EnigmaWC::Key::EItem:
         // An Item element header has been encountered.
         
-        ExtractNewItem( FileData, Index, iControllers, Item, iSavable );
-        
-        if  (( (int)Item.iID < (int)EnigmaWC::ID::TOTAL )
+        if  ( ExtractNewItem( aFileData,
+                              aFileSize,
+                              Index,
+                              iControllers,
+                              Item,
+                              iSavable )
+          && ( (int)Item.iID < (int)EnigmaWC::ID::TOTAL )
           && ( (int)Item.iSurface < (int)EnigmaWC::Direction::TOTAL )
           && ( (int)Item.iRotation < (int)EnigmaWC::Direction::TOTAL ))
         {            
@@ -1566,9 +2041,13 @@ void CMap::LoadFile( const std::string& aFileName )
       case EnigmaWC::Key::EPlayer:
         // A Player element header has been encountered.
         
-        ExtractNewPlayer( FileData, Index, iControllers, Player, iSavable );
-        
-        if  (( (int)Player.iID < (int)EnigmaWC::ID::TOTAL )
+        if  ( ExtractNewPlayer( aFileData,
+                                aFileSize,
+                                Index,
+                                iControllers,
+                                Player,
+                                iSavable )
+          && ( (int)Player.iID < (int)EnigmaWC::ID::TOTAL )
           && ( (int)Player.iSurface < (int)EnigmaWC::Direction::TOTAL )
           && ( (int)Player.iRotation < (int)EnigmaWC::Direction::TOTAL ))
         {            
@@ -1593,23 +2072,45 @@ void CMap::LoadFile( const std::string& aFileName )
       case EnigmaWC::Key::EDescription:
         // A Description element header has been encountered.
         
-        ExtractNewDescription( FileData, Index, iDescription );
+        if ( !ExtractNewDescription( aFileData,
+                                     aFileSize,
+                                     Index,
+                                     iDescription ))
+        {
+          ValidData = FALSE;
+          Done      = TRUE;
+        }
+
         break;
         
       case EnigmaWC::Key::EController:
         // A Controller element header has been encountered.  Create a new
-        // controller at the end of the controller list.
+        // controller at the end of the controller list.  The symbol table
+        // must be built again before any further connections are made.
         
         iControllers.emplace_back();
-        ExtractNewController( FileData, Index, iControllers.back() );
-        iControllers.back().Initialize();
+        Indexed = FALSE;
+        
+        if ( ExtractNewController( aFileData,
+                                   aFileSize,
+                                   Index,
+                                   iControllers.back() ))
+        {
+          iControllers.back().Initialize();
+        }
+        else
+        {
+          ValidData = FALSE;
+          Done      = TRUE;
+        }
+
         break;
 			
 			case EnigmaWC::Key::EEnd:
 			  // The end of the keyvalue array has been found.  Ensure it has
 			  // the correct value, and is last in the keyvalue array.
             
-        if (( Value != 0 ) || (( FileData.size() - Index ) != 2 ))
+        if (( Value != 0 ) || (( aFileSize - Index ) != 2 ))
           ValidData = FALSE;
 			  
 			  Done = TRUE;
@@ -1624,52 +2125,156 @@ void CMap::LoadFile( const std::string& aFileName )
         break;
     }
   }
-  
-  // If the game map file had valid data, an ending KeyValue, and there is
-  // at least one player (requirement for minimal map), save the game map
-  // name for use when saving the map in the future.  Otherwise, clear all
-  // saved data (game map file may be faulty).
-  
-  if ( ValidData && !iPlayers.empty() )
-    iFileName = aFileName;
-  else
-    Clear();
 
-  return;
+  return ValidData;
 }
 
 //*-------------------------------------------------------------*
-//* This private function writes a KeyValue with a 16-bit value *
-//* to a buffer.                                                *
+//* This private method reads a game map file in either format. *
 //*-------------------------------------------------------------*
-//* aBuffer: Destination buffer.                                *
-//* aKey:    KeyValue key.                                      *
-//* aValue:  16-bit value.                                      *
+//* aFileName: Game map filename.                               *
+//* RETURN:    TRUE if the game map file had valid data.        *
 //*-------------------------------------------------------------*
 
-void WriteKeyValue_16Bit( std::string& aBuffer,
-                          EnigmaWC::Key aKey,
-                          guint16 aValue )
+gboolean CMap::ReadFile( const std::string& aFileName )
 {
-  aBuffer.push_back( (guchar)aKey );
-  aBuffer.push_back( (guchar)aValue );
+  // Map the game map file into memory.  The game map data is parsed in
+  // place, so no copy of the file is made.  A C++ interface could not be
+  // found, so a C interface is used instead.  Return if unsuccessful.
 
-  // Write a bank keyvalue if the level exceeds that for a byte.
-			
-  if ( aValue > G_MAXUINT8 )
+  GMappedFile* MappedFile = g_mapped_file_new( aFileName.c_str(),
+                                               FALSE,
+                                               NULL );
+  if ( MappedFile == NULL )
+    return FALSE;
+
+  const guint8* FileData =
+    (const guint8*)g_mapped_file_get_contents( MappedFile );
+
+  gsize FileSize = g_mapped_file_get_length( MappedFile );
+
+  // Read either an indexed game map, or a keyvalue array game map.
+
+  gboolean ValidData;
+
+  if (( FileSize >= KIndexedHeaderSize )
+    && ( memcmp( FileData, KIndexedCode, 4 ) == 0 ))
   {
-    aBuffer.push_back( (guchar)EnigmaWC::Key::EBank );
-    aBuffer.push_back( (guchar)(aValue >> 8) );
+    ValidData = ReadIndexedData( FileData, FileSize );
+  }
+  else
+    ValidData = ReadKeyValueData( FileData, FileSize );
+
+  // Index the structural objects by location, then apply the changes saved
+  // in the journal since the game map file was last written.
+
+  if ( ValidData )
+  {
+    iObjects.Index();
+    ReadJournal( aFileName );
   }
+
+  // All map information has been copied out of the file mapping, unless
+  // structural objects are being streamed from it.
   
-  return;
+  if ( ValidData && iObjects.GetStreamed() )
+    iMappedFile = MappedFile;
+  else
+    g_mapped_file_unref( MappedFile );
+
+  return ValidData;
 }
 
-//*-------------------------------------------------------------*
-//* This private function writes a KeyValue with an 8-bit value *
-//* to a buffer.                                                *
-//*-------------------------------------------------------------*
-//* aBuffer: Destination buffer.                                *
+//*-------------------------------*
+//* Load a game map from a file.  *
+//*-------------------------------*
+//* aFileName: Game map filename. *
+//*-------------------------------*
+
+void CMap::LoadFile( const std::string& aFileName )
+{
+  // Prepare an empty game map, and read the complete game map file.
+	
+  Clear();
+  
+  gboolean ValidData = ReadFile( aFileName );
+
+  // If the game map file had valid data, an ending KeyValue, and there is
+  // at least one player (requirement for minimal map), save the game map
+  // name for use when saving the map in the future.  Otherwise, clear all
+  // saved data (game map file may be faulty).
+  
+  if ( ValidData && !iPlayers.empty() )
+    iFileName = aFileName;
+  else
+    Clear();
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* Load a game map summary from a file.  Only the controllers,   *
+//* items, players, and description are read, which is sufficient *
+//* for describing a game map and counting its remaining items.   *
+//* The game map is not considered loaded, so it cannot be saved. *
+//*---------------------------------------------------------------*
+//* aFileName: Game map filename.                                 *
+//* RETURN:    TRUE if the game map summary was read.             *
+//*---------------------------------------------------------------*
+
+gboolean CMap::LoadSummary( const std::string& aFileName )
+{
+  // Prepare an empty game map, and read only the summary information.
+
+  Clear();
+
+  iSummary           = TRUE;
+  gboolean ValidData = ReadFile( aFileName );
+  iSummary           = FALSE;
+
+  // The same minimal map requirements apply as for a complete game map.
+
+  if ( !ValidData || iPlayers.empty() )
+  {
+    Clear();
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a KeyValue with a 16-bit value *
+//* to a buffer.                                                *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aKey:    KeyValue key.                                      *
+//* aValue:  16-bit value.                                      *
+//*-------------------------------------------------------------*
+
+void WriteKeyValue_16Bit( std::string& aBuffer,
+                          EnigmaWC::Key aKey,
+                          guint16 aValue )
+{
+  aBuffer.push_back( (guchar)aKey );
+  aBuffer.push_back( (guchar)aValue );
+
+  // Write a bank keyvalue if the level exceeds that for a byte.
+			
+  if ( aValue > G_MAXUINT8 )
+  {
+    aBuffer.push_back( (guchar)EnigmaWC::Key::EBank );
+    aBuffer.push_back( (guchar)(aValue >> 8) );
+  }
+  
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a KeyValue with an 8-bit value *
+//* to a buffer.                                                *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
 //* aKey:    KeyValue key.                                      *
 //* aValue:  8-bit value.                                       *
 //*-------------------------------------------------------------*
@@ -1718,7 +2323,7 @@ void WriteKeyValue_Boolean( std::string& aBuffer,
 
 void WriteKeyValue_String( std::string& aBuffer,
                            EnigmaWC::Key aKey,
-                           std::string& aString )
+                           const std::string& aString )
 {
   // Write KeyValue if the string is not empty.
   
@@ -1814,99 +2419,97 @@ void WriteKeyValue_Data( std::string& aBuffer,
   return;
 }
 
-//*-------------------------------------------------------------*
-//* This method saves the game map to a file using the filename *
-//* set when the game was last loaded from the file.            *
-//*-------------------------------------------------------------*
+//*-----------------------------------------------------------------*
+//* This private method writes the game map as keyvalue array data. *
+//*-----------------------------------------------------------------*
+//* aFileData: Buffer to receive game map file data.                *
+//* aSnapshot: Changing game map state to be written.               *
+//*-----------------------------------------------------------------*
 
-void CMap::SaveFile()
+void CMap::WriteKeyValueData( std::string& aFileData,
+                              CMapSnapshot& aSnapshot )
 {
-  // Return immediately if no game map is loaded. 
-
-  if ( !GetLoaded() )
-    return;
-
   // Prepare the game map header.
 
-  std::string FileData =
+  aFileData =
 "ewc\n\
 format binary_byte 1.0\n\
 comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
 
-  FileData.append( "element object " );
-  FileData.append( std::to_string( iObjects.size() ));
-  FileData.push_back( '\n' );
+  aFileData.append( "element object " );
+  aFileData.append( std::to_string( iObjects.GetStreamed() ? iObjectTotal
+                                                            : iObjects.size() ));
+  aFileData.push_back( '\n' );
 
-  FileData.append( "element player " );
-  FileData.append( std::to_string( iPlayers.size() ));
-  FileData.push_back( '\n' );
+  aFileData.append( "element player " );
+  aFileData.append( std::to_string( aSnapshot.iPlayers.size() ));
+  aFileData.push_back( '\n' );
 
-  FileData.append( "element item " );
-  FileData.append( std::to_string( iItems.size() ));
-  FileData.push_back( '\n' );
+  aFileData.append( "element item " );
+  aFileData.append( std::to_string( aSnapshot.iItems.size() ));
+  aFileData.push_back( '\n' );
 
-  FileData.append( "element description 1" );
-  FileData.push_back( '\n' );
+  aFileData.append( "element description 1" );
+  aFileData.push_back( '\n' );
   
-  FileData.append( "element controller " );
-  FileData.append( std::to_string( iControllers.size() ));
-  FileData.push_back( '\n' );
+  aFileData.append( "element controller " );
+  aFileData.append( std::to_string( iControllers.size() ));
+  aFileData.push_back( '\n' );
 
-  FileData.append( "end_header\n" );
+  aFileData.append( "end_header\n" );
 
   //*------------------------------------------*
   //* Write KeyValues for all map controllers. *
   //*------------------------------------------*
   
   std::list<CMapController>::iterator Controller;
+  gsize Snapshot = 0;
   
   for ( Controller = iControllers.begin();
         Controller != iControllers.end();
-        ++ Controller )
+        ++ Controller, ++ Snapshot )
   {
 		// Add header for a map controller.
 		
-		WriteKeyValue_String( FileData,
+		WriteKeyValue_String( aFileData,
                           EnigmaWC::Key::EController,
                           (*Controller).iName );
     
     // Write Main bytecode block.
 
-    WriteKeyValue_Data( FileData,
+    WriteKeyValue_Data( aFileData,
                         EnigmaWC::Key::ECode,
                         0,
                         (*Controller).iMainCode );    
 
-    // Write Current bytecode block.  This block must first be updated
-    // from the current state of all map controller signals.
-    
-    (*Controller).CreateSignalCode( (*Controller).iCurrentCode );
+    // Write Current bytecode block, which was created from the state of
+    // all map controller signals when the snapshot was taken.
     
-    WriteKeyValue_Data( FileData,
+    WriteKeyValue_Data( aFileData,
                         EnigmaWC::Key::ECurrent,
                         0,
-                        (*Controller).iCurrentCode );
+                        aSnapshot.iCurrentCodes[ Snapshot ] );
     
     // Write Saved bytecode block.
     
     if ( iSavable )
     {    
-      WriteKeyValue_Data( FileData,
+      WriteKeyValue_Data( aFileData,
                           EnigmaWC::Key::ESaved,
                           0,
-                          (*Controller).iSavedCode );
+                          aSnapshot.iSavedCodes[ Snapshot ] );
     }
     
     // Write Restart bytecode block.
     
-    WriteKeyValue_Data( FileData,
+    WriteKeyValue_Data( aFileData,
                         EnigmaWC::Key::ERestart,
                         0,
                         (*Controller).iRestartCode );
     
     // Add header for a packed array of controller signal names.
 
-    WriteKeyValue_Data( FileData,
+    WriteKeyValue_Data( aFileData,
                         EnigmaWC::Key::ESignal,
                         0,
                         (*Controller).iSignalNames );
@@ -1924,13 +2527,41 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
   guint16 North = G_MAXUINT16;
   guint16 Above = G_MAXUINT16;
 	
-  std::list<CMapObject>::iterator Object;
+  // The objects of a streamed map are not all in memory, so they are read
+  // one at a time from the game map file instead.  They are never changed
+  // during a game.
 
-  for ( Object = iObjects.begin(); Object != iObjects.end(); ++ Object )
+  CMapObjectList::iterator Listed = iObjects.begin();
+  CMapObject Streamed;
+  CMapObject Unpacked;
+  CMapObject* Object;
+  guint32 Index = 0;
+
+  while ( TRUE )
   {
+    if ( iObjects.GetStreamed() )
+    {
+      if ( Index == iObjectTotal )
+        break;
+
+      if ( !ReadStreamedObject( Index ++, Streamed ))
+        continue;
+
+      Object = &Streamed;
+    }
+    else
+    {
+      if ( Listed == iObjects.end() )
+        break;
+
+      Listed.Unpack( Unpacked );
+      Object = &Unpacked;
+      ++ Listed;
+    }
+
     // Add the header for a simple object.
 		
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::EObject,
                         (guint8)(*Object).iID );
 
@@ -1941,7 +2572,7 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     {
       East = (*Object).iLocation.iEast;
 
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::EEast,
                            East );
     }
@@ -1953,7 +2584,7 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     {
       North = (*Object).iLocation.iNorth;
       
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::ENorth,
                            North );
     }
@@ -1965,26 +2596,26 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     {			
       Above = (*Object).iLocation.iAbove;
 
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::EAbove,
                            Above );
     }
 
     // Add a surface keyvalue.
 
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ESurface,
                         (guint8)(*Object).iSurface );
 
     // Add a rotation keyvalue.
 
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERotation,
                         (guint8)(*Object).iRotation );
   
       // Add connection keyvalues.
   
-    WriteKeyValue_Connections( FileData, (*Object) );
+    WriteKeyValue_Connections( aFileData, (*Object) );
   }
 
   //*---------------------------------------------*
@@ -1999,20 +2630,20 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
 	{
 		// Add header for a teleporter object.
 		
-		WriteKeyValue_8Bit( FileData,
+		WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ETeleporter,
                         (guint8)(*Teleporter).iID );
   
     // Write departure surface keyvalue, and add arrival surface
     // if it is not to be the player's current surface.
     
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ESurface,
                         (guint8)(*Teleporter).iSurface );
   
     if ( (*Teleporter).iSurfaceArrival != EnigmaWC::Direction::ENone )
     {
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::EArrival,
                           (guint8)(*Teleporter).iSurfaceArrival );
     }
@@ -2020,13 +2651,13 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     // Write departure rotation keyvalue, and add arrival rotation
     // if it is not to be the player's current rotation.
     
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERotation,
                         (guint8)(*Teleporter).iRotation );
   
     if ( (*Teleporter).iRotationArrival != EnigmaWC::Direction::ENone )
     {
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::EArrival,
                           (guint8)(*Teleporter).iRotationArrival );
     }
@@ -2034,13 +2665,13 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     // Write departure East location keyvalue, and add arrival East location
     // if it is not to be the player's current East location.
   
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EEast,
                          (*Teleporter).iLocation.iEast );
                          
     if ( (*Teleporter).iLocationArrival.iEast != G_MAXUINT16 )
     {
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::EArrival,
                            (*Teleporter).iLocationArrival.iEast );
     }
@@ -2048,13 +2679,13 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     // Write departure North location keyvalue, and add arrival North location
     // if it is not to be the player's current North location.
   
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ENorth,
                          (*Teleporter).iLocation.iNorth );
                          
     if ( (*Teleporter).iLocationArrival.iNorth != G_MAXUINT16 )
     {
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::EArrival,
                            (*Teleporter).iLocationArrival.iNorth );
     }
@@ -2062,20 +2693,20 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
     // Write departure Above location keyvalue, adding arrival Above location
     // if it is not to be the player's current Above location.
   
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EAbove,
                          (*Teleporter).iLocation.iAbove );
 
     if ( (*Teleporter).iLocationArrival.iAbove != G_MAXUINT16 )
     {           
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::EArrival,
                            (*Teleporter).iLocationArrival.iAbove );
     }
 
     // Add connection keyvalues.
   
-    WriteKeyValue_Connections( FileData, (*Teleporter) );
+    WriteKeyValue_Connections( aFileData, (*Teleporter) );
   }
   
   //*-----------------------------------------*
@@ -2084,132 +2715,134 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
   
   std::list<CMapPlayer>::iterator Player;
   
-  for ( Player = iPlayers.begin(); Player != iPlayers.end(); ++ Player )
+  for ( Player = aSnapshot.iPlayers.begin();
+        Player != aSnapshot.iPlayers.end();
+        ++ Player )
 	{
 		// Add header for a player object.
 		
-		WriteKeyValue_8Bit( FileData,
+		WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::EPlayer,
                         (guint8)(*Player).iID );
 		
 		// Write current, saved, and restart surface keyvalues.
     
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ESurface,
                         (guint8)(*Player).iSurface );
 
     if ( iSavable )
     {
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::ESaved,
                           (guint8)(*Player).iSurfaceSaved );
     }
                         
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERestart,
                         (guint8)(*Player).iSurfaceRestart );
 
     // Write current, saved, and restart rotation keyvalues.
     
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERotation,
                         (guint8)(*Player).iRotation );
 
     if ( iSavable )
     {
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::ESaved,
                           (guint8)(*Player).iRotationSaved );
     }
                         
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERestart,
                         (guint8)(*Player).iRotationRestart );
 				
 		// Write current, saved, and restart East locations.
 		
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EEast,
                          (*Player).iLocation.iEast );
 
     if ( iSavable )
     {
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::ESaved,
                            (*Player).iLocationSaved.iEast );
     }
                          
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ERestart,
                          (*Player).iLocationRestart.iEast );
 
 		// Write current, saved, and restart North locations.
 
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ENorth,
                          (*Player).iLocation.iNorth );
 
     if ( iSavable )
     {
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::ESaved,
                            (*Player).iLocationSaved.iNorth );
     }
                          
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ERestart,
                          (*Player).iLocationRestart.iNorth );
 
     // Write current, saved, and restart Above locations.
 
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EAbove,
                          (*Player).iLocation.iAbove );
 
     if ( iSavable )
     {
-      WriteKeyValue_16Bit( FileData,
+      WriteKeyValue_16Bit( aFileData,
                            EnigmaWC::Key::ESaved,
                            (*Player).iLocationSaved.iAbove );
     }
                          
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ERestart,
                          (*Player).iLocationRestart.iAbove );
 
 		// Add current, saved, and restart Active state keyvalues.
 
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::EActive,
                            (*Player).iActive );
                            
     if ( iSavable )
     {
-      WriteKeyValue_Boolean( FileData,
+      WriteKeyValue_Boolean( aFileData,
                              EnigmaWC::Key::ESaved,
                              (*Player).iActiveSaved );
     } 
 
 		// Add current, saved, and restart Outdoor state keyvalues.
 
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::EOutdoor,
                            (*Player).iOutdoor );
                            
     if ( iSavable )
     {
-      WriteKeyValue_Boolean( FileData,
+      WriteKeyValue_Boolean( aFileData,
                              EnigmaWC::Key::ESaved,
                              (*Player).iOutdoorSaved );
     } 
                            
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::ERestart,
                            (*Player).iOutdoorRestart );
 
     // Add connection keyvalues.
   
-    WriteKeyValue_Connections( FileData, (*Player) );
+    WriteKeyValue_Connections( aFileData, (*Player) );
 	}
 
   //*---------------------------------------*
@@ -2218,94 +2851,96 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
 
   std::list<CMapItem>::iterator Item;
 
-  for ( Item = iItems.begin(); Item != iItems.end(); ++ Item )
+  for ( Item = aSnapshot.iItems.begin();
+        Item != aSnapshot.iItems.end();
+        ++ Item )
   {
     // Add header for an item object.
 		
-		WriteKeyValue_8Bit( FileData,
+		WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::EItem,
                         (guint8)(*Item).iID );
 
    // Write surface.
 
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ESurface,
                         (guint8)(*Item).iSurface );
     
     // Write rotation.
 
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ERotation,
                         (guint8)(*Item).iRotation );
 
     // Write location.
 		
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EEast,
                          (*Item).iLocation.iEast );
 
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::ENorth,
                          (*Item).iLocation.iNorth );
 
-    WriteKeyValue_16Bit( FileData,
+    WriteKeyValue_16Bit( aFileData,
                          EnigmaWC::Key::EAbove,
                          (*Item).iLocation.iAbove );
 
     // Write category.
 
-    WriteKeyValue_8Bit( FileData,
+    WriteKeyValue_8Bit( aFileData,
                         EnigmaWC::Key::ECategory,
                         (guint8)(*Item).iCategory );
                         
     // Add current, saved, and restart Active state keyvalues.
 
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::EActive,
                            (*Item).iActive );
                            
     if ( iSavable )
     {
-      WriteKeyValue_Boolean( FileData,
+      WriteKeyValue_Boolean( aFileData,
                              EnigmaWC::Key::ESaved,
                              (*Item).iActiveSaved );
     }
                            
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::ERestart,
                            (*Item).iActiveRestart );
 
     // Add current, saved, and restart Selected state keyvalues.
 
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::ESelected,
                            (*Item).iSelected );
 
     if ( iSavable )
     {
-      WriteKeyValue_Boolean( FileData,
+      WriteKeyValue_Boolean( aFileData,
                              EnigmaWC::Key::ESaved,
                              (*Item).iSelectedSaved );
     }
                            
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::ERestart,
                            (*Item).iSelectedRestart );
 
     // Add current, saved, and restart Used state keyvalues.
 
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::EUsed,
                            (*Item).iUsed );
                            
     if ( iSavable )
     {
-      WriteKeyValue_Boolean( FileData,
+      WriteKeyValue_Boolean( aFileData,
                              EnigmaWC::Key::ESaved,
                              (*Item).iUsedSaved );
     }
                            
-    WriteKeyValue_Boolean( FileData,
+    WriteKeyValue_Boolean( aFileData,
                            EnigmaWC::Key::ERestart,
                            (*Item).iUsedRestart );
 
@@ -2314,35 +2949,35 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
 
     if ( !(*Item).iActive )
     {
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::EOwner,
                           (*Item).iOwner );
     }
                  
     if ( !(*Item).iActiveSaved && iSavable )
     {         
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::ESaved,
                           (*Item).iOwnerSaved );
     }
     
     if ( !(*Item).iActiveRestart )
     { 
-      WriteKeyValue_8Bit( FileData,
+      WriteKeyValue_8Bit( aFileData,
                           EnigmaWC::Key::ERestart,
                           (*Item).iOwnerRestart );
     }
     
     // Add connection keyvalues.
   
-    WriteKeyValue_Connections( FileData, (*Item) );
+    WriteKeyValue_Connections( aFileData, (*Item) );
 	}
 
   //*------------------------------------------*
   //* Write KeyValues for the map description. *
   //*------------------------------------------*
 
-  WriteKeyValue_Data( FileData,
+  WriteKeyValue_Data( aFileData,
                       EnigmaWC::Key::EDescription,
                       (guint8)EnigmaWC::Language::EEnglish,
                       iDescription );
@@ -2351,22 +2986,1912 @@ comment Enigma in the Wine Cellar 3.0 game map, created by EnigmaWC 3.0\n";
   //* Write KeyValue array terminator. *
   //*----------------------------------*
 
-  WriteKeyValue_8Bit( FileData,
+  WriteKeyValue_8Bit( aFileData,
                       EnigmaWC::Key::EEnd,
                       0 );
 
-  // Write the file data to the file.
+  return;
+}
 
-  try
+//*-------------------------------------------------------------*
+//* This private function writes an 8-bit value to an indexed   *
+//* game map buffer.                                            *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aValue:  8-bit value.                                       *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_8Bit( std::string& aBuffer, guint8 aValue )
+{
+  aBuffer.push_back( (guchar)aValue );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a 16-bit value to an indexed   *
+//* game map buffer in little-endian byte order.                *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aValue:  16-bit value.                                      *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_16Bit( std::string& aBuffer, guint16 aValue )
+{
+  aBuffer.push_back( (guchar)aValue );
+  aBuffer.push_back( (guchar)( aValue >> 8 ));
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a 32-bit value to an indexed   *
+//* game map buffer in little-endian byte order.                *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aValue:  32-bit value.                                      *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_32Bit( std::string& aBuffer, guint32 aValue )
+{
+  WriteIndexed_16Bit( aBuffer, (guint16)aValue );
+  WriteIndexed_16Bit( aBuffer, (guint16)( aValue >> 16 ));
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a 64-bit value to an indexed   *
+//* game map buffer in little-endian byte order.                *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aValue:  64-bit value.                                      *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_64Bit( std::string& aBuffer, guint64 aValue )
+{
+  WriteIndexed_32Bit( aBuffer, (guint32)aValue );
+  WriteIndexed_32Bit( aBuffer, (guint32)( aValue >> 32 ));
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a map location to an indexed   *
+//* game map buffer.                                            *
+//*-------------------------------------------------------------*
+//* aBuffer:   Destination buffer.                              *
+//* aLocation: Map location.                                    *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_Location( std::string& aBuffer,
+                            const CMapLocation& aLocation )
+{
+  WriteIndexed_16Bit( aBuffer, aLocation.iEast );
+  WriteIndexed_16Bit( aBuffer, aLocation.iNorth );
+  WriteIndexed_16Bit( aBuffer, aLocation.iAbove );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes a block of data preceded by    *
+//* its 32-bit length to an indexed game map buffer.            *
+//*-------------------------------------------------------------*
+//* aBuffer: Destination buffer.                                *
+//* aData:   Data block.                                        *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_Block( std::string& aBuffer, const std::string& aData )
+{
+  WriteIndexed_32Bit( aBuffer, (guint32)aData.size() );
+  aBuffer.append( aData );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads a little-endian 16-bit value    *
+//* from indexed game map data.                                 *
+//*-------------------------------------------------------------*
+//* aData:  Pointer to value.                                   *
+//* RETURN: 16-bit value.                                       *
+//*-------------------------------------------------------------*
+
+guint16 ReadIndexed_16Bit( const guint8* aData )
+{
+  return (guint16)( aData[ 0 ] | ( aData[ 1 ] << 8 ));
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads a little-endian 32-bit value    *
+//* from indexed game map data.                                 *
+//*-------------------------------------------------------------*
+//* aData:  Pointer to value.                                   *
+//* RETURN: 32-bit value.                                       *
+//*-------------------------------------------------------------*
+
+guint32 ReadIndexed_32Bit( const guint8* aData )
+{
+  return ( (guint32)ReadIndexed_16Bit( aData )
+         | ( (guint32)ReadIndexed_16Bit( aData + 2 ) << 16 ));
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads a little-endian 64-bit value    *
+//* from indexed game map data.                                 *
+//*-------------------------------------------------------------*
+//* aData:  Pointer to value.                                   *
+//* RETURN: 64-bit value.                                       *
+//*-------------------------------------------------------------*
+
+guint64 ReadIndexed_64Bit( const guint8* aData )
+{
+  return ( (guint64)ReadIndexed_32Bit( aData )
+         | ( (guint64)ReadIndexed_32Bit( aData + 4 ) << 32 ));
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads a map location from indexed     *
+//* game map data.                                              *
+//*-------------------------------------------------------------*
+//* aData:     Pointer to location.                             *
+//* aLocation: Map location to receive values.                  *
+//*-------------------------------------------------------------*
+
+void ReadIndexed_Location( const guint8* aData, CMapLocation& aLocation )
+{
+  aLocation.iEast  = ReadIndexed_16Bit( aData );
+  aLocation.iNorth = ReadIndexed_16Bit( aData + 2 );
+  aLocation.iAbove = ReadIndexed_16Bit( aData + 4 );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads a block of data preceded by its *
+//* 32-bit length from indexed game map data.                   *
+//*-------------------------------------------------------------*
+//* aData:  Section data.                                       *
+//* aSize:  Section data size.                                  *
+//* aIndex: Index to block length, moved past the block.        *
+//* aBlock: String to receive data block.                       *
+//* RETURN: FALSE if the block exceeds the section.             *
+//*-------------------------------------------------------------*
+
+gboolean ReadIndexed_Block( const guint8* aData,
+                            gsize aSize,
+                            gsize& aIndex,
+                            std::string& aBlock )
+{
+  if (( aSize - aIndex ) < 4 )
+    return FALSE;
+
+  gsize Length = ReadIndexed_32Bit( aData + aIndex );
+  aIndex += 4;
+
+  if ( Length > ( aSize - aIndex ))
+    return FALSE;
+
+  aBlock.assign( (const gchar*)aData + aIndex, Length );
+  aIndex += Length;
+  return TRUE;
+}
+
+//*-----------------------------------------------------------------*
+//* This private class converts object connections into the codes   *
+//* stored in indexed game map records.  A connected signal is      *
+//* stored as its controller and signal index.  Any other signal    *
+//* name (eg. "T" or an unresolved name) is stored in a name table. *
+//*-----------------------------------------------------------------*
+
+class CConnectionEncoder
+{
+  public:
+    CConnectionEncoder( CMapControllerList& aControllers );
+    guint32 Encode( CConnection& aConnection );
+
+    std::string iNames;     // Name table section data.
+    guint32 iTotal;         // Number of names in table.
+
+  private:
+    std::unordered_map<const CMapController*, guint32> iIndices;
+    std::unordered_map<std::string, guint32> iCodes;
+};
+
+//*-------------------------------------------------------*
+//* Constructor numbering all controllers in a game map.  *
+//*-------------------------------------------------------*
+//* aControllers: List of map controllers.                *
+//*-------------------------------------------------------*
+
+CConnectionEncoder::CConnectionEncoder( CMapControllerList& aControllers )
+{
+  guint32 Index = 0;
+  
+  for ( CMapController& Controller : aControllers )
+    iIndices[ &Controller ] = Index ++;
+
+  iTotal = 0;
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the indexed game map code for a signal   *
+//* connection.                                                  *
+//*--------------------------------------------------------------*
+//* aConnection: Signal connection.                              *
+//* RETURN:      Connection code.                                *
+//*--------------------------------------------------------------*
+
+guint32 CConnectionEncoder::Encode( CConnection& aConnection )
+{
+  if ( aConnection.Name().empty() )
+    return KUnconnected;
+
+  if ( aConnection.Connected() )
   {
-    Glib::file_set_contents( iFileName,
-                             FileData.data(),
-                             FileData.size() );
+    guint32 Controller = iIndices[ &(*aConnection.Controller()) ];
+
+    if ( Controller < ( KNamedConnection >> 16 ))
+      return (( Controller << 16 ) | aConnection.Signal() );
   }
-    catch( Glib::Error error )
+  
+  // The connection is stored by name.  Add the name to the name table
+  // if it has not already been used.
+  
+  auto Code = iCodes.find( aConnection.Name() );
+  
+  if ( Code != iCodes.end() )
+    return Code->second;
+
+  WriteIndexed_8Bit( iNames, (guint8)aConnection.Name().size() );
+  iNames.append( aConnection.Name(), 0, G_MAXUINT8 );
+  
+  guint32 Result = KNamedConnection | iTotal ++;
+  iCodes[ aConnection.Name() ] = Result;
+  return Result;
+}
+
+//*---------------------------------------------------------------*
+//* This private class restores object connections from the codes *
+//* stored in indexed game map records, without searching for     *
+//* controller and signal names.                                  *
+//*---------------------------------------------------------------*
+
+class CConnectionDecoder
+{
+  public:
+    gboolean Initialize( CMapControllerList& aControllers,
+                         const guint8* aNames,
+                         gsize aSize );
+
+    gboolean Decode( guint32 aCode,
+                     gboolean aState,
+                     CConnection& aConnection );
+
+  private:
+    CMapControllerList* iList;
+    std::vector<std::vector<const CMapControllerList::CSignalName*>> iSignals;
+    std::vector<std::pair<const gchar*, guint8>> iNames;
+};
+
+//*--------------------------------------------------------------*
+//* This method prepares tables of controllers, qualified signal *
+//* names, and name table entries.                               *
+//*--------------------------------------------------------------*
+//* aControllers: List of map controllers.                       *
+//* aNames:       Name table section data.                       *
+//* aSize:        Name table section size.                       *
+//* RETURN:       FALSE if the name table is damaged.            *
+//*--------------------------------------------------------------*
+
+gboolean CConnectionDecoder::Initialize( CMapControllerList& aControllers,
+                                         const guint8* aNames,
+                                         gsize aSize )
+{
+  iList = &aControllers;
+  
+  std::list<CMapController>::iterator Controller;
+  
+  for ( Controller = aControllers.begin();
+        Controller != aControllers.end();
+        ++ Controller )
   {
-    return;
+    // Intern the fully-qualified name of every controller signal once,
+    // rather than once for every connection.
+    
+    iSignals.emplace_back();
+    
+    std::string::size_type Position = 0;
+    std::string::size_type Terminator;
+    std::string Name;
+
+    while (( Terminator = (*Controller).iSignalNames.find( '\n', Position ))
+      != std::string::npos )
+    {
+      Name = (*Controller).iName + ':';
+      Name.append( (*Controller).iSignalNames,
+                   Position,
+                   Terminator - Position );
+
+      iSignals.back().push_back(
+        aControllers.Intern( Controller,
+                             (guint16)iSignals.back().size(),
+                             Name ));
+
+      Position = Terminator + 1;
+    }
+  }
+  
+  // Record the location of every name in the name table.
+  
+  if ( aNames == NULL )
+    return TRUE;
+    
+  if ( aSize < 4 )
+    return FALSE;
+
+  guint32 Total = ReadIndexed_32Bit( aNames );
+  gsize Index   = 4;
+  
+  for ( guint32 Name = 0; Name < Total; ++ Name )
+  {
+    if (( Index >= aSize ) || ( aNames[ Index ] > ( aSize - Index - 1 )))
+      return FALSE;
+
+    iNames.emplace_back( (const gchar*)aNames + Index + 1, aNames[ Index ] );
+    Index += 1 + aNames[ Index ];
+  }
+  
+  return TRUE;
+}
+
+//*-------------------------------------------------------------*
+//* This method restores a signal connection from its code.     *
+//*-------------------------------------------------------------*
+//* aCode:       Connection code.                               *
+//* aState:      Local state of an unnamed connection.          *
+//* aConnection: Signal connection.                             *
+//* RETURN:      FALSE if the code is not valid.                *
+//*-------------------------------------------------------------*
+
+gboolean CConnectionDecoder::Decode( guint32 aCode,
+                                     gboolean aState,
+                                     CConnection& aConnection )
+{
+  if ( aCode == KUnconnected )
+  {
+    aConnection.Disconnect();
+    aConnection.SetState( aState );
+  }
+  else if ( aCode & KNamedConnection )
+  {
+    aCode &= ~KNamedConnection;
+    
+    if ( aCode >= iNames.size() )
+      return FALSE;
+      
+    aConnection.Connect( *iList,
+                         iNames[ aCode ].first,
+                         iNames[ aCode ].second );
+  }
+  else
+  {
+    guint32 Controller = aCode >> 16;
+    guint32 Signal     = aCode & G_MAXUINT16;
+    
+    if (( Controller >= iSignals.size() )
+      || ( Signal >= iSignals[ Controller ].size() ))
+    {
+      return FALSE;
+    }
+    
+    aConnection.Connect( iSignals[ Controller ][ Signal ] );
+  }
+
+  return TRUE;
+}
+
+//*-------------------------------------------------------------*
+//* This private function writes the record fields shared by    *
+//* all map objects to an indexed game map buffer.              *
+//*-------------------------------------------------------------*
+//* aBuffer:  Destination buffer.                               *
+//* aObject:  Map object.                                       *
+//* aEncoder: Connection encoder.                               *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_Object( std::string& aBuffer,
+                          CMapObject& aObject,
+                          CConnectionEncoder& aEncoder )
+{
+  WriteIndexed_8Bit( aBuffer, (guint8)aObject.iID );
+  WriteIndexed_8Bit( aBuffer, (guint8)aObject.iSurface );
+  WriteIndexed_8Bit( aBuffer, (guint8)aObject.iRotation );
+  WriteIndexed_8Bit( aBuffer, 0 );
+  WriteIndexed_Location( aBuffer, aObject.iLocation );
+  WriteIndexed_16Bit( aBuffer, 0 );
+  WriteIndexed_32Bit( aBuffer, aEncoder.Encode( aObject.iSense ));
+  WriteIndexed_32Bit( aBuffer, aEncoder.Encode( aObject.iState ));
+  WriteIndexed_32Bit( aBuffer, aEncoder.Encode( aObject.iVisibility ));
+  WriteIndexed_32Bit( aBuffer, aEncoder.Encode( aObject.iPresence ));
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function reads the record fields shared by all *
+//* map objects from indexed game map data.                     *
+//*-------------------------------------------------------------*
+//* aData:    Pointer to record.                                *
+//* aObject:  Map object to receive values.                     *
+//* aDecoder: Connection decoder.                               *
+//* RETURN:   FALSE if the record has invalid data.             *
+//*-------------------------------------------------------------*
+
+gboolean ReadIndexed_Object( const guint8* aData,
+                             CMapObject& aObject,
+                             CConnectionDecoder& aDecoder )
+{
+  aObject.iID       = (EnigmaWC::ID)aData[ 0 ];
+  aObject.iSurface  = (EnigmaWC::Direction)aData[ 1 ];
+  aObject.iRotation = (EnigmaWC::Direction)aData[ 2 ];
+  ReadIndexed_Location( aData + 4, aObject.iLocation );
+  
+  return (( (int)aObject.iID < (int)EnigmaWC::ID::TOTAL )
+    && ( (int)aObject.iSurface < (int)EnigmaWC::Direction::TOTAL )
+    && ( (int)aObject.iRotation < (int)EnigmaWC::Direction::TOTAL )
+    && aDecoder.Decode( ReadIndexed_32Bit( aData + 12 ),
+                        FALSE,
+                        aObject.iSense )
+    && aDecoder.Decode( ReadIndexed_32Bit( aData + 16 ),
+                        TRUE,
+                        aObject.iState )
+    && aDecoder.Decode( ReadIndexed_32Bit( aData + 20 ),
+                        TRUE,
+                        aObject.iVisibility )
+    && aDecoder.Decode( ReadIndexed_32Bit( aData + 24 ),
+                        TRUE,
+                        aObject.iPresence ));
+}
+
+//*-------------------------------------------------------------*
+//* This private function returns a pointer to a record array   *
+//* section, and checks its size.                               *
+//*-------------------------------------------------------------*
+//* aSection:    Section data, or NULL if missing.              *
+//* aSize:       Section size.                                  *
+//* aRecordSize: Size of each record.                           *
+//* aTotal:      Reference to receive number of records.        *
+//* RETURN:      Pointer to first record, or NULL if damaged.   *
+//*-------------------------------------------------------------*
+
+const guint8* FindRecords( const guint8* aSection,
+                           gsize aSize,
+                           gsize aRecordSize,
+                           guint32& aTotal )
+{
+  aTotal = 0;
+  
+  if ( aSection == NULL )
+    return NULL;
+    
+  if ( aSize < 4 )
+    return NULL;
+  
+  aTotal = ReadIndexed_32Bit( aSection );
+  
+  if ((( aSize - 4 ) / aRecordSize ) < aTotal )
+  {
+    aTotal = 0;
+    return NULL;
+  }
+  
+  return ( aSection + 4 );
+}
+
+//*-------------------------------------------------------------*
+//* This private function confirms that object records are      *
+//* sorted by location, which is required for streaming them.   *
+//*-------------------------------------------------------------*
+//* aRecords: Pointer to first object record.                   *
+//* aTotal:   Number of object records.                         *
+//* RETURN:   TRUE if the records are sorted.                   *
+//*-------------------------------------------------------------*
+
+gboolean RecordsSorted( const guint8* aRecords, guint32 aTotal )
+{
+  CMapLocation Previous;
+  CMapLocation Location;
+  
+  for ( guint32 Index = 1; Index < aTotal; ++ Index )
+  {
+    ReadIndexed_Location( aRecords + ( (gsize)( Index - 1 ) * KObjectRecordSize ) + 4,
+                          Previous );
+    ReadIndexed_Location( aRecords + ( (gsize)Index * KObjectRecordSize ) + 4,
+                          Location );
+    
+    if ( Location < Previous )
+      return FALSE;
+  }
+  
+  return TRUE;
+}
+
+//*--------------------------------------------------------------*
+//* This private method reads all structural objects in a map    *
+//* region from the game map file of a streamed map.  Each row   *
+//* of rooms in the region is found with a binary search of the  *
+//* sorted object records.                                       *
+//*--------------------------------------------------------------*
+//* aLower:   Lower corner of map region.                        *
+//* aObjects: List to receive objects, sorted by location.       *
+//*--------------------------------------------------------------*
+
+void CMap::ReadRegion( const CMapLocation& aLower,
+                       std::list<CMapObject>& aObjects )
+{
+  CMapLocation Target;
+  CMapLocation Location;
+  guint32 First;
+  guint32 Last;
+  guint32 Middle;
+  
+  guint32 UpperEast = (guint32)aLower.iEast + KRegionSize;
+  Target.iEast      = aLower.iEast;
+  
+  for ( guint32 Above = aLower.iAbove;
+        Above < ( (guint32)aLower.iAbove + KRegionSize );
+        ++ Above )
+  {
+    for ( guint32 North = aLower.iNorth;
+          North < ( (guint32)aLower.iNorth + KRegionSize );
+          ++ North )
+    {
+      // Find the first record at or past the start of the row.
+      
+      Target.iAbove = (guint16)Above;
+      Target.iNorth = (guint16)North;
+      
+      First = 0;
+      Last  = iObjectTotal;
+      
+      while ( First < Last )
+      {
+        Middle = First + (( Last - First ) / 2 );
+        
+        ReadIndexed_Location( iObjectRecords
+                              + ( (gsize)Middle * KObjectRecordSize ) + 4,
+                              Location );
+        
+        if ( Location < Target )
+          First = Middle + 1;
+        else
+          Last = Middle;
+      }
+      
+      // Read all records in the row that lie within the region.  Damaged
+      // records are skipped.
+      
+      while ( First < iObjectTotal )
+      {
+        ReadIndexed_Location( iObjectRecords
+                              + ( (gsize)First * KObjectRecordSize ) + 4,
+                              Location );
+        
+        if (( Location.iAbove != Above )
+          || ( Location.iNorth != North )
+          || ( Location.iEast >= UpperEast ))
+        {
+          break;
+        }
+        
+        aObjects.emplace_back();
+        
+        if ( !ReadStreamedObject( First, aObjects.back() ))
+          aObjects.pop_back();
+        
+        ++ First;
+      }
+    }
+  }
+  
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This private method reads one structural object record from  *
+//* the game map file of a streamed map.                         *
+//*--------------------------------------------------------------*
+//* aIndex:  Object record index.                                *
+//* aObject: Reference to MapObject.                             *
+//* RETURN:  FALSE if the record is damaged.                     *
+//*--------------------------------------------------------------*
+
+gboolean CMap::ReadStreamedObject( guint32 aIndex, CMapObject& aObject )
+{
+  return ReadIndexed_Object( iObjectRecords + ( (gsize)aIndex * KObjectRecordSize ),
+                             aObject,
+                             *iDecoder );
+}
+
+//*-----------------------------------------------------------------*
+//* This private method reads a game map from indexed (.ewcx) data. *
+//*-----------------------------------------------------------------*
+//* aFileData: Game map file data.                                  *
+//* aFileSize: Game map file data size.                             *
+//* RETURN:    TRUE if the game map data was valid.                 *
+//*-----------------------------------------------------------------*
+
+gboolean CMap::ReadIndexedData( const guint8* aFileData, gsize aFileSize )
+{
+  // Confirm the file version, and that the section directory is present.
+  
+  if ( ReadIndexed_16Bit( aFileData + 4 ) != KIndexedVersion )
+    return FALSE;
+
+  guint16 Flags   = ReadIndexed_16Bit( aFileData + 6 );
+  guint32 Entries = ReadIndexed_32Bit( aFileData + 8 );
+  
+  if ((( aFileSize - KIndexedHeaderSize ) / KIndexedEntrySize ) < Entries )
+    return FALSE;
+
+  iSavable = (( Flags & KIndexedSavable ) != 0 );
+  iBounded = (( Flags & KIndexedBounded ) != 0 );
+  ReadIndexed_Location( aFileData + 12, iLowerBounds );
+  ReadIndexed_Location( aFileData + 18, iUpperBounds );
+  
+  // Locate all sections in the directory.  Each section begins with a
+  // key describing its contents.
+  
+  const guint8* Sections[ (int)EnigmaWC::Key::TOTAL ] = {};
+  gsize Sizes[ (int)EnigmaWC::Key::TOTAL ] = {};
+  const guint8* Entry = aFileData + KIndexedHeaderSize;
+  
+  for ( guint32 Index = 0; Index < Entries; ++ Index )
+  {
+    guint32 Key    = ReadIndexed_32Bit( Entry );
+    guint32 Offset = ReadIndexed_32Bit( Entry + 4 );
+    guint32 Size   = ReadIndexed_32Bit( Entry + 8 );
+    
+    if (( Offset > aFileSize ) || ( Size > ( aFileSize - Offset )))
+      return FALSE;
+
+    if ( Key < (guint32)EnigmaWC::Key::TOTAL )
+    {
+      Sections[ Key ] = aFileData + Offset;
+      Sizes[ Key ]    = Size;
+    }
+    
+    Entry += KIndexedEntrySize;
+  }
+  
+  // Read the controller symbol table.  Controllers must be present before
+  // any object connections are restored.
+
+  const guint8* Section = Sections[ (int)EnigmaWC::Key::EController ];
+  gsize Size            = Sizes[ (int)EnigmaWC::Key::EController ];
+  
+  if ( Section != NULL )
+  {
+    if ( Size < 4 )
+      return FALSE;
+      
+    guint32 Total = ReadIndexed_32Bit( Section );
+    gsize Index   = 4;
+    
+    for ( guint32 Count = 0; Count < Total; ++ Count )
+    {
+      iControllers.emplace_back();
+      CMapController& Controller = iControllers.back();
+      
+      if ( !ReadIndexed_Block( Section, Size, Index, Controller.iName )
+        || !ReadIndexed_Block( Section, Size, Index, Controller.iSignalNames )
+        || !ReadIndexed_Block( Section, Size, Index, Controller.iMainCode )
+        || !ReadIndexed_Block( Section, Size, Index, Controller.iCurrentCode )
+        || !ReadIndexed_Block( Section, Size, Index, Controller.iSavedCode )
+        || !ReadIndexed_Block( Section, Size, Index, Controller.iRestartCode ))
+      {
+        return FALSE;
+      }
+      
+      Controller.Initialize();
+    }
+  }
+
+  // Build the controller symbol table for connections stored by name.
+  
+  iControllers.Index();
+
+  std::unique_ptr<CConnectionDecoder> Decoder( new CConnectionDecoder );
+  
+  if ( !Decoder->Initialize( iControllers,
+                            Sections[ (int)EnigmaWC::Key::EData ],
+                            Sizes[ (int)EnigmaWC::Key::EData ] ))
+  {
+    return FALSE;
+  }
+
+  // Read all structural objects.  Neither these nor teleporters are needed
+  // in a game map summary, so their records are not read.
+  
+  guint32 Total;
+  const guint8* Record;
+  
+  Record = FindRecords( Sections[ (int)EnigmaWC::Key::EObject ],
+                        Sizes[ (int)EnigmaWC::Key::EObject ],
+                        KObjectRecordSize,
+                        Total );
+
+  if ( iSummary )
+    Total = 0;
+  else if (( iStreamBudget != 0 )
+        && ( Total > iStreamBudget )
+        && RecordsSorted( Record, Total ))
+  {
+    // The game map is too large to hold all structural objects in memory.
+    // Objects will instead be read one map region at a time, directly from
+    // the sorted records in the game map file.
+
+    iObjectRecords = Record;
+    iObjectTotal   = Total;
+    iObjects.SetRegionReader( sigc::mem_fun( *this, &CMap::ReadRegion ));
+    Total = 0;
+  }
+                        
+  for ( guint32 Count = 0; Count < Total; ++ Count )
+  {
+    CMapObject Object;
+    
+    if ( !ReadIndexed_Object( Record, Object, *Decoder ))
+      return FALSE;
+
+    iObjects.push_back( Object );
+    
+    Record += KObjectRecordSize;
+  }
+  
+  // Read all teleporter objects.
+
+  Record = FindRecords( Sections[ (int)EnigmaWC::Key::ETeleporter ],
+                        Sizes[ (int)EnigmaWC::Key::ETeleporter ],
+                        KTeleporterRecordSize,
+                        Total );
+
+  if ( iSummary )
+    Total = 0;
+
+  for ( guint32 Count = 0; Count < Total; ++ Count )
+  {
+    iTeleporters.emplace_back();
+    CMapTeleporter& Teleporter = iTeleporters.back();
+    
+    if ( !ReadIndexed_Object( Record, Teleporter, *Decoder ))
+      return FALSE;
+
+    Teleporter.iSurfaceArrival  = (EnigmaWC::Direction)Record[ 28 ];
+    Teleporter.iRotationArrival = (EnigmaWC::Direction)Record[ 29 ];
+    ReadIndexed_Location( Record + 30, Teleporter.iLocationArrival );
+    
+    if (( (int)Teleporter.iSurfaceArrival >= (int)EnigmaWC::Direction::TOTAL )
+      || ( (int)Teleporter.iRotationArrival >= (int)EnigmaWC::Direction::TOTAL ))
+    {
+      return FALSE;
+    }
+    
+    Record += KTeleporterRecordSize;
+  }
+  
+  // Read all item objects.
+
+  Record = FindRecords( Sections[ (int)EnigmaWC::Key::EItem ],
+                        Sizes[ (int)EnigmaWC::Key::EItem ],
+                        KItemRecordSize,
+                        Total );
+                        
+  for ( guint32 Count = 0; Count < Total; ++ Count )
+  {
+    iItems.emplace_back();
+    CMapItem& Item = iItems.back();
+    
+    if ( !ReadIndexed_Object( Record, Item, *Decoder ))
+      return FALSE;
+
+    Item.iCategory     = (EnigmaWC::Category)Record[ 28 ];
+    Item.iOwner        = Record[ 29 ];
+    Item.iOwnerSaved   = Record[ 30 ];
+    Item.iOwnerRestart = Record[ 31 ];
+    
+    guint16 Flags = ReadIndexed_16Bit( Record + 32 );
+
+    Item.iActive          = (( Flags & KItemActive ) != 0 );
+    Item.iActiveSaved     = (( Flags & KItemActiveSaved ) != 0 );
+    Item.iActiveRestart   = (( Flags & KItemActiveRestart ) != 0 );
+    Item.iSelected        = (( Flags & KItemSelected ) != 0 );
+    Item.iSelectedSaved   = (( Flags & KItemSelectedSaved ) != 0 );
+    Item.iSelectedRestart = (( Flags & KItemSelectedRestart ) != 0 );
+    Item.iUsed            = (( Flags & KItemUsed ) != 0 );
+    Item.iUsedSaved       = (( Flags & KItemUsedSaved ) != 0 );
+    Item.iUsedRestart     = (( Flags & KItemUsedRestart ) != 0 );
+    
+    Record += KItemRecordSize;
+  }
+
+  // Read all player objects.  Unlike other objects, players are stored
+  // in their original order, since this sets each player's number.
+
+  Record = FindRecords( Sections[ (int)EnigmaWC::Key::EPlayer ],
+                        Sizes[ (int)EnigmaWC::Key::EPlayer ],
+                        KPlayerRecordSize,
+                        Total );
+                        
+  for ( guint32 Count = 0; Count < Total; ++ Count )
+  {
+    iPlayers.emplace_back();
+    CMapPlayer& Player = iPlayers.back();
+    
+    if ( !ReadIndexed_Object( Record, Player, *Decoder ))
+      return FALSE;
+
+    Player.iSurfaceSaved    = (EnigmaWC::Direction)Record[ 28 ];
+    Player.iRotationSaved   = (EnigmaWC::Direction)Record[ 29 ];
+    Player.iSurfaceRestart  = (EnigmaWC::Direction)Record[ 30 ];
+    Player.iRotationRestart = (EnigmaWC::Direction)Record[ 31 ];
+    ReadIndexed_Location( Record + 32, Player.iLocationSaved );
+    ReadIndexed_Location( Record + 38, Player.iLocationRestart );
+
+    if (( (int)Player.iSurfaceSaved >= (int)EnigmaWC::Direction::TOTAL )
+      || ( (int)Player.iRotationSaved >= (int)EnigmaWC::Direction::TOTAL )
+      || ( (int)Player.iSurfaceRestart >= (int)EnigmaWC::Direction::TOTAL )
+      || ( (int)Player.iRotationRestart >= (int)EnigmaWC::Direction::TOTAL ))
+    {
+      return FALSE;
+    }
+    
+    guint8 Flags = Record[ 44 ];
+    
+    Player.iActive         = (( Flags & KPlayerActive ) != 0 );
+    Player.iActiveSaved    = (( Flags & KPlayerActiveSaved ) != 0 );
+    Player.iActiveRestart  = (( Flags & KPlayerActiveRestart ) != 0 );
+    Player.iOutdoor        = (( Flags & KPlayerOutdoor ) != 0 );
+    Player.iOutdoorSaved   = (( Flags & KPlayerOutdoorSaved ) != 0 );
+    Player.iOutdoorRestart = (( Flags & KPlayerOutdoorRestart ) != 0 );
+
+    // Initialize values that are not stored in a game map.
+
+    Player.iNumber       = Count;
+    Player.iSurfaceNext  = EnigmaWC::Direction::ENone;
+    Player.iRotationNext = EnigmaWC::Direction::ENone;
+    Player.iLocationNext = Player.iLocation;
+    
+    Player.iContactBits     = 0;
+    Player.iAntiContactBits = 0;
+    
+    Record += KPlayerRecordSize;
+  }
+
+  // Read the map description.
+  
+  Section = Sections[ (int)EnigmaWC::Key::EDescription ];
+  
+  if ( Section != NULL )
+  {
+    iDescription.assign( (const gchar*)Section,
+                         Sizes[ (int)EnigmaWC::Key::EDescription ] );
+  }
+  
+  // The connection decoder is kept for reading streamed objects.
+  
+  if ( iObjects.GetStreamed() )
+    iDecoder = std::move( Decoder );
+
+  return TRUE;
+}
+
+//*-------------------------------------------------------------*
+//* This private function appends a section to an indexed game  *
+//* map, and adds an entry for it in the section directory.     *
+//*-------------------------------------------------------------*
+//* aFileData: Game map file data.                              *
+//* aEntry:    Index of directory entry in file data.           *
+//* aKey:      Key describing section contents.                 *
+//* aSection:  Section data.                                    *
+//*-------------------------------------------------------------*
+
+void WriteIndexed_Section( std::string& aFileData,
+                           gsize& aEntry,
+                           EnigmaWC::Key aKey,
+                           const std::string& aSection )
+{
+  // Sections begin on a 4-byte boundary.
+  
+  while ( aFileData.size() % 4 )
+    aFileData.push_back( '\x00' );
+    
+  std::string Entry;
+  
+  WriteIndexed_32Bit( Entry, (guint32)aKey );
+  WriteIndexed_32Bit( Entry, (guint32)aFileData.size() );
+  WriteIndexed_32Bit( Entry, (guint32)aSection.size() );
+  
+  aFileData.replace( aEntry, KIndexedEntrySize, Entry );
+  aFileData.append( aSection );
+  aEntry += KIndexedEntrySize;
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private method writes the game map as indexed (.ewcx)  *
+//* data.  Objects, teleporters and items are written sorted by *
+//* location.                                                   *
+//*-------------------------------------------------------------*
+//* aFileData: Buffer to receive game map file data.            *
+//* aSnapshot: Changing game map state to be written.           *
+//*-------------------------------------------------------------*
+
+void CMap::WriteIndexedData( std::string& aFileData,
+                             CMapSnapshot& aSnapshot )
+{
+  //*--------------------------------*
+  //* Write controller symbol table. *
+  //*--------------------------------*
+
+  std::string Controllers;
+  
+  WriteIndexed_32Bit( Controllers, (guint32)iControllers.size() );
+  gsize Index = 0;
+
+  for ( CMapController& Controller : iControllers )
+  {
+    // The Current bytecode block was created from the state of all map
+    // controller signals when the snapshot was taken.
+    
+    WriteIndexed_Block( Controllers, Controller.iName );
+    WriteIndexed_Block( Controllers, Controller.iSignalNames );
+    WriteIndexed_Block( Controllers, Controller.iMainCode );
+    WriteIndexed_Block( Controllers, aSnapshot.iCurrentCodes[ Index ] );
+    WriteIndexed_Block( Controllers, aSnapshot.iSavedCodes[ Index ] );
+    WriteIndexed_Block( Controllers, Controller.iRestartCode );
+    ++ Index;
+  }
+  
+  //*--------------------------------*
+  //* Write structural object table. *
+  //*--------------------------------*
+
+  CConnectionEncoder Encoder( iControllers );  
+  std::string Objects;
+  
+  std::vector<std::pair<guint64, CMapObjectList::iterator>> SortedObjects;
+  
+  if ( iObjects.GetStreamed() )
+  {
+    // The objects of a streamed map are already sorted in the game map
+    // file, and are copied from it one at a time.  The object count is
+    // filled in afterwards, since damaged records are skipped.
+    
+    CMapObject Streamed;
+    guint32 Written = 0;
+    
+    WriteIndexed_32Bit( Objects, 0 );
+    
+    for ( guint32 Index = 0; Index < iObjectTotal; ++ Index )
+    {
+      if ( ReadStreamedObject( Index, Streamed ))
+      {
+        WriteIndexed_Object( Objects, Streamed, Encoder );
+        ++ Written;
+      }
+    }
+    
+    std::string Count;
+    WriteIndexed_32Bit( Count, Written );
+    Objects.replace( 0, Count.size(), Count );
+  }
+  else
+  {
+    // The objects are sorted by their packed locations, so each packed
+    // object is only examined once.
+
+    CMapObjectList::iterator Object;
+
+    for ( Object = iObjects.begin(); Object != iObjects.end(); ++ Object )
+    {
+      SortedObjects.push_back(
+        std::make_pair( (*Object).iLocation.GetKey(), Object ));
+    }
+      
+    std::stable_sort( SortedObjects.begin(),
+                      SortedObjects.end(),
+                      []( const std::pair<guint64, CMapObjectList::iterator>&
+                            aFirst,
+                          const std::pair<guint64, CMapObjectList::iterator>&
+                            aSecond )
+                      { return aFirst.first < aSecond.first; } );
+    
+    WriteIndexed_32Bit( Objects, (guint32)SortedObjects.size() );
+    
+    CMapObject Unpacked;
+
+    for ( std::pair<guint64, CMapObjectList::iterator>& Sorted
+          : SortedObjects )
+    {
+      Sorted.second.Unpack( Unpacked );
+      WriteIndexed_Object( Objects, Unpacked, Encoder );
+    }
+  }
+    
+  //*--------------------------------*
+  //* Write teleporter object table. *
+  //*--------------------------------*
+
+  std::string Teleporters;
+  
+  std::vector<CMapTeleporter*> SortedTeleporters;
+  
+  for ( CMapTeleporter& Teleporter : iTeleporters )
+    SortedTeleporters.push_back( &Teleporter );
+    
+  std::stable_sort( SortedTeleporters.begin(),
+                    SortedTeleporters.end(),
+                    []( CMapTeleporter* aFirst, CMapTeleporter* aSecond )
+                    { return aFirst->iLocation < aSecond->iLocation; } );
+
+  WriteIndexed_32Bit( Teleporters, (guint32)SortedTeleporters.size() );
+  
+  for ( CMapTeleporter* Teleporter : SortedTeleporters )
+  {
+    WriteIndexed_Object( Teleporters, *Teleporter, Encoder );
+    WriteIndexed_8Bit( Teleporters, (guint8)Teleporter->iSurfaceArrival );
+    WriteIndexed_8Bit( Teleporters, (guint8)Teleporter->iRotationArrival );
+    WriteIndexed_Location( Teleporters, Teleporter->iLocationArrival );
+  }
+
+  //*--------------------------*
+  //* Write item object table. *
+  //*--------------------------*
+
+  std::string Items;
+  
+  std::vector<CMapItem*> SortedItems;
+  
+  for ( CMapItem& Item : aSnapshot.iItems )
+    SortedItems.push_back( &Item );
+    
+  std::stable_sort( SortedItems.begin(),
+                    SortedItems.end(),
+                    []( CMapItem* aFirst, CMapItem* aSecond )
+                    { return aFirst->iLocation < aSecond->iLocation; } );
+
+  WriteIndexed_32Bit( Items, (guint32)SortedItems.size() );
+  
+  for ( CMapItem* Item : SortedItems )
+  {
+    guint16 Flags = 0;
+    
+    if ( Item->iActive )
+      Flags |= KItemActive;
+
+    if ( Item->iActiveSaved )
+      Flags |= KItemActiveSaved;
+
+    if ( Item->iActiveRestart )
+      Flags |= KItemActiveRestart;
+
+    if ( Item->iSelected )
+      Flags |= KItemSelected;
+
+    if ( Item->iSelectedSaved )
+      Flags |= KItemSelectedSaved;
+
+    if ( Item->iSelectedRestart )
+      Flags |= KItemSelectedRestart;
+
+    if ( Item->iUsed )
+      Flags |= KItemUsed;
+
+    if ( Item->iUsedSaved )
+      Flags |= KItemUsedSaved;
+
+    if ( Item->iUsedRestart )
+      Flags |= KItemUsedRestart;
+    
+    WriteIndexed_Object( Items, *Item, Encoder );
+    WriteIndexed_8Bit( Items, (guint8)Item->iCategory );
+    WriteIndexed_8Bit( Items, Item->iOwner );
+    WriteIndexed_8Bit( Items, Item->iOwnerSaved );
+    WriteIndexed_8Bit( Items, Item->iOwnerRestart );
+    WriteIndexed_16Bit( Items, Flags );
+    WriteIndexed_16Bit( Items, 0 );
+  }
+
+  //*----------------------------*
+  //* Write player object table. *
+  //*----------------------------*
+
+  std::string Players;
+  
+  WriteIndexed_32Bit( Players, (guint32)aSnapshot.iPlayers.size() );
+  
+  for ( CMapPlayer& Player : aSnapshot.iPlayers )
+  {
+    guint8 Flags = 0;
+    
+    if ( Player.iActive )
+      Flags |= KPlayerActive;
+
+    if ( Player.iActiveSaved )
+      Flags |= KPlayerActiveSaved;
+
+    if ( Player.iActiveRestart )
+      Flags |= KPlayerActiveRestart;
+
+    if ( Player.iOutdoor )
+      Flags |= KPlayerOutdoor;
+
+    if ( Player.iOutdoorSaved )
+      Flags |= KPlayerOutdoorSaved;
+
+    if ( Player.iOutdoorRestart )
+      Flags |= KPlayerOutdoorRestart;
+
+    WriteIndexed_Object( Players, Player, Encoder );
+    WriteIndexed_8Bit( Players, (guint8)Player.iSurfaceSaved );
+    WriteIndexed_8Bit( Players, (guint8)Player.iRotationSaved );
+    WriteIndexed_8Bit( Players, (guint8)Player.iSurfaceRestart );
+    WriteIndexed_8Bit( Players, (guint8)Player.iRotationRestart );
+    WriteIndexed_Location( Players, Player.iLocationSaved );
+    WriteIndexed_Location( Players, Player.iLocationRestart );
+    WriteIndexed_8Bit( Players, Flags );
+    WriteIndexed_8Bit( Players, 0 );
+    WriteIndexed_16Bit( Players, 0 );
+  }
+
+  //*-----------------------------------------------*
+  //* Write connection name table, which is filled  *
+  //* while writing all object tables.              *
+  //*-----------------------------------------------*
+
+  std::string Names;
+  
+  WriteIndexed_32Bit( Names, Encoder.iTotal );
+  Names.append( Encoder.iNames );
+  
+  //*---------------------------------------*
+  //* Write file header and all sections.   *
+  //*---------------------------------------*
+
+  guint16 Flags = 0;
+  
+  if ( iSavable )
+    Flags |= KIndexedSavable;
+    
+  if ( iBounded )
+    Flags |= KIndexedBounded;
+
+  aFileData.assign( KIndexedCode );
+  WriteIndexed_16Bit( aFileData, KIndexedVersion );
+  WriteIndexed_16Bit( aFileData, Flags );
+  WriteIndexed_32Bit( aFileData, KIndexedSections );
+  WriteIndexed_Location( aFileData, iLowerBounds );
+  WriteIndexed_Location( aFileData, iUpperBounds );
+
+  // Reserve space for the section directory, which is filled in as each
+  // section is added.
+  
+  gsize Entry = aFileData.size();
+  aFileData.append( KIndexedSections * KIndexedEntrySize, '\x00' );
+  
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EController,
+                        Controllers );
+
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EData,
+                        Names );
+                        
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EObject,
+                        Objects );
+
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::ETeleporter,
+                        Teleporters );
+
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EPlayer,
+                        Players );
+
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EItem,
+                        Items );
+
+  WriteIndexed_Section( aFileData,
+                        Entry,
+                        EnigmaWC::Key::EDescription,
+                        iDescription );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This method saves the game map to a file using the filename *
+//* set when the game was last loaded from the file.            *
+//*-------------------------------------------------------------*
+
+void CMap::SaveFile()
+{
+  SaveFile( iFileName );
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private function reads the size and modification time    *
+//* of a file, which identify the version of a game map file that *
+//* a journal applies to.                                         *
+//*---------------------------------------------------------------*
+//* aFileName: Filename.                                          *
+//* aSize:     Reference to receive file size.                    *
+//* aModified: Reference to receive modification time (usec).     *
+//* RETURN:    TRUE if the file information was read.             *
+//*---------------------------------------------------------------*
+
+gboolean ReadFileStamp( const std::string& aFileName,
+                        gint64& aSize,
+                        gint64& aModified )
+{
+  try
+  {
+    Glib::RefPtr<Gio::File> File = Gio::File::create_for_path( aFileName );
+    Glib::RefPtr<Gio::FileInfo> Info =
+      File->query_info( "standard::size,time::modified,time::modified-usec" );
+
+    aSize     = Info->get_size();
+    aModified = ( Info->get_attribute_uint64( "time::modified" )
+                  * G_USEC_PER_SEC )
+              + Info->get_attribute_uint32( "time::modified-usec" );
+  }
+  catch( Glib::Error error )
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+//*---------------------------------------------------------------*
+//* This method saves the game map to a file.  A filename ending  *
+//* in ".ewcx" selects the indexed format, while any other name   *
+//* selects the keyvalue array format.  Saving over the game map  *
+//* file that was loaded only appends the changes to its journal, *
+//* until the journal is large enough to be compacted.            *
+//*---------------------------------------------------------------*
+//* aFileName: Game map filename.                                 *
+//* RETURN:    TRUE if the game map file was written.             *
+//*---------------------------------------------------------------*
+
+gboolean CMap::SaveFile( const std::string& aFileName )
+{
+  // Wait for a save still being written, then write this save at once.
+
+  FinishSaveFile();
+  iSaveJob = PrepareSave( aFileName );
+
+  if ( !iSaveJob )
+    return FALSE;
+
+  WriteSave( *iSaveJob );
+  return FinishSaveFile();
+}
+
+//*---------------------------------------------------------------*
+//* This method begins saving the game map to the file it was     *
+//* loaded from.  The changing game map state is copied at once,  *
+//* then the file is written by another thread while the game     *
+//* continues.  The completion slot is called by that thread once *
+//* the file has been written, after which FinishSaveFile() must  *
+//* be called.                                                    *
+//*---------------------------------------------------------------*
+//* aSaved: Slot called once the file has been written.           *
+//*---------------------------------------------------------------*
+
+void CMap::StartSaveFile( const type_slot_saved& aSaved )
+{
+  // Wait for an earlier save still being written.
+
+  FinishSaveFile();
+  iSaveJob = PrepareSave( iFileName );
+
+  // If there is nothing to be saved, signal completion immediately.
+
+  if ( !iSaveJob )
+  {
+    aSaved();
+    return;
+  }
+
+  iSaveThread = std::thread( [ this, aSaved ]()
+                             {
+                               WriteSave( *iSaveJob );
+                               aSaved();
+                             } );
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This method waits for a save being written to finish.  If the *
+//* game map file was written, its new identity is recorded for   *
+//* the journal.  If the save failed, the next save will write    *
+//* the complete game map file instead.                           *
+//*---------------------------------------------------------------*
+//* RETURN: FALSE if the last save could not be written.          *
+//*---------------------------------------------------------------*
+
+gboolean CMap::FinishSaveFile()
+{
+  if ( iSaveThread.joinable() )
+    iSaveThread.join();
+
+  if ( !iSaveJob )
+    return TRUE;
+
+  gboolean Written = iSaveJob->iWritten;
+
+  if ( iSaveJob->iBase )
+  {
+    if ( !Written )
+    {
+      // The journal may now be incomplete, or be missing the changes in
+      // this save, so it must be compacted.
+
+      iJournalSize = KJournalLimit;
+    }
+    else if ( !iSaveJob->iJournal )
+    {
+      // The game map file now includes all changes, so a new journal will
+      // be begun for it.
+
+      if ( !ReadFileStamp( iSaveJob->iFileName, iBaseSize, iBaseModified ))
+        iBaseSize = -1;
+
+      iJournalSize = 0;
+    }
+  }
+
+  iSaveJob.reset();
+  return Written;
+}
+
+//*---------------------------------------------------------------*
+//* This private method prepares a save, copying everything to be *
+//* written from the game map.  A save over the game map file     *
+//* becomes a journal block if the file has not been replaced     *
+//* since it was loaded or last written.                          *
+//*---------------------------------------------------------------*
+//* aFileName: Game map filename.                                 *
+//* RETURN:    Prepared save, or NULL if no game map is loaded.   *
+//*---------------------------------------------------------------*
+
+std::unique_ptr<CSaveJob> CMap::PrepareSave( const std::string& aFileName )
+{
+  // Return immediately if no game map is loaded. 
+
+  if ( !GetLoaded() )
+    return std::unique_ptr<CSaveJob>();
+
+  std::unique_ptr<CSaveJob> Job( new CSaveJob );
+
+  Job->iFileName = aFileName;
+  Job->iBase     = ( aFileName == iFileName );
+  Job->iJournal  = FALSE;
+  Job->iAppend   = FALSE;
+  Job->iWritten  = FALSE;
+
+  gint64 Size;
+  gint64 Modified;
+
+  if ( Job->iBase
+    && ( iBaseSize >= 0 )
+    && ( iJournalSize < KJournalLimit )
+    && ReadFileStamp( aFileName, Size, Modified )
+    && ( Size == iBaseSize )
+    && ( Modified == iBaseModified ))
+  {
+    // Append a block to the journal.  A new journal begins with a header
+    // identifying the game map file, and replaces any journal left behind
+    // for an older version of the file.
+
+    Job->iJournal = TRUE;
+    Job->iAppend  = ( iJournalSize != 0 );
+
+    if ( !Job->iAppend )
+    {
+      Job->iFileData.assign( KJournalCode );
+      WriteIndexed_32Bit( Job->iFileData, KJournalVersion );
+      WriteIndexed_64Bit( Job->iFileData, (guint64)iBaseSize );
+      WriteIndexed_64Bit( Job->iFileData, (guint64)iBaseModified );
+    }
+
+    WriteJournal( Job->iFileData );
+    iJournalSize += Job->iFileData.size();
+  }
+  else
+  {
+    // Copy the changing game map state for writing the complete game map
+    // file.
+
+    Job->iSnapshot.Take( *this );
+
+    if ( Job->iBase )
+      ClearChanged();
+  }
+
+  return Job;
+}
+
+//*---------------------------------------------------------------*
+//* This private method writes a prepared save.  It may be called *
+//* by another thread, since only the prepared copy of the        *
+//* changing game map state is used.                              *
+//*---------------------------------------------------------------*
+//* aJob: Prepared save.                                          *
+//*---------------------------------------------------------------*
+
+void CMap::WriteSave( CSaveJob& aJob )
+{
+  try
+  {
+    if ( aJob.iAppend )
+    {
+      // Append the block to the existing journal.
+
+      Glib::RefPtr<Gio::FileOutputStream> Stream =
+        Gio::File::create_for_path( JournalFileName( aJob.iFileName ))
+          ->append_to();
+
+      Stream->write( aJob.iFileData.data(), aJob.iFileData.size() );
+      Stream->close();
+    }
+    else if ( aJob.iJournal )
+    {
+      Glib::file_set_contents( JournalFileName( aJob.iFileName ),
+                               aJob.iFileData.data(),
+                               aJob.iFileData.size() );
+    }
+    else
+    {
+      // Prepare the game map file data, then write it to the file.
+
+      std::string FileData;
+  
+      if ( Glib::str_has_suffix( aJob.iFileName, KIndexedExtension ))
+        WriteIndexedData( FileData, aJob.iSnapshot );
+      else
+        WriteKeyValueData( FileData, aJob.iSnapshot );
+
+      Glib::file_set_contents( aJob.iFileName,
+                               FileData.data(),
+                               FileData.size() );
+
+      // A journal left behind no longer matches the game map file, and
+      // would be ignored when the game map is loaded.
+
+      if ( aJob.iBase )
+      {
+        try
+        {
+          Gio::File::create_for_path( JournalFileName( aJob.iFileName ))
+            ->remove();
+        }
+        catch( Glib::Error error )
+        {
+        }
+      }
+    }
+  }
+  catch( Glib::Error error )
+  {
+    return;
+  }
+
+  aJob.iWritten = TRUE;
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This method returns the journal filename for a game map.    *
+//*-------------------------------------------------------------*
+//* aFileName: Game map filename.                               *
+//* RETURN:    Journal filename.                                *
+//*-------------------------------------------------------------*
+
+std::string CMap::JournalFileName( const std::string& aFileName )
+{
+  return aFileName + KJournalExtension;
+}
+
+//*-------------------------------------------------------------*
+//* This private method clears the changed state of all items   *
+//* and controllers, once they match the saved game map.        *
+//*-------------------------------------------------------------*
+
+void CMap::ClearChanged()
+{
+  for ( CMapController& Controller : iControllers )
+    Controller.iChanged = FALSE;
+
+  for ( CMapItem& Item : iItems )
+    Item.iChanged = FALSE;
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private function reads the records of one journal block. *
+//* The records are first checked without being applied, so that  *
+//* a block is either applied completely or not at all.           *
+//*---------------------------------------------------------------*
+//* aData:        Journal data.                                   *
+//* aIndex:       Index of the first record.                      *
+//* aEnd:         Index following the last record.                *
+//* aControllers: Controllers, by number.                         *
+//* aPlayers:     Players, by number.                             *
+//* aItems:       Items, by number.                               *
+//* aApply:       TRUE to apply the records.                      *
+//* RETURN:       FALSE if any record has invalid data.           *
+//*---------------------------------------------------------------*
+
+gboolean ReadJournalBlock(
+  const guint8* aData,
+  gsize aIndex,
+  gsize aEnd,
+  std::vector<std::list<CMapController>::iterator>& aControllers,
+  std::vector<std::list<CMapPlayer>::iterator>& aPlayers,
+  std::vector<std::list<CMapItem>::iterator>& aItems,
+  gboolean aApply )
+{
+  std::list<CMapController>::iterator Controller;
+  std::list<CMapPlayer>::iterator Player;
+  std::list<CMapItem>::iterator Item;
+
+  while ( aEnd - aIndex >= KJournalRecordSize )
+  {
+    EnigmaWC::Key Key = (EnigmaWC::Key)aData[ aIndex ];
+    guint32 Number    = ReadIndexed_32Bit( aData + aIndex + 1 );
+    
+    aIndex += KJournalRecordSize;
+    
+    switch ( Key )
+    {
+      case EnigmaWC::Key::EController:
+      {
+        // A controller record has the signal states, followed by the
+        // saved state bytecode.
+
+        if (( Number >= aControllers.size() ) || ( aEnd - aIndex < 2 ))
+          return FALSE;
+
+        Controller   = aControllers[ Number ];
+        gsize Length = ReadIndexed_16Bit( aData + aIndex );
+        aIndex      += 2;
+
+        if (( Length != (*Controller).iSignals.size() )
+          || ( aEnd - aIndex < Length + 4 ))
+        {
+          return FALSE;
+        }
+
+        if ( aApply )
+        {
+          (*Controller).iSignals.assign( (const gchar*)aData + aIndex,
+                                         Length );
+        }
+
+        aIndex += Length;
+        Length  = ReadIndexed_32Bit( aData + aIndex );
+        aIndex += 4;
+
+        if ( aEnd - aIndex < Length )
+          return FALSE;
+
+        if ( aApply )
+        {
+          (*Controller).iSavedCode.assign( (const gchar*)aData + aIndex,
+                                           Length );
+        }
+
+        aIndex += Length;
+        break;
+      }
+
+      case EnigmaWC::Key::EPlayer:
+        if (( Number >= aPlayers.size() )
+          || ( aEnd - aIndex < KJournalPlayerSize ))
+        {
+          return FALSE;
+        }
+
+        // The surfaces and rotations index direction tables when the
+        // player is drawn, so they must be valid directions.
+
+        for ( gint Part = 0; Part < 4; ++ Part )
+        {
+          if ( aData[ aIndex + Part ] >= (guint8)EnigmaWC::Direction::TOTAL )
+            return FALSE;
+        }
+
+        if ( aApply )
+        {
+          Player = aPlayers[ Number ];
+
+          (*Player).iSurface       = (EnigmaWC::Direction)aData[ aIndex ];
+          (*Player).iRotation      = (EnigmaWC::Direction)aData[ aIndex + 1 ];
+          (*Player).iSurfaceSaved  = (EnigmaWC::Direction)aData[ aIndex + 2 ];
+          (*Player).iRotationSaved = (EnigmaWC::Direction)aData[ aIndex + 3 ];
+
+          ReadIndexed_Location( aData + aIndex + 4, (*Player).iLocation );
+          ReadIndexed_Location( aData + aIndex + 10,
+                                (*Player).iLocationSaved );
+
+          guint8 Flags = aData[ aIndex + 16 ];
+
+          (*Player).iActive       = ( Flags & KPlayerActive ) != 0;
+          (*Player).iActiveSaved  = ( Flags & KPlayerActiveSaved ) != 0;
+          (*Player).iOutdoor      = ( Flags & KPlayerOutdoor ) != 0;
+          (*Player).iOutdoorSaved = ( Flags & KPlayerOutdoorSaved ) != 0;
+        }
+
+        aIndex += KJournalPlayerSize;
+        break;
+
+      case EnigmaWC::Key::EItem:
+        if (( Number >= aItems.size() )
+          || ( aEnd - aIndex < KJournalItemSize ))
+        {
+          return FALSE;
+        }
+
+        if ( aApply )
+        {
+          Item = aItems[ Number ];
+
+          guint16 Flags = ReadIndexed_16Bit( aData + aIndex );
+
+          (*Item).iActive        = ( Flags & KItemActive ) != 0;
+          (*Item).iActiveSaved   = ( Flags & KItemActiveSaved ) != 0;
+          (*Item).iSelected      = ( Flags & KItemSelected ) != 0;
+          (*Item).iSelectedSaved = ( Flags & KItemSelectedSaved ) != 0;
+          (*Item).iUsed          = ( Flags & KItemUsed ) != 0;
+          (*Item).iUsedSaved     = ( Flags & KItemUsedSaved ) != 0;
+          (*Item).iOwner         = aData[ aIndex + 2 ];
+          (*Item).iOwnerSaved    = aData[ aIndex + 3 ];
+        }
+
+        aIndex += KJournalItemSize;
+        break;
+
+      default:
+        return FALSE;
+    }
+  }
+
+  // A block written completely has no bytes after its last record.
+
+  return ( aIndex == aEnd );
+}
+
+//*---------------------------------------------------------------*
+//* This private method applies the journal of a game map file    *
+//* that has just been read.  The journal is a header identifying *
+//* the game map file, followed by one block for each save.  Each *
+//* block is its 32-bit length, followed by a record for every    *
+//* item, player, and controller that changed.  A block left      *
+//* incomplete by an interrupted save is ignored.                 *
+//*---------------------------------------------------------------*
+//* aFileName: Game map filename.                                 *
+//*---------------------------------------------------------------*
+
+void CMap::ReadJournal( const std::string& aFileName )
+{
+  // Record the identity of the game map file.  A journal is begun only
+  // for a file that can be identified.
+
+  if ( !ReadFileStamp( aFileName, iBaseSize, iBaseModified ))
+    iBaseSize = -1;
+
+  iJournalSize = 0;
+
+  std::string Journal;
+
+  try
+  {
+    Journal = Glib::file_get_contents( JournalFileName( aFileName ));
+  }
+  catch( Glib::Error error )
+  {
+  }
+
+  const guint8* Data = (const guint8*)Journal.data();
+  gsize Size         = Journal.size();
+
+  // Ignore a journal for another version of the game map file.
+
+  if (( iBaseSize < 0 )
+    || ( Size < KJournalHeaderSize )
+    || ( memcmp( Data, KJournalCode, 4 ) != 0 )
+    || ( ReadIndexed_32Bit( Data + 4 ) != KJournalVersion )
+    || ( (gint64)ReadIndexed_64Bit( Data + 8 ) != iBaseSize )
+    || ( (gint64)ReadIndexed_64Bit( Data + 16 ) != iBaseModified ))
+  {
+    ClearChanged();
+    return;
+  }
+
+  // Prepare tables for finding controllers and items by index.
+
+  std::vector<std::list<CMapController>::iterator> Controllers;
+  std::vector<std::list<CMapPlayer>::iterator> Players;
+  std::vector<std::list<CMapItem>::iterator> Items;
+
+  std::list<CMapController>::iterator Controller;
+  std::list<CMapPlayer>::iterator Player;
+  std::list<CMapItem>::iterator Item;
+
+  for ( Controller = iControllers.begin();
+        Controller != iControllers.end();
+        ++ Controller )
+  {
+    Controllers.push_back( Controller );
+  }
+
+  for ( Player = iPlayers.begin(); Player != iPlayers.end(); ++ Player )
+    Players.push_back( Player );
+
+  for ( Item = iItems.begin(); Item != iItems.end(); ++ Item )
+    Items.push_back( Item );
+
+  // Apply every complete block in order.
+
+  gsize Block = KJournalHeaderSize;
+  gboolean Valid = TRUE;
+
+  while ( Valid && ( Size - Block >= 4 ))
+  {
+    gsize End = ReadIndexed_32Bit( Data + Block );
+
+    if ( End > Size - Block - 4 )
+      break;
+
+    // A block is applied only if all of its records are valid, so that a
+    // damaged block cannot leave the game map partly restored.
+
+    gsize Index = Block + 4;
+    End += Index;
+
+    Valid = ReadJournalBlock( Data, Index, End,
+                              Controllers, Players, Items, FALSE );
+
+    if ( Valid )
+    {
+      ReadJournalBlock( Data, Index, End,
+                        Controllers, Players, Items, TRUE );
+    }
+
+    Block = End;
+  }
+
+  // Player locations and item owners were changed directly, so index them
+  // again.
+
+  iPlayers.Index();
+  iItems.Index();
+
+  // Continue the journal after its last complete block.  If the journal
+  // could not be fully applied, compact it into the game map file at the
+  // next save instead.
+
+  if ( Valid && ( Block == Size ))
+    iJournalSize = Size;
+  else
+    iJournalSize = KJournalLimit;
+
+  ClearChanged();
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method adds a journal block to a buffer, with a  *
+//* record for every item and controller changed since the game   *
+//* map was last saved.  Players change with almost every move,   *
+//* and there are very few, so every player has a record.         *
+//*---------------------------------------------------------------*
+//* aBlock: Buffer to receive the journal block.                  *
+//*---------------------------------------------------------------*
+
+void CMap::WriteJournal( std::string& aBlock )
+{
+  std::string Records;
+  guint32 Number = 0;
+
+  for ( CMapController& Controller : iControllers )
+  {
+    if ( Controller.iChanged )
+    {
+      WriteIndexed_8Bit( Records, (guint8)EnigmaWC::Key::EController );
+      WriteIndexed_32Bit( Records, Number );
+      WriteIndexed_16Bit( Records, (guint16)Controller.iSignals.size() );
+      Records.append( Controller.iSignals );
+      WriteIndexed_Block( Records, Controller.iSavedCode );
+    }
+
+    ++ Number;
+  }
+
+  Number = 0;
+
+  for ( CMapPlayer& Player : iPlayers )
+  {
+    WriteIndexed_8Bit( Records, (guint8)EnigmaWC::Key::EPlayer );
+    WriteIndexed_32Bit( Records, Number ++ );
+    WriteIndexed_8Bit( Records, (guint8)Player.iSurface );
+    WriteIndexed_8Bit( Records, (guint8)Player.iRotation );
+    WriteIndexed_8Bit( Records, (guint8)Player.iSurfaceSaved );
+    WriteIndexed_8Bit( Records, (guint8)Player.iRotationSaved );
+    WriteIndexed_Location( Records, Player.iLocation );
+    WriteIndexed_Location( Records, Player.iLocationSaved );
+
+    guint8 Flags = 0;
+
+    if ( Player.iActive )
+      Flags |= KPlayerActive;
+
+    if ( Player.iActiveSaved )
+      Flags |= KPlayerActiveSaved;
+
+    if ( Player.iOutdoor )
+      Flags |= KPlayerOutdoor;
+
+    if ( Player.iOutdoorSaved )
+      Flags |= KPlayerOutdoorSaved;
+
+    WriteIndexed_8Bit( Records, Flags );
+  }
+
+  Number = 0;
+
+  for ( CMapItem& Item : iItems )
+  {
+    if ( Item.iChanged )
+    {
+      guint16 Flags = 0;
+
+      if ( Item.iActive )
+        Flags |= KItemActive;
+
+      if ( Item.iActiveSaved )
+        Flags |= KItemActiveSaved;
+
+      if ( Item.iSelected )
+        Flags |= KItemSelected;
+
+      if ( Item.iSelectedSaved )
+        Flags |= KItemSelectedSaved;
+
+      if ( Item.iUsed )
+        Flags |= KItemUsed;
+
+      if ( Item.iUsedSaved )
+        Flags |= KItemUsedSaved;
+
+      WriteIndexed_8Bit( Records, (guint8)EnigmaWC::Key::EItem );
+      WriteIndexed_32Bit( Records, Number );
+      WriteIndexed_16Bit( Records, Flags );
+      WriteIndexed_8Bit( Records, Item.iOwner );
+      WriteIndexed_8Bit( Records, Item.iOwnerSaved );
+    }
+
+    ++ Number;
   }
 
+  WriteIndexed_Block( aBlock, Records );
+  ClearChanged();
   return;
 }
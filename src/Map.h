@@ -19,12 +19,18 @@
 #ifndef __MAP_H__
 #define __MAP_H__
 
+#include <thread>
 #include <gtkmm.h>
 #include "MapObjectList.h"
 #include "MapTeleporterList.h"
 #include "MapItemList.h"
 #include "MapPlayerList.h"
 #include "MapControllerList.h"
+#include "MapBricks.h"
+
+class CConnectionDecoder;
+class CMapSnapshot;
+class CSaveJob;
 
 class CMap
 {
@@ -32,22 +38,40 @@ class CMap
     // Public methods.
 		
     CMap();
+    ~CMap();
     void Clear();
     void Restart();
     void Load();
     void Save();
     void LoadFile( const std::string& aFileName );
+    gboolean LoadSummary( const std::string& aFileName );
     void SaveFile(); 
+    gboolean SaveFile( const std::string& aFileName );
+
+    // Save completion slot type.  The slot is called by the thread writing
+    // the game map file, and would usually signal the main loop to call
+    // FinishSaveFile().
+
+    typedef sigc::slot<void> type_slot_saved;
+
+    void StartSaveFile( const type_slot_saved& aSaved );
+    gboolean FinishSaveFile();
     gboolean GetLoaded();
+    void SetFileName( const std::string& aFileName );
     gboolean GetSavable();    
     CMapControllerList& Controllers();
     CMapObjectList& Objects();
     CMapTeleporterList& Teleporters();
     CMapItemList& Items();
     CMapPlayerList& Players();
+    CMapBricks& Bricks();
+    void ListIDs( std::vector<EnigmaWC::ID>& aIDs );
     std::string& Description();
     const CMapLocation& UpperBounds();
     const CMapLocation& LowerBounds();
+    void SetStreamBudget( gsize aBudget );
+    void Stream( const CMapLocation& aLocation, guint16 aReach );
+    static std::string JournalFileName( const std::string& aFileName );
 
     // Public data.
 		
@@ -55,6 +79,23 @@ class CMap
     // Private methods.
     
     void AdjustBoundary( const CMapLocation& aLocation );
+    gboolean ReadFile( const std::string& aFileName );
+    gboolean ReadKeyValueData( const guint8* aFileData, gsize aFileSize );
+    gboolean ReadIndexedData( const guint8* aFileData, gsize aFileSize );
+    void WriteKeyValueData( std::string& aFileData,
+                            CMapSnapshot& aSnapshot );
+
+    void WriteIndexedData( std::string& aFileData,
+                           CMapSnapshot& aSnapshot );
+
+    std::unique_ptr<CSaveJob> PrepareSave( const std::string& aFileName );
+    void WriteSave( CSaveJob& aJob );
+    void ReadRegion( const CMapLocation& aLower,
+                     std::list<CMapObject>& aObjects );
+    gboolean ReadStreamedObject( guint32 aIndex, CMapObject& aObject );
+    void ReadJournal( const std::string& aFileName );
+    void WriteJournal( std::string& aBlock );
+    void ClearChanged();
   
     // Private data.
 
@@ -64,11 +105,23 @@ class CMap
     CMapTeleporterList iTeleporters;  // List of teleporter MapObjects.
     CMapItemList iItems;              // List of item MapObjects.
     CMapPlayerList iPlayers;          // List of player MapObjects.
+    CMapBricks iBricks;               // Room contents grouped in bricks.
     std::string iDescription;         // Description of game map in UTF-8 format.
     gboolean iSavable;                // TRUE if map can be saved internally.
+    gboolean iSummary;                // TRUE if only a map summary is read.
     gboolean iBounded;                // TRUE if a map boundary has been set. 
     CMapLocation iLowerBounds;        // Lower map boundary.
     CMapLocation iUpperBounds;        // Upper map boundary.
+    gsize iStreamBudget;              // Object budget before streaming.
+    GMappedFile* iMappedFile;         // Game map file, if streaming.
+    const guint8* iObjectRecords;     // Object records, if streaming.
+    guint32 iObjectTotal;             // Number of object records.
+    std::unique_ptr<CConnectionDecoder> iDecoder; // Record decoder.
+    gint64 iBaseSize;                 // Journaled game map file size.
+    gint64 iBaseModified;             // Journaled game map file time.
+    gsize iJournalSize;               // Journal size, or 0 if not begun.
+    std::unique_ptr<CSaveJob> iSaveJob; // Save being written.
+    std::thread iSaveThread;          // Thread writing the save.
 };
 
 #endif // __MAP_H__
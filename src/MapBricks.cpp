@@ -0,0 +1,330 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file is the MapBricks class implementation.  The MapBricks class
+// groups the contents of game map rooms into bricks of 16 x 16 x 16 rooms,
+// allowing all rooms in a box of the game map to be found in a few passes.
+// Each brick has an occupancy bitmap, so empty rooms are never examined.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstring>
+#include "MapBricks.h"
+
+//*---------------------------------------------------------------*
+//* This private function returns the key of the brick containing *
+//* a map location.                                               *
+//*---------------------------------------------------------------*
+//* aEast:  Room East location.                                   *
+//* aNorth: Room North location.                                  *
+//* aAbove: Room Above location.                                  *
+//* RETURN: Brick key.                                            *
+//*---------------------------------------------------------------*
+
+guint64 BrickKey( guint32 aEast, guint32 aNorth, guint32 aAbove )
+{
+  return ((guint64)( aAbove >> KBrickShift ) << 32 )
+       | ((guint64)( aNorth >> KBrickShift ) << 16 )
+       | (guint64)( aEast >> KBrickShift );
+}
+
+//*---------------------------------------------------------------*
+//* This private function returns the offset of a room within its *
+//* brick.  Offsets are ordered by Above, North, then East, like  *
+//* map locations.                                                *
+//*---------------------------------------------------------------*
+//* aLocation: Map location.                                      *
+//* RETURN:    Room offset.                                       *
+//*---------------------------------------------------------------*
+
+guint16 BrickOffset( const CMapLocation& aLocation )
+{
+  return (( aLocation.iAbove & ( KBrickSize - 1 )) << ( 2 * KBrickShift ))
+       | (( aLocation.iNorth & ( KBrickSize - 1 )) << KBrickShift )
+       | ( aLocation.iEast & ( KBrickSize - 1 ));
+}
+
+//*----------------------*
+//* Default constructor. *
+//*----------------------*
+
+CMapBricks::CMapBricks()
+{
+  Clear();
+  return;
+}
+
+//*-----------------------------------------------------------*
+//* This method returns the bricks to the empty condition.    *
+//*-----------------------------------------------------------*
+
+void CMapBricks::Clear()
+{
+  iBricks.clear();
+  iVersion = 0;
+  return;
+}
+
+//*-----------------------------------------------------------*
+//* This method returns the version of the object index the   *
+//* bricks were built from.                                   *
+//*-----------------------------------------------------------*
+//* RETURN: Object index version.                             *
+//*-----------------------------------------------------------*
+
+guint64 CMapBricks::GetVersion()
+{
+  return iVersion;
+}
+
+//*---------------------------------------------------------------*
+//* This method builds the bricks from the objects, teleporters,  *
+//* and items of a game map.  The contents of each room are kept  *
+//* in the order returned by the Read() method of each list.      *
+//*---------------------------------------------------------------*
+//* aObjects:     List of map objects.                            *
+//* aTeleporters: List of map teleporters.                        *
+//* aItems:       List of map items.                              *
+//*---------------------------------------------------------------*
+
+void CMapBricks::Build( CMapObjectList& aObjects,
+                        CMapTeleporterList& aTeleporters,
+                        CMapItemList& aItems )
+{
+  iBricks.clear();
+  iVersion = aObjects.GetVersion();
+
+  // Find every occupied room, ordered by brick and then by the room offset
+  // within the brick.
+
+  std::vector<std::pair<guint64, guint64>> Rooms;
+
+  auto AddRoom = [ &Rooms ]( const CMapLocation& aLocation )
+  {
+    Rooms.push_back(
+      std::make_pair( BrickKey( aLocation.iEast,
+                                aLocation.iNorth,
+                                aLocation.iAbove ),
+                      aLocation.GetKey() ));
+  };
+
+  for ( CMapObjectList::CObject Object : aObjects )
+    AddRoom( Object.iLocation );
+
+  for ( CMapTeleporter& Teleporter : aTeleporters )
+    AddRoom( Teleporter.iLocation );
+
+  for ( CMapItem& Item : aItems )
+    AddRoom( Item.iLocation );
+
+  std::sort( Rooms.begin(), Rooms.end() );
+  Rooms.erase( std::unique( Rooms.begin(), Rooms.end() ), Rooms.end() );
+
+  // Copy the contents of each room into its brick.
+
+  std::list<CMapObjectList::iterator> Objects;
+  std::list<std::list<CMapTeleporter>::iterator> Teleporters;
+  std::list<std::list<CMapItem>::iterator> Items;
+  CMapLocation Location;
+  CSpan Span;
+
+  for ( std::pair<guint64, guint64>& Room : Rooms )
+  {
+    CBrick& Brick = iBricks[ Room.first ];
+
+    if ( Brick.iRooms.empty() )
+    {
+      memset( Brick.iPlanes, 0, sizeof( Brick.iPlanes ));
+      memset( Brick.iRows, 0, sizeof( Brick.iRows ));
+    }
+
+    Location.iAbove = (guint16)( Room.second >> 32 );
+    Location.iNorth = (guint16)( Room.second >> 16 );
+    Location.iEast  = (guint16)Room.second;
+
+    Objects.clear();
+    Teleporters.clear();
+    Items.clear();
+    aObjects.Read( Location, Objects );
+    aTeleporters.Read( Location, Teleporters );
+    aItems.Read( Location, Items );
+
+    Span.iOffset          = BrickOffset( Location );
+    Span.iObject          = Brick.iObjects.size();
+    Span.iTeleporter      = Brick.iTeleporters.size();
+    Span.iItem            = Brick.iItems.size();
+    Span.iObjectCount     = (guint16)MIN( Objects.size(), G_MAXUINT16 );
+    Span.iTeleporterCount = (guint16)MIN( Teleporters.size(), G_MAXUINT16 );
+    Span.iItemCount       = (guint16)MIN( Items.size(), G_MAXUINT16 );
+
+    Brick.iObjects.insert( Brick.iObjects.end(),
+                           Objects.begin(),
+                           std::next( Objects.begin(), Span.iObjectCount ));
+
+    Brick.iTeleporters.insert( Brick.iTeleporters.end(),
+                               Teleporters.begin(),
+                               std::next( Teleporters.begin(),
+                                          Span.iTeleporterCount ));
+
+    Brick.iItems.insert( Brick.iItems.end(),
+                         Items.begin(),
+                         std::next( Items.begin(), Span.iItemCount ));
+
+    Brick.iRooms.push_back( Span );
+
+    // Mark the room as occupied.
+
+    Brick.iPlanes[ Span.iOffset >> ( 2 * KBrickShift ) ]
+      |= 1 << (( Span.iOffset >> KBrickShift ) & ( KBrickSize - 1 ));
+
+    Brick.iRows[ Span.iOffset >> KBrickShift ]
+      |= 1 << ( Span.iOffset & ( KBrickSize - 1 ));
+  }
+
+  // Count the occupied rooms before each row, which locates the first room
+  // of a row within the rooms of its brick.
+
+  for ( std::pair<const guint64, CBrick>& Brick : iBricks )
+  {
+    guint16 Rank = 0;
+
+    for ( gint Row = 0; Row < KBrickRows; ++ Row )
+    {
+      Brick.second.iRanks[ Row ] = Rank;
+      Rank += __builtin_popcount( Brick.second.iRows[ Row ] );
+    }
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This method returns the contents of all occupied rooms within *
+//* a box of the game map.  The rooms are returned in no          *
+//* particular order, and remain valid until the bricks are next  *
+//* built.                                                        *
+//*---------------------------------------------------------------*
+//* aLower: Lower corner of box.                                  *
+//* aUpper: Upper corner of box.                                  *
+//* aRooms: Buffer to receive rooms.                              *
+//*---------------------------------------------------------------*
+
+void CMapBricks::Read( const CMapLocation& aLower,
+                       const CMapLocation& aUpper,
+                       std::vector<CRoom>& aRooms ) const
+{
+  std::unordered_map<guint64, CBrick>::const_iterator Brick;
+  CRoom Room;
+
+  // Visit every brick overlapping the box.
+
+  for ( guint32 Above = aLower.iAbove >> KBrickShift;
+        Above <= (guint32)( aUpper.iAbove >> KBrickShift );
+        ++ Above )
+  {
+    for ( guint32 North = aLower.iNorth >> KBrickShift;
+          North <= (guint32)( aUpper.iNorth >> KBrickShift );
+          ++ North )
+    {
+      for ( guint32 East = aLower.iEast >> KBrickShift;
+            East <= (guint32)( aUpper.iEast >> KBrickShift );
+            ++ East )
+      {
+        Brick = iBricks.find( BrickKey( East << KBrickShift,
+                                        North << KBrickShift,
+                                        Above << KBrickShift ));
+
+        if ( Brick == iBricks.end() )
+          continue;
+
+        // Find the part of the box within the brick, and the masks of
+        // North rows and East rooms within it.
+
+        const CBrick& Contents = (*Brick).second;
+
+        guint32 LowerAbove = MAX( aLower.iAbove, Above << KBrickShift )
+                           - ( Above << KBrickShift );
+        guint32 UpperAbove = MIN( aUpper.iAbove,
+                                  ( Above << KBrickShift ) + KBrickSize - 1 )
+                           - ( Above << KBrickShift );
+        guint32 LowerNorth = MAX( aLower.iNorth, North << KBrickShift )
+                           - ( North << KBrickShift );
+        guint32 UpperNorth = MIN( aUpper.iNorth,
+                                  ( North << KBrickShift ) + KBrickSize - 1 )
+                           - ( North << KBrickShift );
+        guint32 LowerEast  = MAX( aLower.iEast, East << KBrickShift )
+                           - ( East << KBrickShift );
+        guint32 UpperEast  = MIN( aUpper.iEast,
+                                  ( East << KBrickShift ) + KBrickSize - 1 )
+                           - ( East << KBrickShift );
+
+        guint32 NorthMask = (( 2u << UpperNorth ) - 1 )
+                          & ~(( 1u << LowerNorth ) - 1 );
+        guint32 EastMask  = (( 2u << UpperEast ) - 1 )
+                          & ~(( 1u << LowerEast ) - 1 );
+
+        for ( guint32 Plane = LowerAbove; Plane <= UpperAbove; ++ Plane )
+        {
+          // Skip planes without occupied rooms in the box.
+
+          if (( Contents.iPlanes[ Plane ] & NorthMask ) == 0 )
+            continue;
+
+          for ( guint32 Line = LowerNorth; Line <= UpperNorth; ++ Line )
+          {
+            guint32 Row  = ( Plane << KBrickShift ) | Line;
+            guint32 Bits = Contents.iRows[ Row ] & EastMask;
+
+            if ( Bits == 0 )
+              continue;
+
+            // Occupied rooms are kept in location order, so the rooms
+            // within the box follow the rooms before the box in this row.
+
+            guint32 Index = Contents.iRanks[ Row ]
+                          + __builtin_popcount( Contents.iRows[ Row ]
+                                                & (( 1u << LowerEast ) - 1 ));
+
+            while ( Bits != 0 )
+            {
+              const CSpan& Span = Contents.iRooms[ Index ];
+
+              Room.iLocation.iAbove = (guint16)(( Above << KBrickShift )
+                                              | Plane );
+              Room.iLocation.iNorth = (guint16)(( North << KBrickShift )
+                                              | Line );
+              Room.iLocation.iEast  = (guint16)(( East << KBrickShift )
+                                              | __builtin_ctz( Bits ));
+
+              Room.iObjects         = Contents.iObjects.data() + Span.iObject;
+              Room.iTeleporters     = Contents.iTeleporters.data()
+                                    + Span.iTeleporter;
+              Room.iItems           = Contents.iItems.data() + Span.iItem;
+              Room.iObjectCount     = Span.iObjectCount;
+              Room.iTeleporterCount = Span.iTeleporterCount;
+              Room.iItemCount       = Span.iItemCount;
+              aRooms.push_back( Room );
+
+              Bits &= Bits - 1;
+              ++ Index;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return;
+}
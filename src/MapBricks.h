@@ -0,0 +1,101 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file is the MapBricks class header.  The MapBricks class groups the
+// contents of game map rooms into bricks of 16 x 16 x 16 rooms, allowing
+// all rooms in a box of the game map to be found in a few passes.  Each
+// brick has an occupancy bitmap, so empty rooms are never examined.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __MAPBRICKS_H__
+#define __MAPBRICKS_H__
+
+#include <unordered_map>
+#include <vector>
+#include <gtkmm.h>
+#include "MapObjectList.h"
+#include "MapTeleporterList.h"
+#include "MapItemList.h"
+
+#define KBrickShift 4                       // Bricks are 16 rooms wide.
+#define KBrickSize  ( 1 << KBrickShift )    // Also the bits in a guint16.
+#define KBrickRows  ( KBrickSize * KBrickSize )
+
+class CMapBricks
+{
+  public:
+    // Public classes.
+
+    class CRoom
+    {
+      public:
+        CMapLocation iLocation;                                  // Location.
+        const CMapObjectList::iterator* iObjects;                // Objects.
+        const std::list<CMapTeleporter>::iterator* iTeleporters; // Teleporters.
+        const std::list<CMapItem>::iterator* iItems;             // Items.
+        guint16 iObjectCount;                                    // Objects.
+        guint16 iTeleporterCount;                                // Teleporters.
+        guint16 iItemCount;                                      // Items.
+    };
+
+    // Public methods.
+
+    CMapBricks();
+    void Clear();
+
+    void Build( CMapObjectList& aObjects,
+                CMapTeleporterList& aTeleporters,
+                CMapItemList& aItems );
+
+    guint64 GetVersion();
+
+    void Read( const CMapLocation& aLower,
+               const CMapLocation& aUpper,
+               std::vector<CRoom>& aRooms ) const;
+
+  private:
+    // Private classes.
+
+    class CSpan
+    {
+      public:
+        guint16 iOffset;             // Room offset within brick.
+        guint32 iObject;             // First object.
+        guint32 iTeleporter;         // First teleporter.
+        guint32 iItem;               // First item.
+        guint16 iObjectCount;        // Object count.
+        guint16 iTeleporterCount;    // Teleporter count.
+        guint16 iItemCount;          // Item count.
+    };
+
+    class CBrick
+    {
+      public:
+        std::vector<CSpan> iRooms;   // Occupied rooms, in location order.
+        guint16 iPlanes[ KBrickSize ];  // Occupied North rows in each plane.
+        guint16 iRows[ KBrickRows ];    // Occupied East rooms in each row.
+        guint16 iRanks[ KBrickRows ];   // Occupied rooms before each row.
+        std::vector<CMapObjectList::iterator> iObjects;
+        std::vector<std::list<CMapTeleporter>::iterator> iTeleporters;
+        std::vector<std::list<CMapItem>::iterator> iItems;
+    };
+
+    // Private data.
+
+    std::unordered_map<guint64, CBrick> iBricks;  // Bricks with occupied rooms.
+    guint64 iVersion;                             // Version of brick contents.
+};
+
+#endif // __MAPBRICKS_H__
@@ -17,6 +17,7 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <atomic>
 #include "EnigmaWC.h"
 #include "MapController.h"
 
@@ -28,12 +29,20 @@
 
 #define KStackSize 8
 
+// Generation of all signal states, which changes whenever a signal may have
+// changed.  Views built from signal states compare generations to find if
+// they are still current.  Map summaries are loaded on worker threads while
+// a game is played, so the generation is changed and read atomically.
+
+static std::atomic<guint64> Generation( 0 );
+
 //*----------------------*
 //* Default constructor. *
 //*----------------------*
 
 CMapController::CMapController()
 {    
+  iChanged = FALSE;
   return;
 }
 
@@ -87,6 +96,7 @@ void CMapController::Load()
 void CMapController::Save()
 {
   CreateSignalCode( iSavedCode );
+  iChanged = TRUE;
   return;
 }
 
@@ -118,11 +128,12 @@ void CMapController::Restart()
 //* This method returns an numerical index to a signal.  This index *
 //* corresponds to that used by bytecode signal instructions.       *
 //*-----------------------------------------------------------------*
-//* aName:  Signal name.                                            *
-//* RETURN: Signal index, or G_MAXUINT16 if not found.              *
+//* aName:   Signal name (need not be terminated).                  *
+//* aLength: Signal name length.                                    *
+//* RETURN:  Signal index, or G_MAXUINT16 if not found.             *
 //*-----------------------------------------------------------------*
 
-guint16 CMapController::GetSignalIndex( const std::string& aName )
+guint16 CMapController::GetSignalIndex( const gchar* aName, gsize aLength )
 {
   std::string::size_type Position = 0;
   std::string::size_type Terminator;
@@ -139,7 +150,8 @@ guint16 CMapController::GetSignalIndex( const std::string& aName )
     
       Compare = iSignalNames.compare( Position,
                                       Terminator - Position,
-                                      aName );
+                                      aName,
+                                      aLength );
                                             
       if ( Compare != 0 )
       {
@@ -259,6 +271,29 @@ void CMapController::CreateSignalCode( std::string& aCode  )
   return;
 }
 
+//*--------------------------------------------------------------*
+//* This method returns the generation of all signal states.     *
+//* The generation changes whenever any signal may have changed. *
+//*--------------------------------------------------------------*
+//* RETURN: Signal generation.                                   *
+//*--------------------------------------------------------------*
+
+guint64 CMapController::GetGeneration()
+{
+  return Generation;
+}
+
+//*-----------------------------------------------------------*
+//* This method starts a new generation of all signal states. *
+//* It is called whenever any signal may have changed.        *
+//*-----------------------------------------------------------*
+
+void CMapController::NextGeneration()
+{
+  ++ Generation;
+  return;
+}
+
 //*---------------------------------------*
 //* This method runs a block of bytecode. *
 //*---------------------------------------*
@@ -275,6 +310,11 @@ void CMapController::Run( const std::string& aCode )
   EnigmaWC::OpCode OpCode;
   gboolean Register;
 
+  // Running bytecode may change signal states, which must be saved.
+
+  iChanged = TRUE;
+  NextGeneration();
+
   // Execute all bytecode instructions sequentially in one pass.
 
   StackPointer = 0;
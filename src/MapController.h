@@ -29,7 +29,7 @@ class CMapController
 
     CMapController();
     void Initialize();
-    guint16 GetSignalIndex( const std::string& aName );
+    guint16 GetSignalIndex( const gchar* aName, gsize aLength );
     gboolean SetSignalState( guint16 aIndex, gboolean aState );
     gboolean GetSignalState( guint16 aIndex );
     void Run( const std::string& aCode );
@@ -37,6 +37,8 @@ class CMapController
     void Load();
     void Save();
     void Restart();
+    static guint64 GetGeneration();
+    static void NextGeneration();
 		
 		// Public data.
 	  
@@ -48,6 +50,7 @@ class CMapController
     std::string iRestartCode;         // Restart state bytecode.
     std::string iMainCode;            // Main bytecode.
     Glib::Rand iRandom;               // Random number generator.
+    gboolean iChanged;                // TRUE if changed since last saved.
 };
 
 #endif // __MAPCONTROLLER_H__
@@ -2,7 +2,9 @@
 // Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
 // 
 // This file is the MapControllerList class implementation.
-// The MapControllerList class manages a list of MapControllers. 
+// The MapControllerList class manages a list of MapControllers.  A symbol
+// table of controller and signal names allows connections to be resolved
+// without searching.
 //
 // This program is free software: you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -29,6 +31,24 @@ CMapControllerList::CMapControllerList()
   return;
 }
 
+//*------------------------------------------------------------*
+//* This method returns the list to the empty condition.       *
+//*------------------------------------------------------------*
+
+void CMapControllerList::Clear()
+{
+  // Clear the list in the base class, and the symbol table and interned
+  // connection names which refer to it.
+
+  clear();
+  iControllers.clear();
+  iControllerNames.clear();
+  iSignalNames.clear();
+  iNames.clear();
+  iRetiredNames.clear();
+  return;
+}
+
 //*-----------------------------------------------------------*
 //* This method changes all controllers to their saved state. *
 //*-----------------------------------------------------------*
@@ -76,3 +96,185 @@ void CMapControllerList::Restart()
   
   return;
 }
+
+//*------------------------------------------------------------------*
+//* This method builds the symbol table of controller and signal     *
+//* names.  It is done once after all controllers have been added,   *
+//* and before any connections are made.  As when searching the list *
+//* by name, only the first controller with a given name, and the    *
+//* first signal with a given name in that controller, are used.     *
+//*------------------------------------------------------------------*
+
+void CMapControllerList::Index()
+{
+  // Connections made before the controllers changed keep their interned
+  // names, but new connections are resolved with the new symbol table.
+
+  if ( !iNames.empty() )
+  {
+    iRetiredNames.push_back( std::move( iNames ));
+    iNames.clear();
+  }
+
+  iControllers.clear();
+  iControllerNames.clear();
+  iSignalNames.clear();
+
+  std::list<CMapController>::iterator Controller;
+  CSignalIndex Signal;
+
+  for ( Controller = begin(); Controller != end(); ++ Controller )
+  {
+    Signal.iController = (guint32)iControllers.size();
+    iControllers.push_back( Controller );
+
+    // A connection name is split at its first separator character, so a
+    // controller name with a separator can never be connected to.
+
+    if (( (*Controller).iName.find( ':' ) != std::string::npos )
+      || !iControllerNames.emplace( (*Controller).iName,
+                                    Signal.iController ).second )
+    {
+      continue;
+    }
+
+    // Add the fully-qualified name of every controller signal
+    // (eg. "Controller:Signal").  Each name in the packed array is
+    // terminated by a '\n' character.
+
+    std::string::size_type Position = 0;
+    std::string::size_type Terminator;
+
+    Signal.iSignal = 0;
+
+    while (( Terminator = (*Controller).iSignalNames.find( '\n', Position ))
+      != std::string::npos )
+    {
+      std::string Name = (*Controller).iName + ':';
+      Name.append( (*Controller).iSignalNames,
+                   Position,
+                   Terminator - Position );
+
+      iSignalNames.emplace( Name, Signal );
+      Position = Terminator + 1;
+      ++ Signal.iSignal;
+    }
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This method finds a fully-qualified signal name in the symbol *
+//* table.                                                        *
+//*---------------------------------------------------------------*
+//* aName:   Signal name (need not be terminated).                *
+//* aLength: Signal name length.                                  *
+//* aSignal: Reference to receive controller and signal indices.  *
+//* RETURN:  TRUE if the signal was found.                        *
+//*---------------------------------------------------------------*
+
+gboolean CMapControllerList::Find( const gchar* aName,
+                                   gsize aLength,
+                                   CSignalIndex& aSignal )
+{
+  std::unordered_map<std::string, CSignalIndex>::iterator Symbol =
+    iSignalNames.find( std::string( aName, aLength ));
+
+  if ( Symbol == iSignalNames.end() )
+    return FALSE;
+
+  aSignal = Symbol->second;
+  return TRUE;
+}
+
+//*------------------------------------------------------------*
+//* This method returns a controller from its symbol table     *
+//* index.                                                     *
+//*------------------------------------------------------------*
+//* aIndex: Controller index returned by Find().               *
+//* RETURN: Controller iterator.                               *
+//*------------------------------------------------------------*
+
+std::list<CMapController>::iterator CMapControllerList::Controller(
+  guint32 aIndex )
+{
+  return iControllers.at( aIndex );
+}
+
+//*---------------------------------------------------------------*
+//* This method returns the shared record for a connection name,  *
+//* adding it if the name has not been used before.  A record is  *
+//* resolved once using the symbol table, so every connection to  *
+//* the same signal shares its name and controller.               *
+//*---------------------------------------------------------------*
+//* aName:   Connection name (need not be terminated).            *
+//* aLength: Connection name length.                              *
+//* RETURN:  Interned name record, or NULL for an empty name.     *
+//*---------------------------------------------------------------*
+
+const CMapControllerList::CSignalName* CMapControllerList::Intern(
+  const gchar* aName,
+  gsize aLength )
+{
+  if ( aLength == 0 )
+    return NULL;
+
+  // A streamed game map may be written by another thread, which reads
+  // connection names while the game continues.
+
+  std::lock_guard<std::mutex> Lock( iNamesMutex );
+  std::string Key( aName, aLength );
+
+  std::unordered_map<std::string, CSignalName>::iterator Name =
+    iNames.find( Key );
+
+  if ( Name != iNames.end() )
+    return &Name->second;
+
+  CSignalName& Record = iNames[ Key ];
+  Record.iName   = Key;
+  Record.iSignal = G_MAXUINT16;
+
+  // If the signal name could not be found, the signal index will remain
+  // G_MAXUINT16 to indicate an unconnected connection.
+
+  CSignalIndex Signal;
+
+  if ( Find( aName, aLength, Signal ))
+  {
+    Record.iController = iControllers[ Signal.iController ];
+    Record.iSignal     = Signal.iSignal;
+  }
+
+  return &Record;
+}
+
+//*---------------------------------------------------------------*
+//* This method returns the shared record for a connection name   *
+//* whose controller and signal are already known.  An existing   *
+//* record for the name is returned unchanged.                    *
+//*---------------------------------------------------------------*
+//* aController: Controller iterator.                             *
+//* aSignal:     Controller signal index.                         *
+//* aName:       Fully-qualified signal name.                     *
+//* RETURN:      Interned name record.                            *
+//*---------------------------------------------------------------*
+
+const CMapControllerList::CSignalName* CMapControllerList::Intern(
+  std::list<CMapController>::iterator aController,
+  guint16 aSignal,
+  const std::string& aName )
+{
+  std::lock_guard<std::mutex> Lock( iNamesMutex );
+  auto Name = iNames.emplace( aName, CSignalName() );
+
+  if ( Name.second )
+  {
+    Name.first->second.iName       = aName;
+    Name.first->second.iController = aController;
+    Name.first->second.iSignal     = aSignal;
+  }
+
+  return &Name.first->second;
+}
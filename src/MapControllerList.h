@@ -2,7 +2,8 @@
 // Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
 // 
 // This file is the MapControllerList class header.  The MapControllerList
-// class manages a list of MapControllers. 
+// class manages a list of MapControllers.  A symbol table of controller and
+// signal names allows connections to be resolved without searching.
 //
 // This program is free software: you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -20,6 +21,9 @@
 #ifndef __MAPCONTROLLERLIST_H__
 #define __MAPCONTROLLERLIST_H__
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <gtkmm.h>
 #include "MapController.h"
 
@@ -31,14 +35,41 @@ class CMapControllerList : public std::list<CMapController>
     class CSignalIndex
     {
       public:
-        guint16 iController;   // Index to controller.
+        guint32 iController;   // Index to controller.
         guint16 iSignal;       // Index to signal in controller.
     };
 
+    class CSignalName
+    {
+      public:
+        std::string iName;                               // Connection name.
+        std::list<CMapController>::iterator iController; // Controller iterator.
+        guint16 iSignal;                                 // Controller signal.
+    };
+
     CMapControllerList();
+    void Clear();
     void Load();
     void Save();
     void Restart();
+    void Index();
+    gboolean Find( const gchar* aName, gsize aLength, CSignalIndex& aSignal );
+    std::list<CMapController>::iterator Controller( guint32 aIndex );
+    const CSignalName* Intern( const gchar* aName, gsize aLength );
+
+    const CSignalName* Intern( std::list<CMapController>::iterator aController,
+                               guint16 aSignal,
+                               const std::string& aName );
+
+  private:
+    // Private data.
+
+    std::vector<std::list<CMapController>::iterator> iControllers;
+    std::unordered_map<std::string, guint32> iControllerNames;
+    std::unordered_map<std::string, CSignalIndex> iSignalNames;
+    std::unordered_map<std::string, CSignalName> iNames;
+    std::list<std::unordered_map<std::string, CSignalName>> iRetiredNames;
+    std::mutex iNamesMutex;
 };
 
 #endif // __MAPCONTROLLERLIST_H__
@@ -0,0 +1,58 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file contains the main entry point for the game map converter.  The
+// converter loads a game map in either the keyvalue array (.ewc) or indexed
+// (.ewcx) format, and saves it in the format selected by the output
+// filename.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <gtkmm.h>
+#include "Map.h"
+
+int main( int argc, char *argv[] )
+{
+  if ( argc != 3 )
+  {
+    std::cerr << "Usage: " << argv[ 0 ] << " INPUT OUTPUT" << std::endl;
+    std::cerr << "Convert a game map between the .ewc and .ewcx formats."
+              << std::endl;
+    std::cerr << "The output format is selected by the OUTPUT extension."
+              << std::endl;
+    return 2;
+  }
+
+  // Load the game map, which may be in either format.
+
+  std::unique_ptr< CMap > Map( new CMap );
+  Map->LoadFile( argv[ 1 ] );
+
+  if ( !Map->GetLoaded() )
+  {
+    std::cerr << argv[ 1 ] << ": not a valid game map" << std::endl;
+    return 1;
+  }
+
+  // Save the game map in the format chosen by the output filename.
+
+  if ( !Map->SaveFile( argv[ 2 ] ))
+  {
+    std::cerr << argv[ 2 ] << ": could not be written" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file contains the main entry point for the game map generator.  The
+// generator builds a procedural game map with a chosen number of objects,
+// and saves it in the format selected by the output filename.  Generated
+// maps are used for stress testing with very large game maps.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <gtkmm.h>
+#include "MapGenerator.h"
+
+int main( int argc, char *argv[] )
+{
+  // Read the options, followed by the object count and output filename.
+
+  CMapGenerator Generator;
+  gboolean Valid = TRUE;
+  int Argument   = 1;
+
+  while (( Argument + 1 < argc ) && ( argv[ Argument ][ 0 ] == '-' ))
+  {
+    guint Value = (guint)g_ascii_strtoull( argv[ Argument + 1 ], NULL, 10 );
+
+    if ( g_strcmp0( argv[ Argument ], "-d" ) == 0 )
+      Generator.SetDensity( Value );
+    else if ( g_strcmp0( argv[ Argument ], "-p" ) == 0 )
+      Generator.SetPlayers( Value );
+    else if ( g_strcmp0( argv[ Argument ], "-s" ) == 0 )
+      Generator.SetSeed( Value );
+    else
+      Valid = FALSE;
+
+    Argument += 2;
+  }
+
+  guint32 Objects = 0;
+
+  if ( Argument + 2 == argc )
+    Objects = (guint32)g_ascii_strtoull( argv[ Argument ], NULL, 10 );
+
+  if ( !Valid || ( Objects == 0 ))
+  {
+    std::cerr << "Usage: " << argv[ 0 ]
+              << " [-d DENSITY] [-p PLAYERS] [-s SEED] OBJECTS OUTPUT"
+              << std::endl;
+    std::cerr << "Generate a game map with about OBJECTS structural objects."
+              << std::endl;
+    std::cerr << "DENSITY is the percentage of rooms with an item"
+              << " (default 5)." << std::endl;
+    std::cerr << "The output format is selected by the OUTPUT extension."
+              << std::endl;
+    return 2;
+  }
+
+  // Generate the game map, then save it in the chosen format.
+
+  std::unique_ptr< CMap > Map( new CMap );
+
+  Generator.SetObjects( Objects );
+  Generator.Generate( *Map );
+  Map->SetFileName( argv[ Argument + 1 ] );
+
+  if ( !Map->SaveFile( argv[ Argument + 1 ] ))
+  {
+    std::cerr << argv[ Argument + 1 ] << ": could not be written" << std::endl;
+    return 1;
+  }
+
+  std::cout << argv[ Argument + 1 ] << ": "
+            << Map->Objects().size() << " objects, "
+            << Map->Items().size() << " items, "
+            << Map->Teleporters().size() << " teleporters, "
+            << Map->Controllers().size() << " controllers" << std::endl;
+  return 0;
+}
@@ -0,0 +1,647 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file is the MapGenerator class implementation.  The MapGenerator class
+// builds a procedural game map of a chosen size.  Each level of the game map
+// is a maze of rooms with BlockWall sides and StoneWall floors and ceilings,
+// joined by ladders, and scattered with items, teleporters, and doors worked
+// by pad buttons through map controllers.  Every choice is made by hashing a
+// room location, so a room can be built without knowing its neighbours.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include "MapGenerator.h"
+
+//*-------------------------------------*
+//* Local declarations and definitions. *
+//*-------------------------------------*
+
+#define KObjects         1000     // Default number of objects.
+#define KDensity         5        // Default percentage of rooms with an item.
+#define KObjectsPerRoom  3        // Fewest objects expected in a room.
+#define KLevelRatio      4        // Room rows per level of rooms.
+#define KTeleporterRate  400      // Rooms per density step with a teleporter.
+#define KMechanismRate   200      // Rooms per density step with a door.
+#define KLadderRate      50       // Rooms per ladder.
+
+#define KSaltMaze        1        // Hash salts for each random choice.
+#define KSaltItem        2
+#define KSaltKind        3
+#define KSaltTeleporter  4
+#define KSaltArrival     5
+#define KSaltMechanism   6
+#define KSaltLadder      7
+
+#define KPressSignal     0        // Pad button controller signal.
+#define KDoorSignal      1        // Door controller signal.
+
+static const char* KSignalNames = "press\ndoor\n";
+
+// Controller Main bytecode toggling the door each time the pad button is
+// pressed (eg. "press ? { door ! > door }").
+
+static const char KToggleCode[] =
+{
+  (char)EnigmaWC::OpCode::ESignal, KPressSignal,
+  (char)EnigmaWC::OpCode::EConditional,
+  (char)EnigmaWC::OpCode::EJump, 6,
+  (char)EnigmaWC::OpCode::ESignal, KDoorSignal,
+  (char)EnigmaWC::OpCode::ENot,
+  (char)EnigmaWC::OpCode::EStore,
+  (char)EnigmaWC::OpCode::ESignal, KDoorSignal
+};
+
+// Items placed in rooms, with their categories.  Required and optional
+// items are the most common.
+
+class CItemKind
+{
+  public:
+    EnigmaWC::ID iID;               // Item ID.
+    EnigmaWC::Category iCategory;   // Item category.
+};
+
+static const CItemKind KItemKinds[] =
+{
+  { EnigmaWC::ID::EApple,      EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::EBread,      EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::ECheese,     EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::EWineBottle, EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::EGrapes,     EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::EOrange,     EnigmaWC::Category::ERequired },
+  { EnigmaWC::ID::EWineGlass,  EnigmaWC::Category::EOptional },
+  { EnigmaWC::ID::ECake,       EnigmaWC::Category::EOptional },
+  { EnigmaWC::ID::EFork,       EnigmaWC::Category::EOptional },
+  { EnigmaWC::ID::EPlate,      EnigmaWC::Category::EOptional },
+  { EnigmaWC::ID::EEasterEgg,  EnigmaWC::Category::EEasterEgg },
+  { EnigmaWC::ID::ESkull,      EnigmaWC::Category::ESkull }
+};
+
+//*----------------------*
+//* Default constructor. *
+//*----------------------*
+
+CMapGenerator::CMapGenerator()
+{
+  iObjects = KObjects;
+  iDensity = KDensity;
+  iPlayers = 1;
+  iSeed    = 0;
+  iColumns = 0;
+  iRows    = 0;
+  iLevels  = 0;
+  return;
+}
+
+//*----------------------------------------------------------------*
+//* This method sets the number of structural objects to generate. *
+//*----------------------------------------------------------------*
+//* aObjects: Number of objects.                                   *
+//*----------------------------------------------------------------*
+
+void CMapGenerator::SetObjects( guint32 aObjects )
+{
+  iObjects = aObjects;
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This method sets the density of items in the game map.  Doors   *
+//* and teleporters become more common along with items.            *
+//*-----------------------------------------------------------------*
+//* aDensity: Percentage of rooms with an item (0 to 100).          *
+//*-----------------------------------------------------------------*
+
+void CMapGenerator::SetDensity( guint aDensity )
+{
+  iDensity = MIN( aDensity, 100 );
+  return;
+}
+
+//*-------------------------------------------*
+//* This method sets the number of players.   *
+//*-------------------------------------------*
+//* aPlayers: Number of players (at least 1). *
+//*-------------------------------------------*
+
+void CMapGenerator::SetPlayers( guint aPlayers )
+{
+  iPlayers = MAX( aPlayers, 1 );
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This method sets the seed for all random choices.  The same     *
+//* seed and settings always generate the same game map.            *
+//*-----------------------------------------------------------------*
+//* aSeed: Random seed.                                             *
+//*-----------------------------------------------------------------*
+
+void CMapGenerator::SetSeed( guint32 aSeed )
+{
+  iSeed = aSeed;
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This private method returns a random value for a room location. *
+//* Different salts give unrelated values for the same location.    *
+//*-----------------------------------------------------------------*
+//* aLocation: Room location.                                       *
+//* aSalt:     Choice being made for the room.                      *
+//* RETURN:    Random value.                                        *
+//*-----------------------------------------------------------------*
+
+guint32 CMapGenerator::Hash( const CMapLocation& aLocation, guint32 aSalt )
+{
+  // Pack the location and salt, then mix all bits together.
+
+  guint64 Value = ((guint64)aSalt << 48)
+                | ((guint64)aLocation.iAbove << 32)
+                | ((guint64)aLocation.iNorth << 16)
+                | (guint64)aLocation.iEast;
+
+  Value += 0x9E3779B97F4A7C15ULL * ( (guint64)iSeed + 1 );
+  Value  = ( Value ^ ( Value >> 30 )) * 0xBF58476D1CE4E5B9ULL;
+  Value  = ( Value ^ ( Value >> 27 )) * 0x94D049BB133111EBULL;
+  Value ^= ( Value >> 31 );
+
+  return (guint32)Value;
+}
+
+//*------------------------------------------------------------------*
+//* This private method returns TRUE if a room has an East wall.     *
+//* Each level is a binary tree maze, where every room opens either  *
+//* to the North or to the East, except along the far edges.         *
+//*------------------------------------------------------------------*
+//* aLocation: Room location.                                        *
+//* RETURN:    TRUE if there is a wall on the East side of the room. *
+//*------------------------------------------------------------------*
+
+gboolean CMapGenerator::WallEast( const CMapLocation& aLocation )
+{
+  if (( aLocation.iEast + 1 ) >= iColumns )
+    return TRUE;
+
+  if (( aLocation.iNorth + 1 ) >= iRows )
+    return FALSE;
+
+  return (( Hash( aLocation, KSaltMaze ) & 1 ) != 0 );
+}
+
+//*-------------------------------------------------------------------*
+//* This private method returns TRUE if a room has a North wall.      *
+//*-------------------------------------------------------------------*
+//* aLocation: Room location.                                         *
+//* RETURN:    TRUE if there is a wall on the North side of the room. *
+//*-------------------------------------------------------------------*
+
+gboolean CMapGenerator::WallNorth( const CMapLocation& aLocation )
+{
+  if (( aLocation.iNorth + 1 ) >= iRows )
+    return TRUE;
+
+  if (( aLocation.iEast + 1 ) >= iColumns )
+    return FALSE;
+
+  return (( Hash( aLocation, KSaltMaze ) & 1 ) == 0 );
+}
+
+//*--------------------------------------------------------------*
+//* This private method returns TRUE if the East wall of a room  *
+//* is a door, opened and closed by a pad button in the room.    *
+//*--------------------------------------------------------------*
+//* aLocation: Room location.                                    *
+//* RETURN:    TRUE if the room has a door mechanism.            *
+//*--------------------------------------------------------------*
+
+gboolean CMapGenerator::Mechanism( const CMapLocation& aLocation )
+{
+  return ((( aLocation.iEast + 1 ) < iColumns )
+       && WallEast( aLocation )
+       && (( Hash( aLocation, KSaltMechanism ) % KMechanismRate )
+            < iDensity ));
+}
+
+//*-------------------------------------------------------------*
+//* This private method returns TRUE if a ladder on the North   *
+//* wall of a room leads up to the room above.                  *
+//*-------------------------------------------------------------*
+//* aLocation: Room location.                                   *
+//* RETURN:    TRUE if the room has a ladder.                   *
+//*-------------------------------------------------------------*
+
+gboolean CMapGenerator::Ladder( const CMapLocation& aLocation )
+{
+  return ((( aLocation.iAbove + 1 ) < iLevels )
+       && WallNorth( aLocation )
+       && (( Hash( aLocation, KSaltLadder ) % KLadderRate ) == 0 ));
+}
+
+//*-----------------------------------------------------------*
+//* This private method adds a structural object to the map.  *
+//*-----------------------------------------------------------*
+//* aMap:      Game map.                                      *
+//* aID:       Object ID.                                     *
+//* aSurface:  Object surface.                                *
+//* aLocation: Object location.                               *
+//*-----------------------------------------------------------*
+
+void CMapGenerator::AddObject( CMap& aMap,
+                               EnigmaWC::ID aID,
+                               EnigmaWC::Direction aSurface,
+                               const CMapLocation& aLocation )
+{
+  CMapObject Object;
+
+  BuildObject( Object, aID, aSurface, aLocation );
+  aMap.Objects().push_back( Object );
+  return;
+}
+
+//*------------------------------------------------------------*
+//* This private method sets up a structural object, which may *
+//* then be connected before it is added to the map.           *
+//*------------------------------------------------------------*
+//* aObject:   Object to be set up.                            *
+//* aID:       Object ID.                                      *
+//* aSurface:  Object surface.                                 *
+//* aLocation: Object location.                                *
+//*------------------------------------------------------------*
+
+void CMapGenerator::BuildObject( CMapObject& aObject,
+                                 EnigmaWC::ID aID,
+                                 EnigmaWC::Direction aSurface,
+                                 const CMapLocation& aLocation )
+{
+  aObject.iID       = aID;
+  aObject.iSurface  = aSurface;
+  aObject.iLocation = aLocation;
+
+  // Objects on a floor or ceiling face North, while those on a wall
+  // face upwards.
+
+  if (( aSurface == EnigmaWC::Direction::EAbove )
+    || ( aSurface == EnigmaWC::Direction::EBelow ))
+  {
+    aObject.iRotation = EnigmaWC::Direction::ENorth;
+  }
+  else
+    aObject.iRotation = EnigmaWC::Direction::EAbove;
+
+  // Set the same unconnected states as when reading a game map file.
+
+  aObject.iSense.SetState( FALSE );
+  aObject.iState.SetState( TRUE );
+  aObject.iVisibility.SetState( TRUE );
+  aObject.iPresence.SetState( TRUE );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This private method adds all objects in one room.           *
+//*-------------------------------------------------------------*
+//* aMap:      Game map.                                        *
+//* aLocation: Room location.                                   *
+//* aRoom:     Number of rooms already added before this room.  *
+//*-------------------------------------------------------------*
+
+void CMapGenerator::AddRoom( CMap& aMap,
+                             const CMapLocation& aLocation,
+                             guint32 aRoom )
+{
+  CMapLocation Location;
+
+  // Add a floor, unless a ladder arrives from the room below.
+
+  Location = aLocation;
+  -- Location.iAbove;
+
+  if (( aLocation.iAbove > 0 ) && Ladder( Location ))
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::ELadderTop,
+               EnigmaWC::Direction::ENorth,
+               aLocation );
+  }
+  else
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::EStoneWall,
+               EnigmaWC::Direction::EBelow,
+               aLocation );
+  }
+
+  // Add a ceiling, unless a ladder leaves for the room above.
+
+  if ( Ladder( aLocation ))
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::ELadder,
+               EnigmaWC::Direction::ENorth,
+               aLocation );
+  }
+  else
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::EStoneWall,
+               EnigmaWC::Direction::EAbove,
+               aLocation );
+  }
+
+  // Add the West wall, which is the East wall of the room to the West.
+  // If that room has a door mechanism, this side of its door is connected
+  // to the last map controller added.
+
+  Location = aLocation;
+  -- Location.iEast;
+
+  if (( aLocation.iEast == 0 ) || WallEast( Location ))
+  {
+    if (( aLocation.iEast > 0 ) && Mechanism( Location ))
+    {
+      CMapObject Door;
+
+      BuildObject( Door,
+                   EnigmaWC::ID::EWoodDoor,
+                   EnigmaWC::Direction::EWest,
+                   aLocation );
+
+      std::list<CMapController>::iterator Controller =
+        std::prev( aMap.Controllers().end() );
+
+      Door.iState.Connect(
+        aMap.Controllers().Intern( Controller,
+                                   KDoorSignal,
+                                   (*Controller).iName + ":door" ));
+
+      aMap.Objects().push_back( Door );
+    }
+    else
+    {
+      AddObject( aMap,
+                 EnigmaWC::ID::EBlockWall,
+                 EnigmaWC::Direction::EWest,
+                 aLocation );
+    }
+  }
+
+  // Add the South wall, which is the North wall of the room to the South.
+
+  Location = aLocation;
+  -- Location.iNorth;
+
+  if (( aLocation.iNorth == 0 ) || WallNorth( Location ))
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::EBlockWall,
+               EnigmaWC::Direction::ESouth,
+               aLocation );
+  }
+
+  // Add the North wall.
+
+  if ( WallNorth( aLocation ))
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::EBlockWall,
+               EnigmaWC::Direction::ENorth,
+               aLocation );
+  }
+
+  // Add the East wall.  A door mechanism has a new map controller that
+  // toggles the door each time the pad button on the floor is pressed.
+
+  if ( Mechanism( aLocation ))
+  {
+    aMap.Controllers().emplace_back();
+
+    std::list<CMapController>::iterator Controller =
+      std::prev( aMap.Controllers().end() );
+
+    (*Controller).iName        = std::to_string( aMap.Controllers().size() - 1 );
+    (*Controller).iSignalNames = KSignalNames;
+    (*Controller).iMainCode.assign( KToggleCode, sizeof( KToggleCode ));
+    (*Controller).Initialize();
+
+    CMapObject Door;
+
+    BuildObject( Door,
+                 EnigmaWC::ID::EWoodDoor,
+                 EnigmaWC::Direction::EEast,
+                 aLocation );
+
+    Door.iState.Connect(
+      aMap.Controllers().Intern( Controller,
+                                 KDoorSignal,
+                                 (*Controller).iName + ":door" ));
+
+    aMap.Objects().push_back( Door );
+
+    CMapObject Button;
+
+    BuildObject( Button,
+                 EnigmaWC::ID::EPadButton,
+                 EnigmaWC::Direction::EBelow,
+                 aLocation );
+
+    Button.iSense.Connect(
+      aMap.Controllers().Intern( Controller,
+                                 KPressSignal,
+                                 (*Controller).iName + ":press" ));
+
+    aMap.Objects().push_back( Button );
+  }
+  else if ( WallEast( aLocation ))
+  {
+    AddObject( aMap,
+               EnigmaWC::ID::EBlockWall,
+               EnigmaWC::Direction::EEast,
+               aLocation );
+  }
+
+  // Add an item on the floor.
+
+  guint32 Random = Hash( aLocation, KSaltItem );
+
+  if (( Random % 100 ) < iDensity )
+  {
+    const CItemKind& Kind =
+      KItemKinds[ Hash( aLocation, KSaltKind ) % G_N_ELEMENTS( KItemKinds ) ];
+
+    aMap.Items().emplace_back();
+    CMapItem& Item = aMap.Items().back();
+
+    Item.iID       = Kind.iID;
+    Item.iCategory = Kind.iCategory;
+    Item.iSurface  = EnigmaWC::Direction::EBelow;
+    Item.iRotation = EnigmaWC::Direction::ENorth;
+    Item.iLocation = aLocation;
+
+    Item.iSense.SetState( FALSE );
+    Item.iState.SetState( TRUE );
+    Item.iVisibility.SetState( TRUE );
+    Item.iPresence.SetState( TRUE );
+
+    Item.iActiveRestart   = TRUE;
+    Item.iSelectedRestart = FALSE;
+    Item.iUsedRestart     = FALSE;
+    Item.iOwnerRestart    = 0;
+  }
+
+  // Add a teleporter on the floor, arriving in a room already added.
+
+  Random = Hash( aLocation, KSaltTeleporter );
+
+  if (( Random % KTeleporterRate ) < iDensity )
+  {
+    guint32 Arrival = Hash( aLocation, KSaltArrival ) % ( aRoom + 1 );
+
+    aMap.Teleporters().emplace_back();
+    CMapTeleporter& Teleporter = aMap.Teleporters().back();
+
+    Teleporter.iID       = EnigmaWC::ID::ETeleporter;
+    Teleporter.iSurface  = EnigmaWC::Direction::EBelow;
+    Teleporter.iRotation = EnigmaWC::Direction::ENorth;
+    Teleporter.iLocation = aLocation;
+
+    Teleporter.iSense.SetState( FALSE );
+    Teleporter.iState.SetState( TRUE );
+    Teleporter.iVisibility.SetState( TRUE );
+    Teleporter.iPresence.SetState( TRUE );
+
+    Teleporter.iSurfaceArrival  = EnigmaWC::Direction::EBelow;
+    Teleporter.iRotationArrival = EnigmaWC::Direction::ENorth;
+
+    Teleporter.iLocationArrival.iEast  = Arrival % iColumns;
+    Teleporter.iLocationArrival.iNorth = ( Arrival / iColumns ) % iRows;
+    Teleporter.iLocationArrival.iAbove = Arrival / iColumns / iRows;
+  }
+
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This method generates a new game map.  The map is filled room by *
+//* room in location order until the number of objects is reached,   *
+//* so the last level may be only partly built.  The game map is     *
+//* not loaded from a file, so it must be given a filename with      *
+//* CMap::SetFileName() before it can be saved.                      *
+//*------------------------------------------------------------------*
+//* aMap: Game map to be filled.                                     *
+//*------------------------------------------------------------------*
+
+void CMapGenerator::Generate( CMap& aMap )
+{
+  aMap.Clear();
+
+  // Choose the number of levels and the size of each level.  A level
+  // is square, and the number of levels grows more slowly than the
+  // level size.
+
+  guint64 Rooms = ( iObjects / KObjectsPerRoom ) + 1;
+  double Levels = std::cbrt( (double)Rooms ) / KLevelRatio;
+
+  iLevels = (guint16)CLAMP( Levels, 1.0, (double)G_MAXUINT16 );
+
+  double Side = std::ceil( std::sqrt( (double)Rooms / iLevels ));
+
+  iColumns = (guint16)CLAMP( Side, (double)MAX( iPlayers, 2 ),
+                                   (double)G_MAXUINT16 );
+  iRows    = iColumns;
+
+  // Add rooms in location order.
+
+  CMapLocation Location;
+  guint32 Room = 0;
+
+  for ( Location.iAbove = 0;
+        ( Location.iAbove < iLevels ) && ( aMap.Objects().size() < iObjects );
+        ++ Location.iAbove )
+  {
+    for ( Location.iNorth = 0;
+          ( Location.iNorth < iRows ) && ( aMap.Objects().size() < iObjects );
+          ++ Location.iNorth )
+    {
+      for ( Location.iEast = 0;
+            ( Location.iEast < iColumns )
+              && ( aMap.Objects().size() < iObjects );
+            ++ Location.iEast )
+      {
+        AddRoom( aMap, Location, Room );
+        ++ Room;
+      }
+    }
+  }
+
+  // Add the players along the first row, with the first player active.
+
+  for ( guint Number = 0; Number < iPlayers; ++ Number )
+  {
+    aMap.Players().emplace_back();
+    CMapPlayer& Player = aMap.Players().back();
+
+    Player.iID       = EnigmaWC::ID::EPlayer;
+    Player.iNumber   = Number;
+    Player.iSurface  = EnigmaWC::Direction::EBelow;
+    Player.iRotation = EnigmaWC::Direction::ENorth;
+    Player.iLocation = CMapLocation( Number, 0, 0 );
+
+    Player.iSense.SetState( FALSE );
+    Player.iState.SetState( TRUE );
+    Player.iVisibility.SetState( TRUE );
+    Player.iPresence.SetState( TRUE );
+
+    Player.iWaterLayer       = FALSE;
+    Player.iWater            = FALSE;
+    Player.iInnerTube        = FALSE;
+    Player.iHydrogenBalloon  = FALSE;
+    Player.iStairsSurface    = EnigmaWC::Direction::ENone;
+    Player.iStairsRotation   = EnigmaWC::Direction::ENone;
+    Player.iOffset.Clear();
+
+    Player.iSurfaceRestart  = Player.iSurface;
+    Player.iRotationRestart = Player.iRotation;
+    Player.iLocationRestart = Player.iLocation;
+    Player.iActiveRestart   = ( Number == 0 );
+    Player.iOutdoorRestart  = FALSE;
+
+    Player.iSurfaceNext        = EnigmaWC::Direction::ENone;
+    Player.iRotationNext       = EnigmaWC::Direction::ENone;
+    Player.iStairsSurfaceNext  = EnigmaWC::Direction::ENone;
+    Player.iStairsRotationNext = EnigmaWC::Direction::ENone;
+    Player.iLocationNext.Clear();
+    Player.iOutdoorNext        = FALSE;
+
+    Player.iContactBits     = 0;
+    Player.iAntiContactBits = 0;
+  }
+
+  aMap.Description() =
+    Glib::ustring::compose( "Generated game map with %1 objects in %2 rooms.",
+                            aMap.Objects().size(),
+                            Room );
+
+  // Index the structural objects by location.  Place all players, items,
+  // and controllers in their restart state, and copy that state to the
+  // saved state.
+
+  aMap.Objects().Index();
+  aMap.Restart();
+  aMap.Players().Save();
+  aMap.Items().Save();
+  aMap.Controllers().Save();
+  return;
+}
@@ -0,0 +1,70 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file is the MapGenerator class header.  The MapGenerator class builds
+// a procedural game map of a chosen size, used for stress testing the game
+// map code with maps much larger than those shipped with the game.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __MAPGENERATOR_H__
+#define __MAPGENERATOR_H__
+
+#include <gtkmm.h>
+#include "Map.h"
+
+class CMapGenerator
+{
+  public:
+    // Public methods.
+
+    CMapGenerator();
+    void SetObjects( guint32 aObjects );
+    void SetDensity( guint aDensity );
+    void SetPlayers( guint aPlayers );
+    void SetSeed( guint32 aSeed );
+    void Generate( CMap& aMap );
+
+  private:
+    // Private methods.
+
+    guint32 Hash( const CMapLocation& aLocation, guint32 aSalt );
+    gboolean WallEast( const CMapLocation& aLocation );
+    gboolean WallNorth( const CMapLocation& aLocation );
+    gboolean Mechanism( const CMapLocation& aLocation );
+    gboolean Ladder( const CMapLocation& aLocation );
+    void AddRoom( CMap& aMap, const CMapLocation& aLocation, guint32 aRoom );
+
+    void AddObject( CMap& aMap,
+                    EnigmaWC::ID aID,
+                    EnigmaWC::Direction aSurface,
+                    const CMapLocation& aLocation );
+
+    void BuildObject( CMapObject& aObject,
+                      EnigmaWC::ID aID,
+                      EnigmaWC::Direction aSurface,
+                      const CMapLocation& aLocation );
+
+    // Private data.
+
+    guint32 iObjects;                 // Number of objects to generate.
+    guint iDensity;                   // Percentage of rooms with an item.
+    guint iPlayers;                   // Number of players.
+    guint32 iSeed;                    // Seed for all random choices.
+    guint16 iColumns;                 // Rooms in each row.
+    guint16 iRows;                    // Rows of rooms on each level.
+    guint16 iLevels;                  // Levels of rooms.
+};
+
+#endif // __MAPGENERATOR_H__
@@ -34,6 +34,8 @@ class CMapItem : public CMapObject
     gboolean iSelected;            // TRUE if item has been selected.
     gboolean iUsed;                // TRUE if item has been used.
     guint8 iOwner;                 // Player number owning item.
+    gboolean iChanged;             // TRUE if changed since last saved.
+    guint32 iNumber;               // Position of item in item list.
     
     // Saved values.
     
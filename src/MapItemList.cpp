@@ -17,6 +17,7 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include "MapItemList.h"
 
 //*----------------------*
@@ -25,7 +26,11 @@
 
 CMapItemList::CMapItemList()
 {	
-  iItemDialog = std::unique_ptr<CItemDialog>( new CItemDialog );
+  // The item dialog is not created until a parent window is set.  This
+  // allows game maps to be loaded by programs without a GTK display.
+  // The empty indexes have no items remaining.
+
+  Index();
 	return;
 }
 
@@ -35,13 +40,17 @@ CMapItemList::CMapItemList()
 
 void CMapItemList::Clear()
 {
-  // Clear the base class list.
+  // Clear the base class list, then build the empty indexes.  This also
+  // discards iterators to the cleared items, and the remaining counts of
+  // an earlier game map.
 	
   clear();
+  Index();
 	
 	// Hide the item dialog in case is it showing.
 	
-  iItemDialog->hide();	
+  if ( iItemDialog )
+    iItemDialog->hide();	
 	return;
 }
 
@@ -53,6 +62,9 @@ void CMapItemList::Clear()
 
 void CMapItemList::SetParentWindow( Gtk::Window& aParent )
 {	
+  if ( !iItemDialog )
+    iItemDialog = std::unique_ptr<CItemDialog>( new CItemDialog );
+
   iItemDialog->set_transient_for( aParent );
 	return;
 }
@@ -71,11 +83,17 @@ void CMapItemList::Load()
     (*Item).iSelected = (*Item).iSelectedSaved;
     (*Item).iUsed     = (*Item).iUsedSaved;
     (*Item).iOwner    = (*Item).iOwnerSaved;
+    (*Item).iChanged  = TRUE;
   }
+
+  // Item owners have changed, so index the items again.
+
+  Index();
 	
   // Hide the item dialog in case is it showing.
 	
-  iItemDialog->hide();
+  if ( iItemDialog )
+    iItemDialog->hide();
 	return;
 }
 
@@ -93,6 +111,7 @@ void CMapItemList::Save()
     (*Item).iSelectedSaved = (*Item).iSelected;
     (*Item).iUsedSaved     = (*Item).iUsed;
     (*Item).iOwnerSaved    = (*Item).iOwner;
+    (*Item).iChanged       = TRUE;
   }
   
   return;
@@ -112,11 +131,17 @@ void CMapItemList::Restart()
     (*Item).iSelected = (*Item).iSelectedRestart;
     (*Item).iUsed     = (*Item).iUsedRestart;
     (*Item).iOwner    = (*Item).iOwnerRestart;
+    (*Item).iChanged  = TRUE;
   }
+
+  // Item owners have changed, so index the items again.
+
+  Index();
 	
   // Hide the item dialog in case is it showing.
 	
-  iItemDialog->hide();
+  if ( iItemDialog )
+    iItemDialog->hide();
   return;
 }
 
@@ -134,21 +159,22 @@ void CMapItemList::GetRemaining( guint& aRequired,
 		        						         guint& aEasterEgg,
                                  guint& aSkull )
 {
-	// Clear all remaining counts.
-	
-	aRequired  = 0;
-	aOptional  = 0;
-	aEasterEgg = 0;
-  aSkull     = 0;
+  CheckIndex();
 
-	// Examine all items in the list.
+	// Begin with the counts of items that are always present and have not
+	// yet been found.
 	
-	std::list<CMapItem>::iterator Item;
+	aRequired  = iRemaining[ (int)EnigmaWC::Category::ERequired ];
+	aOptional  = iRemaining[ (int)EnigmaWC::Category::EOptional ];
+	aEasterEgg = iRemaining[ (int)EnigmaWC::Category::EEasterEgg ];
+  aSkull     = iRemaining[ (int)EnigmaWC::Category::ESkull ];
+
+	// The presence of the remaining items not yet found is switched by map
+	// controllers, so it must be examined now.
 
-	for ( Item = begin(); Item != end(); ++ Item )
+	for ( std::list<CMapItem>::iterator& Item : iSwitched )
 	{
-		if ( (*Item).iPresence.GetState()
-		  && (*Item).iActive )
+		if ( (*Item).iPresence.GetState() )
 		{
 			// The item is present and has not yet been found.  Increment 
 			// the appropriate remaining count.
@@ -190,17 +216,188 @@ void CMapItemList::GetRemaining( guint& aRequired,
 void CMapItemList::Read( const CMapLocation& aLocation,
                          std::list<std::list<CMapItem>::iterator>& aBuffer )
 {
+  // Items never change location.
+
+  CheckIndex();
+
+  // Add copies of the item list iterators in the location to the provided
+  // buffer.
+
+  std::unordered_map<guint64,
+    std::vector<std::list<CMapItem>::iterator>>::iterator Items;
+
+  Items = iLocations.find( aLocation.GetKey() );
+
+  if ( Items != iLocations.end() )
+    aBuffer.insert( aBuffer.end(), Items->second.begin(), Items->second.end() );
+  
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private function returns the index key for items with an *
+//* ID owned by a player.                                         *
+//*---------------------------------------------------------------*
+//* aOwner: Player number of owner.                               *
+//* aID:    ID of item.                                           *
+//* RETURN: Index key.                                            *
+//*---------------------------------------------------------------*
+
+guint OwnedKey( guint aOwner, EnigmaWC::ID aID )
+{
+  return ( aOwner << 8 ) | (guint)aID;
+}
+
+//*---------------------------------------------------------------*
+//* This method builds the indexes of items in each map location, *
+//* and of found items belonging to each owner, and counts the    *
+//* items not yet found.  Indexed items keep their list order.    *
+//* It must be called after the found state or owner of items are *
+//* changed directly.                                             *
+//*---------------------------------------------------------------*
+
+void CMapItemList::Index()
+{
+  iLocations.clear();
+  iOwned.clear();
+  iOwnedIDs.clear();
+  iSwitched.clear();
+
+  for ( guint& Remaining : iRemaining )
+    Remaining = 0;
+
   std::list<CMapItem>::iterator Item;
+  guint32 Number = 0;
 
   for ( Item = begin(); Item != end(); ++ Item )
   {
-    // If the item location is correct, add a copy of the item list iterator
-    // to the provided buffer. 
-    
-    if ( (*Item).iLocation == aLocation )
-      aBuffer.push_back( Item );
+    (*Item).iNumber = Number ++;
+    iLocations[ (*Item).iLocation.GetKey() ].push_back( Item );
+
+    if ( !(*Item).iActive )
+    {
+      iOwned[ (*Item).iOwner ].push_back( Item );
+      iOwnedIDs[ OwnedKey( (*Item).iOwner, (*Item).iID ) ].push_back( Item );
+    }
+    else
+      Count( Item, 1 );
   }
-  
+
+  iIndexed = size();
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method builds the indexes if items have been     *
+//* added to the list.  Items are only added while a game map is  *
+//* being read.                                                   *
+//*---------------------------------------------------------------*
+
+void CMapItemList::CheckIndex()
+{
+  if ( iIndexed != size() )
+    Index();
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private function adds an item to an index entry, keeping *
+//* the item list order.                                          *
+//*---------------------------------------------------------------*
+//* aItems: Index entry.                                          *
+//* aItem:  Iterator to MapItem.                                  *
+//*---------------------------------------------------------------*
+
+void InsertItem( std::vector<std::list<CMapItem>::iterator>& aItems,
+                 std::list<CMapItem>::iterator aItem )
+{
+  std::vector<std::list<CMapItem>::iterator>::iterator Position;
+
+  Position = std::upper_bound( aItems.begin(),
+                               aItems.end(),
+                               aItem,
+                               []( std::list<CMapItem>::iterator aFirst,
+                                   std::list<CMapItem>::iterator aSecond )
+                               { return (*aFirst).iNumber
+                                        < (*aSecond).iNumber; } );
+
+  aItems.insert( Position, aItem );
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private function removes an item from an index entry.    *
+//*---------------------------------------------------------------*
+//* aItems: Index entry.                                          *
+//* aItem:  Iterator to MapItem.                                  *
+//*---------------------------------------------------------------*
+
+void RemoveItem( std::vector<std::list<CMapItem>::iterator>& aItems,
+                 std::list<CMapItem>::iterator aItem )
+{
+  std::vector<std::list<CMapItem>::iterator>::iterator Position;
+
+  Position = std::find( aItems.begin(), aItems.end(), aItem );
+
+  if ( Position != aItems.end() )
+    aItems.erase( Position );
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method adds or removes an item not yet found in  *
+//* the remaining item counts.  An item with a presence switched  *
+//* by a map controller is kept aside, to be examined whenever    *
+//* the counts are read.                                          *
+//*---------------------------------------------------------------*
+//* aItem:   Iterator to MapItem.                                 *
+//* aChange: 1 to add the item, or -1 to remove it.               *
+//*---------------------------------------------------------------*
+
+void CMapItemList::Count( std::list<CMapItem>::iterator aItem, gint aChange )
+{
+  if ( (*aItem).iPresence.Connected() )
+  {
+    if ( aChange > 0 )
+      iSwitched.push_back( aItem );
+    else
+      RemoveItem( iSwitched, aItem );
+  }
+  else if ( (*aItem).iPresence.GetState()
+         && ( (*aItem).iCategory < EnigmaWC::Category::TOTAL ))
+  {
+    iRemaining[ (int)(*aItem).iCategory ] += aChange;
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method adds a found item to the owner indexes.   *
+//*---------------------------------------------------------------*
+//* aItem: Iterator to MapItem.                                   *
+//*---------------------------------------------------------------*
+
+void CMapItemList::Own( std::list<CMapItem>::iterator aItem )
+{
+  InsertItem( iOwned[ (*aItem).iOwner ], aItem );
+  InsertItem( iOwnedIDs[ OwnedKey( (*aItem).iOwner, (*aItem).iID ) ], aItem );
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method removes a found item from the owner       *
+//* indexes.                                                      *
+//*---------------------------------------------------------------*
+//* aItem: Iterator to MapItem.                                   *
+//*---------------------------------------------------------------*
+
+void CMapItemList::Disown( std::list<CMapItem>::iterator aItem )
+{
+  RemoveItem( iOwned[ (*aItem).iOwner ], aItem );
+  RemoveItem( iOwnedIDs[ OwnedKey( (*aItem).iOwner, (*aItem).iID ) ], aItem );
   return;
 }
 
@@ -214,19 +411,18 @@ void CMapItemList::Read( const CMapLocation& aLocation,
 void CMapItemList::Read( guint aOwner,
                          std::list<std::list<CMapItem>::iterator>& aBuffer )
 {
-  std::list<CMapItem>::iterator Item;
+  CheckIndex();
 
-  for ( Item = begin(); Item != end(); ++ Item )
-  {
-    // If the item has been found by the owner, add a copy of the item/
-    // list iterator to the provided buffer. 
-    
-    if ( !(*Item).iActive
-      && (*Item).iOwner == aOwner )
-    {
-      aBuffer.push_back( Item );
-    }
-  }
+  // Add copies of the list iterators of items found by the owner to the
+  // provided buffer.
+
+  std::unordered_map<guint,
+    std::vector<std::list<CMapItem>::iterator>>::iterator Items;
+
+  Items = iOwned.find( aOwner );
+
+  if ( Items != iOwned.end() )
+    aBuffer.insert( aBuffer.end(), Items->second.begin(), Items->second.end() );
   
   return;
 }
@@ -259,46 +455,39 @@ void CMapItemList::SetFound( std::list<CMapItem>::iterator& aItem,
   if ( !(*aItem).iActive )
     return;
 
+  // Indicate if the item just found is similar to one already owned.
+
+  CheckIndex();
+
+  gboolean Another = FALSE;
+  std::vector<std::list<CMapItem>::iterator>& Similar =
+    iOwnedIDs[ OwnedKey( aOwner, (*aItem).iID ) ];
+
+  for ( std::list<CMapItem>::iterator& Item : Similar )
+  {
+    if ( (*Item).iPresence.GetState() )
+      Another = TRUE;
+  }
+
   // Mark the item has having been found by the provided owner.
   
-  (*aItem).iActive = FALSE;
-  (*aItem).iOwner  = aOwner;
+  Count( aItem, -1 );
+  (*aItem).iActive  = FALSE;
+  (*aItem).iOwner   = aOwner;
+  (*aItem).iChanged = TRUE;
+  Own( aItem );
 
-  // Examine the item list to determine its new overall state. Begin
-  // by assuming all required and optional items have been found.
+  // Determine the new overall state from the items remaining.
 
-  gboolean AllOptional = TRUE;
-  gboolean AllRequired = TRUE;
-  gboolean Another     = FALSE;
+  guint Required;
+  guint Optional;
+  guint EasterEgg;
+  guint Skull;
 
-  std::list<CMapItem>::iterator Item;
+  GetRemaining( Required, Optional, EasterEgg, Skull );
 
-	for ( Item = begin(); Item != end(); ++ Item )
-	{ 
-		if ( (*Item).iPresence.GetState() )
-		{
-		  if ( (*Item).iActive )
-      {
-        // The item in the list is present but has not yet been found,
-        // so adjust the inventory state accordingly.
-
-        if ( (*Item).iCategory == EnigmaWC::Category::ERequired )
-          AllRequired = FALSE;
-        else if ( (*Item).iCategory == EnigmaWC::Category::EOptional )
-          AllOptional = FALSE;
-      }
-
-      // Indicate if the item just found is similar to one already owned.
-
-      if (( (*aItem).iID == (*Item).iID )
-        && !(*Item).iActive
-        && ( (*Item).iOwner == aOwner )
-        && ( aItem != Item ))
-      {
-        Another = TRUE;
-      }
-    }
-  }
+  gboolean AllOptional = ( Optional == 0 );
+  gboolean AllRequired = ( Required == 0 );
 	
   // Choose an appropriate additional comment (e.g. "This is a secret bonus
   // item!") based on the item found.
@@ -326,7 +515,32 @@ void CMapItemList::SetFound( std::list<CMapItem>::iterator& aItem,
 
   // Display a dialog to describe the item just found.
 		
-  iItemDialog->Show( (*aItem).iID, Another, CommentID );
+  if ( iItemDialog )
+    iItemDialog->Show( (*aItem).iID, Another, CommentID );
+  return;
+}
+
+//*------------------------------------------------------*
+//* This method gives a found item to another player.    *
+//*------------------------------------------------------*
+//* aItem:  Iterator to MapItem.                         *
+//* aOwner: Player number of new owner.                  *
+//*------------------------------------------------------*
+
+void CMapItemList::SetOwner( std::list<CMapItem>::iterator& aItem,
+                             guint8 aOwner )
+{
+  CheckIndex();
+
+  if ( !(*aItem).iActive )
+    Disown( aItem );
+
+  (*aItem).iOwner   = aOwner;
+  (*aItem).iChanged = TRUE;
+
+  if ( !(*aItem).iActive )
+    Own( aItem );
+
   return;
 }
 
@@ -339,17 +553,14 @@ void CMapItemList::SetFound( std::list<CMapItem>::iterator& aItem,
 
 void CMapItemList::ClearSelected( guint8 aOwner )
 {
-  std::list<CMapItem>::iterator Item;
+  CheckIndex();
 
-  for ( Item = begin(); Item != end(); ++ Item )
+  // Clear the Selected state of all items found by the player.
+
+  for ( std::list<CMapItem>::iterator& Item : iOwned[ aOwner ] )
   {
-    if ( !(*Item).iActive
-      && ((*Item).iOwner == aOwner ))
-    {
-      // Clear the Selected state of an item found by the player.
-      
-      (*Item).iSelected = FALSE;
-    }
+    (*Item).iSelected = FALSE;
+    (*Item).iChanged  = TRUE;
   }
   
   return;
@@ -370,20 +581,18 @@ gboolean CMapItemList::SetSelected( EnigmaWC::ID aID,
                                     guint8 aOwner,
                                     gboolean aSelected )
 {
+  CheckIndex();
+
   gboolean Owned = FALSE;
-  std::list<CMapItem>::iterator Item;
 
-  for ( Item = begin(); Item != end(); ++ Item )
+  for ( std::list<CMapItem>::iterator& Item :
+          iOwnedIDs[ OwnedKey( aOwner, aID ) ] )
   {
-    if ( ((*Item).iID == aID )
-      && !(*Item).iActive
-      && ((*Item).iOwner == aOwner ))
-    { 
-      // Set the Selected state of an item found by the player.
-
-      (*Item).iSelected = aSelected;
-      Owned = TRUE;
-    }
+    // Set the Selected state of an item found by the player.
+
+    (*Item).iSelected = aSelected;
+    (*Item).iChanged  = TRUE;
+    Owned = TRUE;
   }
   
   return Owned;
@@ -402,23 +611,21 @@ gboolean CMapItemList::SetSelected( EnigmaWC::ID aID,
 gboolean CMapItemList::GetSelected( EnigmaWC::ID iID,
                                     guint8 aOwner )
 {
-  std::list<CMapItem>::iterator Item;
+  CheckIndex();
 
-  for ( Item = begin(); Item != end(); ++ Item )
-  {
-    if (((*Item).iID == iID )
-      && !(*Item).iActive     
-      && ((*Item).iOwner == aOwner ))
-    {
-      // Return the Selected state of the item found by the player.
-    
-      return (*Item).iSelected;
-    }
-  }
+  std::unordered_map<guint,
+    std::vector<std::list<CMapItem>::iterator>>::iterator Items;
 
-  // Return FALSE since the player does not own the item.
-  
-  return FALSE;
+  Items = iOwnedIDs.find( OwnedKey( aOwner, iID ));
+
+  // Return FALSE if the player does not own the item.
+
+  if (( Items == iOwnedIDs.end() ) || Items->second.empty() )
+    return FALSE;
+
+  // Return the Selected state of the first item found by the player.
+    
+  return (*( Items->second.front() )).iSelected;
 }
 
 //*-----------------------------------------------------------*
@@ -429,7 +636,7 @@ gboolean CMapItemList::GetSelected( EnigmaWC::ID iID,
 //* RETURN: TRUE if Object's key was used, or none is needed. *
 //*-----------------------------------------------------------*
 
-gboolean CMapItemList::UseKey( std::list<CMapObject>::iterator& aObject,
+gboolean CMapItemList::UseKey( CMapObjectList::iterator& aObject,
                                guint8 aOwner )
 {
   // Select ID of the key required for the object.
@@ -478,18 +685,18 @@ gboolean CMapItemList::UseKey( std::list<CMapObject>::iterator& aObject,
   // Set all similar key items owned by the player to the Used state if any
   // are present and selected (or have already been used). 
 
+  CheckIndex();
+
   gboolean Used = FALSE;
-  std::list<CMapItem>::iterator Item;
   
-  for ( Item = begin(); Item != end(); ++ Item )
+  for ( std::list<CMapItem>::iterator& Item :
+          iOwnedIDs[ OwnedKey( aOwner, KeyID ) ] )
   {
-    if ( ((*Item).iID == KeyID )
-      && !(*Item).iActive
-      && ((*Item).iOwner == aOwner )
-      && ((*Item).iSelected || (*Item).iUsed ))
+    if ( (*Item).iSelected || (*Item).iUsed )
     {
       Used = TRUE;
-      (*Item).iUsed = Used;
+      (*Item).iUsed    = Used;
+      (*Item).iChanged = TRUE;
     } 
   }
   
@@ -20,8 +20,11 @@
 #ifndef __MAPITEMLIST_H__
 #define __MAPITEMLIST_H__
 
+#include <unordered_map>
+#include <vector>
 #include <gtkmm.h>
 #include "MapItem.h"
+#include "MapObjectList.h"
 #include "ItemDialog.h"
 
 class CMapItemList : public std::list<CMapItem>
@@ -36,11 +39,12 @@ class CMapItemList : public std::list<CMapItem>
     void Restart();
     void SetParentWindow( Gtk::Window& aParent );
     void SetFound( std::list<CMapItem>::iterator& aItem, guint8 aOwner );
+    void SetOwner( std::list<CMapItem>::iterator& aItem, guint8 aOwner );
     void ClearSelected( guint8 aOwner );
     gboolean SetSelected( EnigmaWC::ID iID, guint8 aOwner, gboolean aSelected );
     gboolean GetFound( std::list<CMapItem>::iterator& aItem );
     gboolean GetSelected( EnigmaWC::ID iID, guint8 aOwner );
-    gboolean UseKey( std::list<CMapObject>::iterator& aObject, guint8 aOwner );
+    gboolean UseKey( CMapObjectList::iterator& aObject, guint8 aOwner );
     
     void Read( const CMapLocation& aLocation,
                std::list<std::list<CMapItem>::iterator>& aBuffer );
@@ -52,11 +56,35 @@ class CMapItemList : public std::list<CMapItem>
                        guint& aOptional,
                        guint& aEasterEgg,
                        guint& aSkull );
+
+    void Index();
                        
   private:
+    // Private methods.
+
+    void CheckIndex();
+    void Own( std::list<CMapItem>::iterator aItem );
+    void Disown( std::list<CMapItem>::iterator aItem );
+    void Count( std::list<CMapItem>::iterator aItem, gint aChange );
+
     // Private data.
 
     std::unique_ptr<CItemDialog> iItemDialog;   // Dialog describing found item.
+
+    std::unordered_map<guint64, std::vector<std::list<CMapItem>::iterator>>
+      iLocations;                               // Items in each map location.
+
+    std::unordered_map<guint, std::vector<std::list<CMapItem>::iterator>>
+      iOwned;                                   // Found items of each owner.
+
+    std::unordered_map<guint, std::vector<std::list<CMapItem>::iterator>>
+      iOwnedIDs;                                // Found items by owner and ID.
+
+    std::vector<std::list<CMapItem>::iterator>
+      iSwitched;                                // Unfound controlled items.
+
+    guint iRemaining[ (int)EnigmaWC::Category::TOTAL ]; // Unfound items.
+    gsize iIndexed;                             // Items in all indexes.
 };
 
 #endif // __MAPITEMLIST_H__
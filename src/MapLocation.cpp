@@ -82,3 +82,34 @@ gboolean CMapLocation::operator!=( const CMapLocation& aLocation ) const
 {
   return (!( *this == aLocation ));
 }
+
+//*--------------------------------------------------*
+//* This method overrides the < comparison operator. *
+//* Locations are ordered by Above, North, then East *
+//* to match the sorting of map objects.             *
+//*--------------------------------------------------*
+
+gboolean CMapLocation::operator<( const CMapLocation& aLocation ) const
+{
+  if ( iAbove != aLocation.iAbove )
+    return ( iAbove < aLocation.iAbove );
+
+  if ( iNorth != aLocation.iNorth )
+    return ( iNorth < aLocation.iNorth );
+
+  return ( iEast < aLocation.iEast );
+}
+
+//*--------------------------------------------------*
+//* This method returns the location packed into one *
+//* value, for use as a hash table key.              *
+//*--------------------------------------------------*
+//* RETURN: Packed Above, North, and East values.    *
+//*--------------------------------------------------*
+
+guint64 CMapLocation::GetKey() const
+{
+  return ( (guint64)iAbove << 32 )
+       | ( (guint64)iNorth << 16 )
+       | (guint64)iEast;
+}
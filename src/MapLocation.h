@@ -32,6 +32,8 @@ class CMapLocation
     void Clear();
     gboolean operator==( const CMapLocation& aLocation ) const;
     gboolean operator!=( const CMapLocation& aLocation ) const;
+    gboolean operator<( const CMapLocation& aLocation ) const;
+    guint64 GetKey() const;
     
     // Public data.
 
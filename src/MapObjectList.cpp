@@ -2,9 +2,10 @@
 // Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
 // 
 // This file is the MapObjectList class implementation.  The MapObjectList
-// class manages a list of map objects.  The list contents are sorted according
-// to their map location, and the list iterator is cached for faster locating
-// of objects.
+// class manages a list of map objects.  Each object is packed into a small
+// record in one array, and only connected objects use an entry in a separate
+// table of signal names.  A sorted index of records is kept for faster
+// locating of objects.
 //
 // This program is free software: you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -19,17 +20,32 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <vector>
 #include "MapObjectList.h"
 
+//*-------------------------------------*
+//* Local declarations and definitions. *
+//*-------------------------------------*
+
+#define KSenseState      ( 1 << 0 )     // Packed local connection states.
+#define KStateState      ( 1 << 1 )
+#define KVisibilityState ( 1 << 2 )
+#define KPresenceState   ( 1 << 3 )
+#define KFreeRecord      ( 1 << 7 )     // Record is not in use.
+
+#define KNoNames G_MAXUINT32            // Object has no signal names.
+
 //*----------------------*
 //* Default constructor. *
 //*----------------------*
 
 CMapObjectList::CMapObjectList()
 {	
-	// Initialize the cached Object iterator.
+	// Initialize the object index and region streaming.
 	
-	iIterator = end();
+	iVersion = 0;
+	Clear();
 	return;
 }
 
@@ -39,94 +55,656 @@ CMapObjectList::CMapObjectList()
 
 void CMapObjectList::Clear()
 {
-	// Clear the list in the base class.
-	
-	clear();
+	// Clear the object records, signal names, and object index.
 	
-	// Initialize the cached Object iterator.
+	iRecords.clear();
+	iFreeRecords.clear();
+	iNames.clear();
+	iFreeNames.clear();
+	iIndex.clear();
+	++ iVersion;
 
-	iIterator = end();
+	// Stop streaming map regions.
+
+	iReader    = type_slot_region();
+	iStreamed  = FALSE;
+	iRegions.clear();
+	iGeneration = 0;
+	iResident   = 0;
 	return;
 }
 
-//*-------------------------------------------------------------------*
-//* This method moves the list iterator just past an object whose     *
-//* location (East, North, Above) matches the one provided.           *
-//* If none exist, the iterator will point past the end of the list.  *
-//* All objects are sorted according to their location.               *
-//*-------------------------------------------------------------------*
-//* aLocation: Map location to seek.                                  *
-//*-------------------------------------------------------------------*
+//*--------------------------------------------------------------*
+//* This method adds an object to the list.  The index must be   *
+//* built again with Index() once all objects have been added.   *
+//*--------------------------------------------------------------*
+//* aObject: Map object to be added.                             *
+//*--------------------------------------------------------------*
 
-void CMapObjectList::Seek( const CMapLocation& aLocation )
+void CMapObjectList::push_back( const CMapObject& aObject )
 {
-	// Move the list iterator if the East, North, and Above are too high. 
-	
-	while (( iIterator != begin() )
-	  && 
-			(( iIterator == end() )
-		||
-		  ( (*iIterator).iLocation.iAbove > aLocation.iAbove )
-		||
-			(( (*iIterator).iLocation.iAbove == aLocation.iAbove )
-		&& ( (*iIterator).iLocation.iNorth > aLocation.iNorth ))
-		|| 
-			(( (*iIterator).iLocation.iAbove == aLocation.iAbove )
-		&& ( (*iIterator).iLocation.iNorth == aLocation.iNorth )
-		&& ( (*iIterator).iLocation.iEast > aLocation.iEast ))))
+	Add( aObject );
+	return;
+}
+
+//*-------------------------------------------------------------*
+//* This private method packs an object into a record, reusing  *
+//* a record not in use if there is one.  Signal names are only *
+//* kept for an object with a named connection.                 *
+//*-------------------------------------------------------------*
+//* aObject: Map object to be added.                            *
+//* RETURN:  Index of object record.                            *
+//*-------------------------------------------------------------*
+
+guint32 CMapObjectList::Add( const CMapObject& aObject )
+{
+	guint32 Index;
+
+	if ( iFreeRecords.empty() )
+	{
+		Index = (guint32)iRecords.size();
+		iRecords.emplace_back();
+	}
+	else
 	{
-		iIterator --;
+		Index = iFreeRecords.back();
+		iFreeRecords.pop_back();
 	}
 
-	// Move the list iterator if East, North, and Above are too low
-	// or equal.
-	
-	while (( iIterator != end() )
-		&& (( (*iIterator).iLocation.iAbove < aLocation.iAbove )
-		||
-			(( (*iIterator).iLocation.iAbove == aLocation.iAbove )
-		&& ( (*iIterator).iLocation.iNorth < aLocation.iNorth ))
-		|| 
-			(( (*iIterator).iLocation.iAbove == aLocation.iAbove )
-		&& ( (*iIterator).iLocation.iNorth == aLocation.iNorth )
-		&& ( (*iIterator).iLocation.iEast <= aLocation.iEast ))))
+	CRecord& Record = iRecords[ Index ];
+
+	Record.iID       = aObject.iID;
+	Record.iSurface  = aObject.iSurface;
+	Record.iRotation = aObject.iRotation;
+	Record.iLocation = aObject.iLocation;
+	Record.iStates   = 0;
+	Record.iNames    = KNoNames;
+
+	if ( aObject.iSense.GetLocalState() )
+		Record.iStates |= KSenseState;
+
+	if ( aObject.iState.GetLocalState() )
+		Record.iStates |= KStateState;
+
+	if ( aObject.iVisibility.GetLocalState() )
+		Record.iStates |= KVisibilityState;
+
+	if ( aObject.iPresence.GetLocalState() )
+		Record.iStates |= KPresenceState;
+
+	if (( aObject.iSense.Interned() != NULL )
+	 || ( aObject.iState.Interned() != NULL )
+	 || ( aObject.iVisibility.Interned() != NULL )
+	 || ( aObject.iPresence.Interned() != NULL ))
 	{
-		iIterator ++;
+		if ( iFreeNames.empty() )
+		{
+			Record.iNames = (guint32)iNames.size();
+			iNames.emplace_back();
+		}
+		else
+		{
+			Record.iNames = iFreeNames.back();
+			iFreeNames.pop_back();
+		}
+
+		CNames& Names = iNames[ Record.iNames ];
+
+		Names.iSense      = aObject.iSense.Interned();
+		Names.iState      = aObject.iState.Interned();
+		Names.iVisibility = aObject.iVisibility.Interned();
+		Names.iPresence   = aObject.iPresence.Interned();
 	}
-	
+
+	return Index;
+}
+
+//*-----------------------------------------------------------*
+//* This private method marks an object record as not in use, *
+//* so it may be reused by the next object added.  The index  *
+//* must then be updated.                                     *
+//*-----------------------------------------------------------*
+//* aIndex: Index of object record.                           *
+//*-----------------------------------------------------------*
+
+void CMapObjectList::Remove( guint32 aIndex )
+{
+	CRecord& Record = iRecords[ aIndex ];
+
+	if ( Record.iNames != KNoNames )
+		iFreeNames.push_back( Record.iNames );
+
+	Record.iStates = KFreeRecord;
+	Record.iNames  = KNoNames;
+	iFreeRecords.push_back( aIndex );
+	return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method returns the signal names of an object.    *
+//* An object without named connections has only empty names.     *
+//*---------------------------------------------------------------*
+//* aRecord: Object record.                                       *
+//* RETURN:  Signal names.                                        *
+//*---------------------------------------------------------------*
+
+const CMapObjectList::CNames& CMapObjectList::Names( const CRecord& aRecord )
+                                                     const
+{
+	static const CNames None = { NULL, NULL, NULL, NULL };
+
+	if ( aRecord.iNames == KNoNames )
+		return None;
+	else
+		return iNames[ aRecord.iNames ];
+}
+
+//*---------------------------------------------------------------*
+//* This private method finds the next object record in use.      *
+//*---------------------------------------------------------------*
+//* aIndex: Index of the first record to be examined.             *
+//* RETURN: Index of a record in use, or the number of records.   *
+//*---------------------------------------------------------------*
+
+guint32 CMapObjectList::Next( guint32 aIndex ) const
+{
+	while (( aIndex < iRecords.size() )
+	    && ( iRecords[ aIndex ].iStates & KFreeRecord ))
+	{
+		++ aIndex;
+	}
+
+	return aIndex;
+}
+
+//*--------------------------------------------------------------*
+//* This method returns an iterator to the first object.  The    *
+//* objects are visited in the order they were first added.      *
+//*--------------------------------------------------------------*
+
+CMapObjectList::iterator CMapObjectList::begin()
+{
+	return iterator( this, Next( 0 ));
+}
+
+//*--------------------------------------------------------------*
+//* This method returns an iterator following the last object.   *
+//*--------------------------------------------------------------*
+
+CMapObjectList::iterator CMapObjectList::end()
+{
+	return iterator( this, (guint32)iRecords.size() );
+}
+
+//*--------------------------------------------------------------*
+//* This method returns the number of objects in the list.       *
+//*--------------------------------------------------------------*
+
+gsize CMapObjectList::size() const
+{
+	return iRecords.size() - iFreeRecords.size();
+}
+
+//*-------------------------------------------------------------------*
+//* This method builds the index of objects sorted by their packed    *
+//* location.  It must be called after objects are added to the list. *
+//* Objects in the same location keep their list order.               *
+//*-------------------------------------------------------------------*
+
+void CMapObjectList::Index()
+{
+	// Pair the packed location of each object with its record.  Sorting
+	// the pairs keeps objects in the same location in record order.
+
+	std::vector<std::pair<guint64, guint32>> Entries;
+	Entries.reserve( size() );
+
+	for ( guint32 Index = Next( 0 );
+	      Index < iRecords.size();
+	      Index = Next( Index + 1 ))
+	{
+		Entries.push_back(
+		  std::make_pair( iRecords[ Index ].iLocation.GetKey(), Index ));
+	}
+
+	// The records are normally sorted already, but a keyvalue array game
+	// map file may list its objects in any order.
+
+	if ( !std::is_sorted( Entries.begin(), Entries.end() ))
+		std::sort( Entries.begin(), Entries.end() );
+
+	iIndex.clear();
+	iIndex.reserve( Entries.size() );
+
+	for ( std::pair<guint64, guint32>& Entry : Entries )
+		iIndex.push_back( Entry.second );
+
+	++ iVersion;
 	return;
 }
 
 //*-----------------------------------------------------------------*
 //* This method returns iterators to all objects in a map location. *
+//* In a streamed game map, only objects in resident regions are    *
+//* returned, so the location must first be touched.                *
 //*-----------------------------------------------------------------*
 //* aLocation: Map location to be examined.                         *
-//* aBuffer:   Buffer to receive copies of MapObject iterators.     *
+//* aBuffer:   Buffer to receive MapObject iterators.               *
 //*-----------------------------------------------------------------*
 
 void CMapObjectList::Read( const CMapLocation& aLocation,
-                           std::list<std::list<CMapObject>::iterator>& aBuffer )
+                           std::list<CMapObjectList::iterator>& aBuffer )
+{
+	// Find the range of index entries with the location.
+
+	guint64 Key = aLocation.GetKey();
+
+	std::vector<guint32>::const_iterator First =
+	  std::lower_bound( iIndex.begin(),
+	                    iIndex.end(),
+	                    Key,
+	                    [ this ]( guint32 aEntry, guint64 aKey )
+	                    { return iRecords[ aEntry ].iLocation.GetKey() < aKey; } );
+
+	std::vector<guint32>::const_iterator Last = First;
+
+	while (( Last != iIndex.end() )
+	    && ( iRecords[ *Last ].iLocation.GetKey() == Key ))
+	{
+		++ Last;
+	}
+
+	// Copy the iterators to the objects into the provided buffer, last
+	// object first.
+
+	while ( Last != First )
+	{
+		-- Last;
+		aBuffer.push_back( iterator( this, *Last ));
+	}
+
+	return;
+}
+
+//*------------------------------------------*
+//* Iterator default constructor.  The       *
+//* iterator does not refer to any object.   *
+//*------------------------------------------*
+
+CMapObjectList::iterator::iterator()
+{
+	iList  = NULL;
+	iIndex = 0;
+	return;
+}
+
+//*----------------------------------------------*
+//* Iterator constructor.                        *
+//*----------------------------------------------*
+//* aList:  List holding the object.             *
+//* aIndex: Index of object record.              *
+//*----------------------------------------------*
+
+CMapObjectList::iterator::iterator( CMapObjectList* aList, guint32 aIndex )
+{
+	iList  = aList;
+	iIndex = aIndex;
+	return;
+}
+
+//*----------------------------------------------*
+//* This method returns the object referred to.  *
+//*----------------------------------------------*
+
+CMapObjectList::CObject CMapObjectList::iterator::operator*() const
+{
+	return CObject( *iList, iIndex );
+}
+
+//*-------------------------------------------------------------*
+//* This method copies the object into a MapObject, for methods *
+//* that are shared with teleporters, items, and players.  The  *
+//* record is read directly, since objects are copied each time *
+//* they are drawn.                                             *
+//*-------------------------------------------------------------*
+//* aObject: MapObject to receive the object.                   *
+//*-------------------------------------------------------------*
+
+void CMapObjectList::iterator::Unpack( CMapObject& aObject ) const
+{
+	const CRecord& Record = iList->iRecords[ iIndex ];
+	const CNames& Names   = iList->Names( Record );
+
+	aObject.iID       = Record.iID;
+	aObject.iSurface  = Record.iSurface;
+	aObject.iRotation = Record.iRotation;
+	aObject.iLocation = Record.iLocation;
+
+	aObject.iSense.Restore( Names.iSense,
+	                        ( Record.iStates & KSenseState ) != 0 );
+
+	aObject.iState.Restore( Names.iState,
+	                        ( Record.iStates & KStateState ) != 0 );
+
+	aObject.iVisibility.Restore( Names.iVisibility,
+	                             ( Record.iStates & KVisibilityState ) != 0 );
+
+	aObject.iPresence.Restore( Names.iPresence,
+	                           ( Record.iStates & KPresenceState ) != 0 );
+	return;
+}
+
+//*-----------------------------------------------*
+//* This method advances to the next object.      *
+//*-----------------------------------------------*
+
+CMapObjectList::iterator& CMapObjectList::iterator::operator++()
+{
+	iIndex = iList->Next( iIndex + 1 );
+	return *this;
+}
+
+//*-----------------------------------------------------*
+//* These methods compare the objects referred to.      *
+//*-----------------------------------------------------*
+
+gboolean CMapObjectList::iterator::operator==( const iterator& aIterator )
+                                               const
+{
+	return (( iList == aIterator.iList ) && ( iIndex == aIterator.iIndex ));
+}
+
+gboolean CMapObjectList::iterator::operator!=( const iterator& aIterator )
+                                               const
+{
+	return !( *this == aIterator );
+}
+
+//*-----------------------------------------------------------*
+//* Object constructor.  The object refers to the fields of a *
+//* record, and to its signal names.                          *
+//*-----------------------------------------------------------*
+//* aList:  List holding the object.                          *
+//* aIndex: Index of object record.                           *
+//*-----------------------------------------------------------*
+
+CMapObjectList::CObject::CObject( CMapObjectList& aList, guint32 aIndex )
+  : iID( aList.iRecords[ aIndex ].iID ),
+    iSurface( aList.iRecords[ aIndex ].iSurface ),
+    iRotation( aList.iRecords[ aIndex ].iRotation ),
+    iLocation( aList.iRecords[ aIndex ].iLocation ),
+    iSense( aList.Names( aList.iRecords[ aIndex ] ).iSense,
+            aList.iRecords[ aIndex ].iStates,
+            KSenseState ),
+    iState( aList.Names( aList.iRecords[ aIndex ] ).iState,
+            aList.iRecords[ aIndex ].iStates,
+            KStateState ),
+    iVisibility( aList.Names( aList.iRecords[ aIndex ] ).iVisibility,
+                 aList.iRecords[ aIndex ].iStates,
+                 KVisibilityState ),
+    iPresence( aList.Names( aList.iRecords[ aIndex ] ).iPresence,
+               aList.iRecords[ aIndex ].iStates,
+               KPresenceState )
+{
+	return;
+}
+
+//*-------------------------------------------------------------*
+//* This private function returns the key of the map region     *
+//* containing a map location.                                  *
+//*-------------------------------------------------------------*
+//* aEast:  Room East location.                                 *
+//* aNorth: Room North location.                                *
+//* aAbove: Room Above location.                                *
+//* RETURN: Region key.                                         *
+//*-------------------------------------------------------------*
+
+guint64 RegionKey( guint32 aEast, guint32 aNorth, guint32 aAbove )
+{
+	return ((guint64)( aAbove >> KRegionShift ) << 32 )
+	     | ((guint64)( aNorth >> KRegionShift ) << 16 )
+	     | (guint64)( aEast >> KRegionShift );
+}
+
+//*--------------------------------------------------------------*
+//* This method starts streaming map regions.  The list is       *
+//* emptied, and objects are then read one region at a time when *
+//* a location in the region is touched.                         *
+//*--------------------------------------------------------------*
+//* aReader: Slot that reads all objects in a map region.        *
+//*--------------------------------------------------------------*
+
+void CMapObjectList::SetRegionReader( const type_slot_region& aReader )
+{
+	Clear();
+	iReader   = aReader;
+	iStreamed = TRUE;
+	return;
+}
+
+//*-------------------------------------------------------*
+//* This method returns the index version, which changes  *
+//* whenever objects are added to or removed from the     *
+//* list.                                                 *
+//*-------------------------------------------------------*
+//* RETURN: Index version.                                *
+//*-------------------------------------------------------*
+
+guint64 CMapObjectList::GetVersion()
+{
+	return iVersion;
+}
+
+//*-------------------------------------------------------*
+//* This method returns the region streaming state.       *
+//*-------------------------------------------------------*
+//* RETURN: TRUE if map regions are streamed.             *
+//*-------------------------------------------------------*
+
+gboolean CMapObjectList::GetStreamed()
+{
+	return iStreamed;
+}
+
+//*-------------------------------------------------------------*
+//* This private method reads all objects in a map region, and  *
+//* merges them into the sorted index.                          *
+//*-------------------------------------------------------------*
+//* aKey: Region key.                                           *
+//*-------------------------------------------------------------*
+
+void CMapObjectList::ReadRegion( guint64 aKey )
+{
+	CMapLocation Lower;
+
+	Lower.iAbove = (guint16)((( aKey >> 32 ) & 0xFFFF ) << KRegionShift );
+	Lower.iNorth = (guint16)((( aKey >> 16 ) & 0xFFFF ) << KRegionShift );
+	Lower.iEast  = (guint16)(( aKey & 0xFFFF ) << KRegionShift );
+
+	std::list<CMapObject> Objects;
+	iReader( Lower, Objects );
+
+	// Record the region.  An empty region has a small cost, which keeps
+	// the number of resident regions bounded.
+
+	CRegion& Region = iRegions[ aKey ];
+
+	Region.iCount      = Objects.size();
+	Region.iGeneration = iGeneration;
+	iResident         += Region.iCount + 1;
+
+	// Pack the objects, which are already sorted by location, and merge
+	// their records into the index.  The records of other objects are not
+	// moved, so all existing iterators remain valid.
+
+	std::vector<guint32> Added;
+	Added.reserve( Objects.size() );
+
+	for ( CMapObject& Object : Objects )
+		Added.push_back( Add( Object ));
+
+	std::vector<guint32> Merged( iIndex.size() + Added.size() );
+
+	std::merge( iIndex.begin(),
+	            iIndex.end(),
+	            Added.begin(),
+	            Added.end(),
+	            Merged.begin(),
+	            [ this ]( guint32 aFirst, guint32 aSecond )
+	            { return iRecords[ aFirst ].iLocation
+	                     < iRecords[ aSecond ].iLocation; } );
+
+	iIndex.swap( Merged );
+	return;
+}
+
+//*--------------------------------------------------------------*
+//* This method marks all map regions within reach of a location *
+//* as being in use, reading any regions that are not resident.  *
+//* Regions in use are not evicted by the next call to Trim().   *
+//*--------------------------------------------------------------*
+//* aLocation: Map location.                                     *
+//* aReach:    Number of rooms around the location.              *
+//*--------------------------------------------------------------*
+
+void CMapObjectList::Touch( const CMapLocation& aLocation, guint16 aReach )
 {
-	Seek( aLocation );
+	if ( !iStreamed )
+		return;
+
+	// Find the range of rooms within reach, clipped to the map space.
+
+	gint32 LowerEast  = MAX( (gint32)aLocation.iEast - aReach, 0 );
+	gint32 LowerNorth = MAX( (gint32)aLocation.iNorth - aReach, 0 );
+	gint32 LowerAbove = MAX( (gint32)aLocation.iAbove - aReach, 0 );
+	gint32 UpperEast  = MIN( (gint32)aLocation.iEast + aReach, G_MAXUINT16 );
+	gint32 UpperNorth = MIN( (gint32)aLocation.iNorth + aReach, G_MAXUINT16 );
+	gint32 UpperAbove = MIN( (gint32)aLocation.iAbove + aReach, G_MAXUINT16 );
 
-	while ( iIterator != begin() )
+	// Visit every region overlapping the range.
+
+	std::unordered_map<guint64, CRegion>::iterator Region;
+	guint64 Key;
+	gboolean Added = FALSE;
+
+	for ( gint32 Above = LowerAbove >> KRegionShift;
+	      Above <= ( UpperAbove >> KRegionShift );
+	      ++ Above )
 	{
-		// Since the list iterator following a seek will be on the object
-		// just past a desired object (or past the end of the list),
-		// move the iterator back.
+		for ( gint32 North = LowerNorth >> KRegionShift;
+		      North <= ( UpperNorth >> KRegionShift );
+		      ++ North )
+		{
+			for ( gint32 East = LowerEast >> KRegionShift;
+			      East <= ( UpperEast >> KRegionShift );
+			      ++ East )
+			{
+				Key = RegionKey( East << KRegionShift,
+				                 North << KRegionShift,
+				                 Above << KRegionShift );
 
-		iIterator --;
+				Region = iRegions.find( Key );
 
-    if ( (*iIterator).iLocation == aLocation )
+				if ( Region == iRegions.end() )
+				{
+					ReadRegion( Key );
+					Added = TRUE;
+				}
+				else
+					(*Region).second.iGeneration = iGeneration;
+			}
+		}
+	}
+
+	// The index has changed if new regions were read.
+
+	if ( Added )
+		++ iVersion;
+
+	return;
+}
+
+//*--------------------------------------------------------------*
+//* This method evicts the least recently used map regions until *
+//* the resident cost is within budget.  Regions used since the  *
+//* previous call are never evicted, since iterators to their    *
+//* objects may still be held.                                   *
+//*--------------------------------------------------------------*
+//* aBudget: Resident cost budget (approximately object count).  *
+//*--------------------------------------------------------------*
+
+void CMapObjectList::Trim( gsize aBudget )
+{
+	if ( !iStreamed )
+		return;
+
+	if ( iResident > aBudget )
+	{
+		// Order the regions not in use from oldest to newest.
+
+		std::vector<std::pair<guint64, guint64>> Candidates;
+		std::unordered_map<guint64, CRegion>::iterator Region;
+
+		for ( Region = iRegions.begin(); Region != iRegions.end(); ++ Region )
 		{
-			// An object is present with the correct location.  Copy the iterator
-      // to this object into the provided buffer.
+			if ( (*Region).second.iGeneration < iGeneration )
+			{
+				Candidates.push_back(
+				  std::make_pair( (*Region).second.iGeneration, (*Region).first ));
+			}
+		}
+
+		std::sort( Candidates.begin(), Candidates.end() );
 
-			aBuffer.push_back( iIterator );
+		// Evict the oldest regions, marking each with an invalid generation
+		// so its objects can be found in a single pass over the records.
+
+		gsize Evicted = 0;
+
+		while (( iResident > aBudget ) && ( Evicted < Candidates.size() ))
+		{
+			CRegion& Victim = iRegions[ Candidates[ Evicted ].second ];
+
+			iResident         -= Victim.iCount + 1;
+			Victim.iGeneration = G_MAXUINT64;
+			++ Evicted;
+		}
+
+		if ( Evicted != 0 )
+		{
+			for ( guint32 Index = Next( 0 );
+			      Index < iRecords.size();
+			      Index = Next( Index + 1 ))
+			{
+				const CMapLocation& Location = iRecords[ Index ].iLocation;
+
+				Region = iRegions.find( RegionKey( Location.iEast,
+				                                   Location.iNorth,
+				                                   Location.iAbove ));
+
+				if ( (*Region).second.iGeneration == G_MAXUINT64 )
+					Remove( Index );
+			}
+
+			for ( gsize Index = 0; Index < Evicted; ++ Index )
+				iRegions.erase( Candidates[ Index ].second );
+
+			// Remove the evicted records from the index, keeping the order
+			// of the others.
+
+			iIndex.erase( std::remove_if( iIndex.begin(),
+			                              iIndex.end(),
+			                              [ this ]( guint32 aIndex )
+			                              { return iRecords[ aIndex ].iStates
+			                                       & KFreeRecord; } ),
+			              iIndex.end() );
+
+			++ iVersion;
 		}
-		else
-			break;
 	}
 
+	// Start a new generation of region use.
+
+	++ iGeneration;
 	return;
 }
@@ -2,9 +2,11 @@
 // Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
 // 
 // This file is the MapObjectList class header.  The MapObjectList class
-// manages a list of map objects.  The list contents are sorted according
-// to their map location, and the list iterator is cached for faster locating
-// of objects.
+// manages a list of map objects.  Each object is packed into a small record
+// in one array, and only connected objects use an entry in a separate table
+// of signal names.  A sorted index of records is kept for faster locating
+// of objects.  For very large game maps, the list may instead hold only
+// objects in recently used map regions, reading other regions on demand.
 //
 // This program is free software: you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -22,24 +24,136 @@
 #ifndef __MAPOBJECTLIST_H__
 #define __MAPOBJECTLIST_H__
 
+#include <unordered_map>
+#include <vector>
 #include <gtkmm.h>
 #include "MapObject.h"
 
-class CMapObjectList : public std::list<CMapObject>
+#define KRegionShift 5                      // Map regions are 32 rooms wide.
+#define KRegionSize  ( 1 << KRegionShift )
+
+class CMapObjectList
 {
  public:
+	  // Public classes.
+
+		class CObject;
+
+		// An iterator is a stable handle to an object in the list.  It stays
+		// valid until the object's map region is evicted, or the list is
+		// cleared.
+
+		class iterator
+		{
+			public:
+				iterator();
+				iterator( CMapObjectList* aList, guint32 aIndex );
+				CObject operator*() const;
+				void Unpack( CMapObject& aObject ) const;
+				iterator& operator++();
+				gboolean operator==( const iterator& aIterator ) const;
+				gboolean operator!=( const iterator& aIterator ) const;
+
+			private:
+				CMapObjectList* iList;   // List holding the object.
+				guint32 iIndex;          // Object record index.
+		};
+
+		// An object refers to the fields of a packed object record, which are
+		// used like those of a MapObject.  It must not be kept while objects
+		// are added to the list.
+
+		class CObject
+		{
+			public:
+				CObject( CMapObjectList& aList, guint32 aIndex );
+
+				EnigmaWC::ID& iID;                // Object ID.
+				EnigmaWC::Direction& iSurface;    // Object surface.
+				EnigmaWC::Direction& iRotation;   // Object rotation on surface.
+				CMapLocation& iLocation;          // Map location of object.
+				CConnectionRef iSense;            // Sense state.
+				CConnectionRef iState;            // Functional state.
+				CConnectionRef iVisibility;       // Visiblity state.
+				CConnectionRef iPresence;         // Presence state.
+		};
+
 	  // Public methods.
 		
     CMapObjectList();
 		void Clear();
-		void Seek( const CMapLocation& aLocation );
+		void Index();
+		void push_back( const CMapObject& aObject );
+		iterator begin();
+		iterator end();
+		gsize size() const;
 
 		void Read( const CMapLocation& aLocation,
-               std::list<std::list<CMapObject>::iterator>& aBuffer );
+               std::list<CMapObjectList::iterator>& aBuffer );
+
+		// Region reader slot type.  The slot appends all objects in the map
+		// region with the provided lower corner, sorted by location.
+
+		typedef sigc::slot<void, const CMapLocation&, std::list<CMapObject>&>
+		  type_slot_region;
+
+		void SetRegionReader( const type_slot_region& aReader );
+		gboolean GetStreamed();
+		guint64 GetVersion();
+		void Touch( const CMapLocation& aLocation, guint16 aReach );
+		void Trim( gsize aBudget );
+
 	private:
+		// Private classes.
+
+		class CRecord
+		{
+			public:
+				EnigmaWC::ID iID;                 // Object ID.
+				EnigmaWC::Direction iSurface;     // Object surface.
+				EnigmaWC::Direction iRotation;    // Object rotation on surface.
+				guint8 iStates;                   // Local states, or free record.
+				CMapLocation iLocation;           // Map location of object.
+				guint32 iNames;                   // Signal names, if connected.
+		};
+
+		class CNames
+		{
+			public:
+				const CMapControllerList::CSignalName* iSense;
+				const CMapControllerList::CSignalName* iState;
+				const CMapControllerList::CSignalName* iVisibility;
+				const CMapControllerList::CSignalName* iPresence;
+		};
+
+		class CRegion
+		{
+			public:
+				gsize iCount;          // Number of objects in region.
+				guint64 iGeneration;   // Generation when last used.
+		};
+
+		// Private methods.
+
+		guint32 Add( const CMapObject& aObject );
+		void Remove( guint32 aIndex );
+		const CNames& Names( const CRecord& aRecord ) const;
+		guint32 Next( guint32 aIndex ) const;
+		void ReadRegion( guint64 aKey );
+
 	  // Private data.
 
-		std::list<CMapObject>::iterator iIterator;  // Cached list iterator.
+		std::vector<CRecord> iRecords;              // Packed object records.
+		std::vector<guint32> iFreeRecords;          // Records not in use.
+		std::vector<CNames> iNames;                 // Signal names of objects.
+		std::vector<guint32> iFreeNames;            // Names not in use.
+		std::vector<guint32> iIndex;                // Records sorted by location.
+		guint64 iVersion;                           // Index version.
+		type_slot_region iReader;                   // Region reader.
+		gboolean iStreamed;                         // TRUE if regions are streamed.
+		std::unordered_map<guint64, CRegion> iRegions; // Resident regions.
+		guint64 iGeneration;                        // Current use generation.
+		gsize iResident;                            // Resident region cost.
 };
 
 #endif // __MAPOBJECTLIST_H__
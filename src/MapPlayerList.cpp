@@ -18,6 +18,7 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include "MapPlayerList.h"
 
 //*----------------------*
@@ -26,6 +27,7 @@
 
 CMapPlayerList::CMapPlayerList()
 {	
+	iIndexed = 0;
 	return;
 }
 
@@ -35,9 +37,11 @@ CMapPlayerList::CMapPlayerList()
 
 void CMapPlayerList::Clear()
 {
-	// Clear the list in the base class.
+	// Clear the list in the base class, and the location index.
 	
 	clear();
+	iLocations.clear();
+	iIndexed = 0;
 	return;
 }
 
@@ -57,7 +61,8 @@ void CMapPlayerList::Load()
     (*Player).iActive   = (*Player).iActiveSaved;
     (*Player).iOutdoor  = (*Player).iOutdoorSaved;
   }
-	
+
+  Index();
 	return;
 }
 
@@ -97,7 +102,8 @@ void CMapPlayerList::Restart()
     (*Player).iActive   = (*Player).iActiveRestart;
     (*Player).iOutdoor  = (*Player).iOutdoorRestart;
   }
-	
+
+  Index();
 	return;
 }
 
@@ -185,16 +191,93 @@ gboolean CMapPlayerList::Valid( std::list<CMapPlayer>::iterator& aPlayer )
 void CMapPlayerList::Read( const CMapLocation& aLocation,
                            std::list<std::list<CMapPlayer>::iterator>& aBuffer )
 {
-  std::list<CMapPlayer>::iterator Player;
+  // Players are added while a game map is being read, so the location index
+  // is rebuilt if the list has grown.
 
-  for ( Player = begin(); Player != end(); ++ Player )
+  if ( iIndexed != size() )
+    Index();
+
+  // Add copies of the player list iterators in the location to the provided
+  // buffer.
+
+  std::unordered_map<guint64,
+    std::vector<std::list<CMapPlayer>::iterator>>::iterator Players;
+
+  Players = iLocations.find( aLocation.GetKey() );
+
+  if ( Players != iLocations.end() )
   {
-    // If the player location is correct, add a copy of the player list
-    // iterator to the provided buffer. 
-    
-    if ( (*Player).iLocation == aLocation )
-      aBuffer.push_back( Player );
+    aBuffer.insert( aBuffer.end(),
+                    Players->second.begin(),
+                    Players->second.end() );
   }
   
   return;
 }
+
+//*-------------------------------------------------------------*
+//* This method moves a player to a new map location, keeping   *
+//* the location index up to date.                              *
+//*-------------------------------------------------------------*
+//* aPlayer:   Iterator to MapPlayer.                           *
+//* aLocation: New map location.                                *
+//*-------------------------------------------------------------*
+
+void CMapPlayerList::Move( std::list<CMapPlayer>::iterator aPlayer,
+                           const CMapLocation& aLocation )
+{
+  if ( iIndexed != size() )
+  {
+    (*aPlayer).iLocation = aLocation;
+    Index();
+    return;
+  }
+
+  // Remove the player from the old location.
+
+  std::vector<std::list<CMapPlayer>::iterator>& Old =
+    iLocations[ (*aPlayer).iLocation.GetKey() ];
+
+  Old.erase( std::find( Old.begin(), Old.end(), aPlayer ));
+
+  if ( Old.empty() )
+    iLocations.erase( (*aPlayer).iLocation.GetKey() );
+
+  // Add the player to the new location, where players are kept in player
+  // number order like the list.
+
+  (*aPlayer).iLocation = aLocation;
+
+  std::vector<std::list<CMapPlayer>::iterator>& New =
+    iLocations[ aLocation.GetKey() ];
+
+  std::vector<std::list<CMapPlayer>::iterator>::iterator Position;
+
+  for ( Position = New.begin(); Position != New.end(); ++ Position )
+  {
+    if ( (*(*Position)).iNumber > (*aPlayer).iNumber )
+      break;
+  }
+
+  New.insert( Position, aPlayer );
+  return;
+}
+
+//*-------------------------------------------------------------*
+//* This method builds the index of players in each map         *
+//* location.  It must be called after player locations are     *
+//* changed without using Move().                               *
+//*-------------------------------------------------------------*
+
+void CMapPlayerList::Index()
+{
+  iLocations.clear();
+
+  std::list<CMapPlayer>::iterator Player;
+
+  for ( Player = begin(); Player != end(); ++ Player )
+    iLocations[ (*Player).iLocation.GetKey() ].push_back( Player );
+
+  iIndexed = size();
+  return;
+}
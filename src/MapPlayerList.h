@@ -21,6 +21,8 @@
 #ifndef __MAPPLAYERLIST_H__
 #define __MAPPLAYERLIST_H__
 
+#include <unordered_map>
+#include <vector>
 #include <gtkmm.h>
 #include "MapPlayer.h"
 
@@ -41,6 +43,19 @@ class CMapPlayerList : public std::list<CMapPlayer>
 
     void Read( const CMapLocation& aLocation,
                std::list<std::list<CMapPlayer>::iterator>& aBuffer );
+
+    void Move( std::list<CMapPlayer>::iterator aPlayer,
+               const CMapLocation& aLocation );
+
+    void Index();
+
+ private:
+	  // Private data.
+
+    std::unordered_map<guint64, std::vector<std::list<CMapPlayer>::iterator>>
+      iLocations;                     // Players in each map location.
+
+    gsize iIndexed;                   // Players in location index.
 };
 
 #endif // __MAPPLAYERLIST_H__
@@ -26,6 +26,7 @@
 
 CMapTeleporterList::CMapTeleporterList()
 {	
+	iIndexed = 0;
 	return;
 }
 
@@ -35,9 +36,11 @@ CMapTeleporterList::CMapTeleporterList()
 
 void CMapTeleporterList::Clear()
 {
-	// Clear the list in the base class.
+	// Clear the list in the base class, and the location index.
 	
 	clear();
+	iLocations.clear();
+	iIndexed = 0;
 	return;
 }
 
@@ -51,18 +54,44 @@ void CMapTeleporterList::Clear()
 void CMapTeleporterList::Read( const CMapLocation& aLocation,
                     std::list<std::list<CMapTeleporter>::iterator>& aBuffer )
 {
-  std::list<CMapTeleporter>::iterator Teleporter;
+  // Teleporters are only added while a game map is being read, and never
+  // move, so the location index is rebuilt only if the list has grown.
+
+  if ( iIndexed != size() )
+    Index();
+
+  // Add copies of the teleporter list iterators in the location to the
+  // provided buffer.
+
+  std::unordered_map<guint64,
+    std::vector<std::list<CMapTeleporter>::iterator>>::iterator Teleporters;
 
-  for ( Teleporter = begin();
-        Teleporter != end();
-        ++ Teleporter )
+  Teleporters = iLocations.find( aLocation.GetKey() );
+
+  if ( Teleporters != iLocations.end() )
   {
-    // If the teleporter location is correct, add a copy of the teleporter
-    // list iterator to the provided buffer. 
-    
-    if ( (*Teleporter).iLocation == aLocation )
-      aBuffer.push_back( Teleporter );
+    aBuffer.insert( aBuffer.end(),
+                    Teleporters->second.begin(),
+                    Teleporters->second.end() );
   }
   
   return;
 }
+
+//*-------------------------------------------------------------*
+//* This private method builds the index of teleporters in each *
+//* map location.                                               *
+//*-------------------------------------------------------------*
+
+void CMapTeleporterList::Index()
+{
+  iLocations.clear();
+
+  std::list<CMapTeleporter>::iterator Teleporter;
+
+  for ( Teleporter = begin(); Teleporter != end(); ++ Teleporter )
+    iLocations[ (*Teleporter).iLocation.GetKey() ].push_back( Teleporter );
+
+  iIndexed = size();
+  return;
+}
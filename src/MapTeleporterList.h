@@ -21,6 +21,8 @@
 #ifndef __MAPTELEPORTERLIST_H__
 #define __MAPTELEPORTERLIST_H__
 
+#include <unordered_map>
+#include <vector>
 #include <gtkmm.h>
 #include "MapTeleporter.h"
 
@@ -34,6 +36,19 @@ class CMapTeleporterList : public std::list<CMapTeleporter>
 
     void Read( const CMapLocation& aLocation,
                std::list<std::list<CMapTeleporter>::iterator>& aBuffer );
+
+ private:
+	  // Private methods.
+
+    void Index();
+
+	  // Private data.
+
+    std::unordered_map<guint64,
+      std::vector<std::list<CMapTeleporter>::iterator>>
+      iLocations;                     // Teleporters in each map location.
+
+    gsize iIndexed;                   // Teleporters in location index.
 };
 
 #endif // __MAPTELEPORTERLIST_H__
@@ -27,6 +27,22 @@
 
 #define KMapDirectory "Maps"
 
+// Game map summaries are cached in the user's cache directory, with one
+// group per game map filename.  A cached summary is used only if the game
+// map file size and modification time are unchanged.
+
+#define KCacheDirectory "enigma-in-the-wine-cellar"
+#define KCacheFilename  "Maps.ini"
+
+static const char* KCacheSize        = "Size";
+static const char* KCacheModified    = "Modified";
+static const char* KCacheValid       = "Valid";
+static const char* KCacheDescription = "Description";
+static const char* KCacheRequired    = "Required";
+static const char* KCacheOptional    = "Optional";
+static const char* KCacheEasterEgg   = "EasterEggs";
+static const char* KCacheSkull       = "Skulls";
+
 //*--------------------------*
 //* C++ default constructor. *
 //*--------------------------*
@@ -116,9 +132,45 @@ CMapsView::CMapsView()
 	// to emit a "Done" signal. 
 	
 	Button->signal_clicked().connect( sigc::mem_fun( *this, &CMapsView::On_Done ));
+
+  // Game map summaries are read by worker threads, which use a Dispatcher
+  // to signal the main loop once all summaries have been read.
+
+  iNextSummary   = 0;
+  iActiveWorkers = 0;
+
+  iDispatcher.connect( sigc::mem_fun( *this,
+                                      &CMapsView::On_Summaries_Read ));
+
+  // Load the game map summary cache.  A missing or faulty cache file is
+  // ignored, since all game map summaries will then be read again.
+
+  iCacheFilename = Glib::build_filename( Glib::get_user_cache_dir(),
+                                         KCacheDirectory,
+                                         KCacheFilename );
+  try
+  {
+    iCache.load_from_file( iCacheFilename );
+  }
+  catch( Glib::Error error )
+  {
+  }
+
 	return;
 }
 
+//*-------------------------*
+//* C++ default destructor. *
+//*-------------------------*
+
+CMapsView::~CMapsView()
+{
+  // Worker threads must not outlive the summaries they are filling.
+
+  JoinWorkers();
+  return;
+}
+
 //*----------------------------------------------*
 //* This method sets the selected game map name. *
 //*----------------------------------------------*
@@ -139,84 +191,335 @@ Glib::ustring& CMapsView::GetGameMap()
 	return iSelected;
 }
 
-//*---------------------------------------------------*
-//* This method builds a list of available game maps. *
-//*---------------------------------------------------*
+//*----------------------------------------------------------------*
+//* This method builds a list of available game maps.  Summaries   *
+//* for unchanged game maps are recalled from the cache, while the *
+//* remaining game maps are read in parallel by worker threads.    *
+//*----------------------------------------------------------------*
 
 void CMapsView::ReadMaps()
 {	
-  // Clear the ListStore of old entries.
+  // Wait for any earlier reading of game maps to finish, then clear the
+  // ListStore of old entries.
 
+  JoinWorkers();
   iListStore->clear();
+  iSummaries.clear();
 
-  // Create a game map to use for reading the game map descriptions.
-
-  std::unique_ptr<CMap> Map = std::unique_ptr<CMap>( new CMap );
-	
   // Create a list of all game map files.
 	
   Glib::Dir Directory( KMapDirectory );
   std::list<std::string> Entries( Directory.begin(), Directory.end() );
 
   std::list<std::string>::iterator Iterator;
-  Gtk::TreeModel::Row Row;
   std::string Filename;
+  guint Uncached = 0;
 	
   for ( Iterator = Entries.begin(); Iterator != Entries.end(); Iterator ++ )
   {
-    // Assemble a game map filename.
-		
+    // Skip the journals of saved games, which are not game maps.
+
+    if ( Glib::str_has_suffix( *Iterator, CMap::JournalFileName( "" )))
+      continue;
+
+    iSummaries.emplace_back();
+    CMapSummary& Summary = iSummaries.back();
+
+    Summary.iFilename = *(Iterator);
+    Summary.iSize     = -1;
+    Summary.iModified = -1;
+    Summary.iCached   = FALSE;
+    Summary.iValid    = FALSE;
+
+    // Record the game map file size and modification time, which identify
+    // the version of the game map having a cached summary.
+
     Filename = Glib::build_filename( KMapDirectory, *(Iterator) );
 
-    // Load the game map to read its description.  The game map will first
-    // clear any old game map it contains.
+    try
+    {
+      Glib::RefPtr<Gio::File> File = Gio::File::create_for_path( Filename );
+      Glib::RefPtr<Gio::FileInfo> Info =
+        File->query_info( "standard::size,time::modified,time::modified-usec" );
+
+      Summary.iSize     = Info->get_size();
+      Summary.iModified = ( Info->get_attribute_uint64( "time::modified" )
+                            * G_USEC_PER_SEC )
+                        + Info->get_attribute_uint32( "time::modified-usec" );
+    }
+    catch( Glib::Error error )
+    {
+    }
+
+    // Saved games are appended to a journal beside the game map file, so
+    // its size also identifies the version of the game map.
+
+    try
+    {
+      Glib::RefPtr<Gio::File> File =
+        Gio::File::create_for_path( CMap::JournalFileName( Filename ));
+
+      Glib::RefPtr<Gio::FileInfo> Info = File->query_info( "standard::size" );
+
+      if ( Summary.iSize >= 0 )
+        Summary.iSize += Info->get_size();
+    }
+    catch( Glib::Error error )
+    {
+    }
+
+    // Recall the game map summary from the cache if the game map file has
+    // not changed.
+
+    try
+    {
+      if (( Summary.iSize >= 0 )
+        && ( iCache.get_int64( Summary.iFilename, KCacheSize )
+             == Summary.iSize )
+        && ( iCache.get_int64( Summary.iFilename, KCacheModified )
+             == Summary.iModified ))
+      {
+        Summary.iValid = iCache.get_boolean( Summary.iFilename, KCacheValid );
+
+        if ( Summary.iValid )
+        {
+          Summary.iDescription =
+            iCache.get_string( Summary.iFilename, KCacheDescription );
+          Summary.iRequired =
+            iCache.get_integer( Summary.iFilename, KCacheRequired );
+          Summary.iOptional =
+            iCache.get_integer( Summary.iFilename, KCacheOptional );
+          Summary.iEasterEgg =
+            iCache.get_integer( Summary.iFilename, KCacheEasterEgg );
+          Summary.iSkull =
+            iCache.get_integer( Summary.iFilename, KCacheSkull );
+        }
+
+        Summary.iCached = TRUE;
+      }
+    }
+    catch( Glib::Error error )
+    {
+      Summary.iValid = FALSE;
+    }
+
+    if ( !Summary.iCached )
+      ++ Uncached;
+  }
+
+  // If all game map summaries were cached, the list can be shown at once.
+
+  if ( Uncached == 0 )
+  {
+    ShowMaps();
+    return;
+  }
+
+  // Start worker threads for reading the uncached game map summaries.  The
+  // last worker thread to finish will signal the main loop.
+
+  guint Workers = std::thread::hardware_concurrency();
+
+  if ( Workers == 0 )
+    Workers = 1;
+
+  if ( Workers > Uncached )
+    Workers = Uncached;
+
+  iNextSummary   = 0;
+  iActiveWorkers = Workers;
+
+  for ( guint Count = 0; Count < Workers; ++ Count )
+    iWorkers.emplace_back( &CMapsView::ReadSummaries, this );
+
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This method is run by each worker thread.  Uncached game map *
+//* summaries are claimed one at a time and read, with only the  *
+//* parts of a game map needed for a summary being loaded.       *
+//*--------------------------------------------------------------*
+
+void CMapsView::ReadSummaries()
+{
+  // Create a game map to use for reading the game map summaries.
+
+  std::unique_ptr<CMap> Map = std::unique_ptr<CMap>( new CMap );
+  gsize Index;
+
+  while (( Index = iNextSummary ++ ) < iSummaries.size() )
+  {
+    CMapSummary& Summary = iSummaries[ Index ];
+
+    if ( Summary.iCached )
+      continue;
+
+    // Load the game map summary.  The game map will first clear any old
+    // game map it contains.
+
+    Summary.iValid = Map->LoadSummary(
+      Glib::build_filename( KMapDirectory, Summary.iFilename ));
+
+    if ( Summary.iValid )
+    {
+      // Record the description and count items not yet found.
+
+      Summary.iDescription = Map->Description();
+
+      Map->Items().GetRemaining( Summary.iRequired,
+                                 Summary.iOptional,
+                                 Summary.iEasterEgg,
+                                 Summary.iSkull );
+    }
+  }
+
+  // Signal the main loop if this is the last worker thread to finish.
+
+  if ( -- iActiveWorkers == 0 )
+    iDispatcher.emit();
+
+  return;
+}
 
-    Map->LoadFile( Filename );
+//*---------------------------------------------------------------*
+//* This signal handler is called in the main loop once all game  *
+//* map summaries have been read.  The summary cache is updated,  *
+//* then the list of available game maps is shown.                *
+//*---------------------------------------------------------------*
 
-    if ( Map->GetLoaded() )
+void CMapsView::On_Summaries_Read()
+{
+  // Ignore a signal from worker threads that have already been joined, or
+  // from an earlier reading of game maps.
+
+  if ( iWorkers.empty() || ( iActiveWorkers != 0 ))
+    return;
+
+  JoinWorkers();
+
+  // Add the newly read game map summaries to the cache.
+
+  std::vector<CMapSummary>::iterator Summary;
+
+  for ( Summary = iSummaries.begin(); Summary != iSummaries.end(); ++ Summary )
+  {
+    if ( Summary->iCached )
+      continue;
+
+    iCache.remove_group( Summary->iFilename );
+    iCache.set_int64( Summary->iFilename, KCacheSize, Summary->iSize );
+    iCache.set_int64( Summary->iFilename, KCacheModified, Summary->iModified );
+    iCache.set_boolean( Summary->iFilename, KCacheValid, Summary->iValid );
+
+    if ( Summary->iValid )
     {
-      // If a game map was successfully loaded, assemble a TreeView entry for it.
+      iCache.set_string( Summary->iFilename,
+                         KCacheDescription,
+                         Summary->iDescription );
+
+      iCache.set_integer( Summary->iFilename,
+                          KCacheRequired,
+                          Summary->iRequired );
+
+      iCache.set_integer( Summary->iFilename,
+                          KCacheOptional,
+                          Summary->iOptional );
+
+      iCache.set_integer( Summary->iFilename,
+                          KCacheEasterEgg,
+                          Summary->iEasterEgg );
+
+      iCache.set_integer( Summary->iFilename,
+                          KCacheSkull,
+                          Summary->iSkull );
+    }
+
+    Summary->iCached = TRUE;
+  }
+
+  // Save the cache.  A C++ interface for creating the cache directory could
+  // not be found, so a C interface is used instead.  Failure to save the
+  // cache only means the game maps will be read again next time.
 
-      Row = *( iListStore->append() );
-      Row[ iColumnRecord.iFilename ] = *(Iterator);
-			
-      // Count items not yet found.
-			
-      guint Required;
-      guint Optional;
-      guint EasterEgg;
-      guint Skull;
+  g_mkdir_with_parents( Glib::path_get_dirname( iCacheFilename ).c_str(),
+                        0755 );
+  try
+  {
+    iCache.save_to_file( iCacheFilename );
+  }
+  catch( Glib::Error error )
+  {
+  }
+
+  ShowMaps();
+  return;
+}
+
+//*-----------------------------------------------------*
+//* This method waits for all worker threads to finish. *
+//*-----------------------------------------------------*
+
+void CMapsView::JoinWorkers()
+{
+  std::vector<std::thread>::iterator Worker;
+
+  for ( Worker = iWorkers.begin(); Worker != iWorkers.end(); ++ Worker )
+    Worker->join();
+
+  iWorkers.clear();
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This method fills the ListStore with all valid game maps, in *
+//* the order they were found in the game map directory.         *
+//*--------------------------------------------------------------*
+
+void CMapsView::ShowMaps()
+{
+  iListStore->clear();
+
+  std::vector<CMapSummary>::iterator Summary;
+  Gtk::TreeModel::Row Row;
+
+  for ( Summary = iSummaries.begin(); Summary != iSummaries.end(); ++ Summary )
+  {
+    if ( !Summary->iValid )
+      continue;
 
-      Map->Items().GetRemaining( Required, Optional, EasterEgg, Skull );
+    // Assemble a TreeView entry for a successfully read game map.
 
-      // Assemble a string containg a description of the game map and items remaining.
+    Row = *( iListStore->append() );
+    Row[ iColumnRecord.iFilename ] = Summary->iFilename;
 
-      Row[ iColumnRecord.iDescription ] = 
-        Glib::ustring::compose(_("\
+    // Assemble a string containg a description of the game map and items remaining.
+
+    Row[ iColumnRecord.iDescription ] = 
+      Glib::ustring::compose(_("\
 %1\n\n\
 REMAINING ITEMS:\n\
 Required = %2\n\
 Bonus = %3\n\
 Easter Eggs = %4\n\
 Skulls = %5"),\
-      Map->Description(),
-      Required,
-      Optional,
-      EasterEgg,
-      Skull );
-			
-      // Have the TreeView highlight the last selected item row,
-      // scrolling to it if necessary.
-
-      if ( *(Iterator) == iSelected )
-      {
-        const Gtk::TreeModel::Path Path( Row );
-        iTreeView->set_cursor( Path );
-        iTreeView->scroll_to_row( Path );
-      }
+    Summary->iDescription,
+    Summary->iRequired,
+    Summary->iOptional,
+    Summary->iEasterEgg,
+    Summary->iSkull );
+		
+    // Have the TreeView highlight the last selected item row,
+    // scrolling to it if necessary.
+
+    if ( Summary->iFilename == iSelected )
+    {
+      const Gtk::TreeModel::Path Path( Row );
+      iTreeView->set_cursor( Path );
+      iTreeView->scroll_to_row( Path );
     }
   }
-	
+
   return;
 }
 
@@ -20,6 +20,9 @@
 #ifndef __MAPSVIEW_H__
 #define __MAPSVIEW_H__
 
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <gtkmm.h>
 
 class CMapsView : public Gtk::Grid
@@ -28,6 +31,7 @@ class CMapsView : public Gtk::Grid
     // Public methods.
 
     CMapsView();
+    ~CMapsView();
 		void SetGameMap( const Glib::ustring& aName );
 		Glib::ustring& GetGameMap();
 		void ReadMaps();
@@ -54,6 +58,11 @@ class CMapsView : public Gtk::Grid
 		void Filename_Data_Function( Gtk::CellRenderer* const& aCellRenderer,
 			        				          const Gtk::TreeIter& aTreeIterator );
 
+		void ReadSummaries();
+		void On_Summaries_Read();
+		void JoinWorkers();
+		void ShowMaps();
+
 		// Private classes.
 		
 		class CItemColumns : public Gtk::TreeModel::ColumnRecord
@@ -69,6 +78,24 @@ class CMapsView : public Gtk::Grid
 				}
 		};	
 		
+		// Summary of a game map, either read from the game map file or
+		// recalled from the summary cache.
+
+		class CMapSummary
+		{
+			public:
+				std::string iFilename;      // Game map filename.
+				gint64 iSize;               // Game map file size.
+				gint64 iModified;           // Game map modification time (us).
+				gboolean iCached;           // TRUE if recalled from the cache.
+				gboolean iValid;            // TRUE if game map could be read.
+				std::string iDescription;   // Game map description.
+				guint iRequired;            // Required items remaining.
+				guint iOptional;            // Optional items remaining.
+				guint iEasterEgg;           // Easter eggs remaining.
+				guint iSkull;               // Skulls remaining.
+		};
+
 		// Private data.
 
 		CItemColumns iColumnRecord;                    // Model of list column data.
@@ -78,6 +105,13 @@ class CMapsView : public Gtk::Grid
 		type_signal_filename m_signal_filename;        // Map filename signal server.
 		type_signal_done m_signal_done;                // View done signal server.
 		Glib::ustring iSelected;                       // Last selected map filename.
+		std::vector<CMapSummary> iSummaries;           // Summaries of all game maps.
+		std::vector<std::thread> iWorkers;             // Summary reading threads.
+		std::atomic<gsize> iNextSummary;               // Next summary to be read.
+		std::atomic<guint> iActiveWorkers;             // Threads still reading.
+		Glib::Dispatcher iDispatcher;                  // Summaries read signal.
+		Glib::KeyFile iCache;                          // Cache of map summaries.
+		std::string iCacheFilename;                    // Cache filename.
 };
 
 #endif // __MAPSVIEW_H__
@@ -20,8 +20,24 @@
 #ifndef __MESH_H__
 #define __MESH_H__
 
+#include <vector>
 #include <GL/gl.h>
 
+// Image mesh files are little-endian.  A "msh2" file is an indexed mesh
+// written by the enigma-mesh-compile program:
+//
+// File identifier (4-byte "msh2")
+// Total vertices (4-byte integer, at most 65536)
+// Total indices (4-byte integer, three for each triangle)
+// Array of vertex positions (X, Y, Z) (3 x 2-byte integers)
+// Array of vertex colours (R, G, B, A) (4 x 1-byte integers)
+// Array of triangle vertex indices (2-byte integers)
+//
+// Positions are in units of 1/KMeshPositionUnits.  The original "msh\n"
+// files of unindexed triangles with float values can still be read.
+
+#define KMeshPositionUnits 8192     // Position units in a mesh unit.
+
 class CMesh
 {
 	public:
@@ -37,16 +53,19 @@ class CMesh
 		public:
 			CState()
 			{
-				// Set Buffer Object "names" to uninitialized value.
+				// The mesh has no vertices in the mesh store until loaded.
 				
-				iPositionBO = 0;
-				iColourBO   = 0;
+				iFirst = 0;
+				iIndex = 0;
+				iTotal = 0;
 			}
 		
-			std::vector<GLfloat> iVertices;   // Vertices (x,y,z triples).
-			std::vector<GLfloat> iColours;    // Vertex colours (r,g,b triples).
-			GLuint iPositionBO;               // Position buffer object.
-			GLuint iColourBO;                 // Colour buffer object.    
+			std::vector<GLshort> iPositions;  // Vertices (x,y,z triples).
+			std::vector<GLubyte> iColours;    // Vertex colours (r,g,b,a).
+			std::vector<GLushort> iIndices;   // Triangle vertex indices.
+			GLint iFirst;                     // First vertex in mesh store.
+			GLint iIndex;                     // First index in mesh store.
+			GLsizei iTotal;                   // Total number of indices.
 	};
 
 	// Public data.
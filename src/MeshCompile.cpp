@@ -0,0 +1,621 @@
+// "Enigma in the Wine Cellar" game for Linux.
+// Copyright (C) 2005, 2016, 2021 Chris Sterne <chris_sterne@hotmail.com>
+//
+// This file contains the main entry point for the image mesh compiler.  The
+// compiler reads a Blender image mesh exported in the ASCII Polygon (.ply)
+// format, and writes it as an indexed "msh2" image mesh (see Mesh.h).
+// Identical vertices are welded, positions and colours are quantized, and
+// the triangles are reordered to reuse the vertices in the OpenGL
+// post-transform vertex cache.
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <gtkmm.h>
+#include "Mesh.h"
+
+#define KCacheSize 32        // Vertices in the modelled vertex cache.
+
+//*--------------------------------------------------------------*
+//* This function reads an ASCII Polygon (.ply) image mesh.  The *
+//* vertex normals are ignored, and each face is split into a    *
+//* fan of triangles.                                            *
+//*--------------------------------------------------------------*
+//* aFileName:  Name of Polygon file.                            *
+//* aPositions: Buffer to receive vertex positions (x,y,z).      *
+//* aColours:   Buffer to receive vertex colours (r,g,b,a).      *
+//* aIndices:   Buffer to receive triangle vertex indices.       *
+//* RETURN:     TRUE if the image mesh was read.                 *
+//*--------------------------------------------------------------*
+
+gboolean ReadPolygonFile( const std::string& aFileName,
+                          std::vector<gdouble>& aPositions,
+                          std::vector<gdouble>& aColours,
+                          std::vector<guint32>& aIndices )
+{
+  std::ifstream File( aFileName );
+
+  if ( !File )
+    return FALSE;
+
+  // Read the header, which lists the elements in the file and the
+  // properties of each element.  The column of each vertex property is
+  // noted, and byte colour values are later scaled to the range 0 to 1.
+
+  std::vector<std::pair<std::string, guint32>> Elements;
+  gint Columns[ 7 ] = { -1, -1, -1, -1, -1, -1, -1 };
+  gdouble Scales[ 7 ] = { 1, 1, 1, 1, 1, 1, 1 };
+  const gchar* Names[ 7 ] = { "x", "y", "z", "red", "green", "blue", "alpha" };
+  gint Column = 0;
+  gboolean ASCII = FALSE;
+  std::string Line;
+  std::string Word;
+
+  while ( std::getline( File, Line ))
+  {
+    std::istringstream Words( Line );
+    Words >> Word;
+
+    if ( Word == "format" )
+    {
+      Words >> Word;
+      ASCII = ( Word == "ascii" );
+    }
+    else if ( Word == "element" )
+    {
+      guint32 Total = 0;
+      Words >> Word >> Total;
+      Elements.push_back( std::make_pair( Word, Total ));
+      Column = 0;
+    }
+    else if (( Word == "property" )
+          && ( !Elements.empty() )
+          && ( Elements.back().first == "vertex" ))
+    {
+      std::string Type;
+      Words >> Type >> Word;
+
+      for ( gint Index = 0; Index < 7; ++ Index )
+      {
+        if ( Word == Names[ Index ] )
+        {
+          Columns[ Index ] = Column;
+
+          if (( Index >= 3 )
+           && ( Type != "float" )
+           && ( Type != "double" ))
+          {
+            Scales[ Index ] = 1.0 / 255;
+          }
+        }
+      }
+
+      ++ Column;
+    }
+    else if ( Word == "end_header" )
+      break;
+  }
+
+  // Only ASCII files with vertex positions and colours can be read.
+
+  if ( !ASCII )
+    return FALSE;
+
+  for ( gint Index = 0; Index < 6; ++ Index )
+  {
+    if ( Columns[ Index ] < 0 )
+      return FALSE;
+  }
+
+  // Read the elements following the header.  Vertices without an alpha
+  // value are fully opaque.
+
+  std::vector<gdouble> Values;
+  guint32 Vertices = 0;
+
+  for ( std::pair<std::string, guint32>& Element : Elements )
+  {
+    for ( guint32 Count = 0; Count < Element.second; ++ Count )
+    {
+      if ( !std::getline( File, Line ))
+        return FALSE;
+
+      std::istringstream Words( Line );
+
+      if ( Element.first == "vertex" )
+      {
+        gdouble Value;
+        Values.clear();
+
+        while ( Words >> Value )
+          Values.push_back( Value );
+
+        for ( gint Index = 0; Index < 7; ++ Index )
+        {
+          if ( Columns[ Index ] >= (gint)Values.size() )
+            return FALSE;
+
+          gdouble Value = ( Columns[ Index ] < 0 ) ?
+                          1.0 : Values[ Columns[ Index ]] * Scales[ Index ];
+
+          if ( Index < 3 )
+            aPositions.push_back( Value );
+          else
+            aColours.push_back( Value );
+        }
+
+        ++ Vertices;
+      }
+      else if ( Element.first == "face" )
+      {
+        guint32 Total = 0;
+        std::vector<guint32> Face;
+        guint32 Vertex;
+
+        Words >> Total;
+
+        while (( Face.size() < Total ) && ( Words >> Vertex ))
+          Face.push_back( Vertex );
+
+        if ( Face.size() != Total )
+          return FALSE;
+
+        for ( guint32 Index = 2; Index < Total; ++ Index )
+        {
+          aIndices.push_back( Face[ 0 ] );
+          aIndices.push_back( Face[ Index - 1 ] );
+          aIndices.push_back( Face[ Index ] );
+        }
+      }
+    }
+  }
+
+  for ( guint32 Index : aIndices )
+  {
+    if ( Index >= Vertices )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+//*-------------------------------------------------------------------*
+//* This function quantizes the vertices of an image mesh, and welds  *
+//* vertices that become identical.  Positions are converted to       *
+//* fixed-point values, and colours to byte values.                   *
+//*-------------------------------------------------------------------*
+//* aPositions: Vertex positions (x,y,z).                             *
+//* aColours:   Vertex colours (r,g,b,a).                             *
+//* aIndices:   Triangle vertex indices, which are changed to indices *
+//*             of the welded vertices.                               *
+//* aState:     Mesh state to receive the welded vertices.            *
+//* RETURN:     FALSE if a position is outside the fixed-point range. *
+//*-------------------------------------------------------------------*
+
+gboolean WeldVertices( const std::vector<gdouble>& aPositions,
+                       const std::vector<gdouble>& aColours,
+                       std::vector<guint32>& aIndices,
+                       CMesh::CState& aState )
+{
+  std::map<std::pair<guint64, guint32>, guint32> Welded;
+  std::vector<guint32> Remap( aPositions.size() / 3 );
+  std::pair<guint64, guint32> Key;
+  GLshort Position[ 3 ];
+  GLubyte Colour[ 4 ];
+
+  for ( guint32 Vertex = 0; Vertex < Remap.size(); ++ Vertex )
+  {
+    for ( gint Part = 0; Part < 3; ++ Part )
+    {
+      glong Value = lround( aPositions[ ( Vertex * 3 ) + Part ]
+                            * KMeshPositionUnits );
+
+      if (( Value < G_MININT16 ) || ( Value > G_MAXINT16 ))
+        return FALSE;
+
+      Position[ Part ] = (GLshort)Value;
+    }
+
+    for ( gint Part = 0; Part < 4; ++ Part )
+    {
+      Colour[ Part ] =
+        (GLubyte)CLAMP( lround( aColours[ ( Vertex * 4 ) + Part ] * 255 ),
+                        0,
+                        255 );
+    }
+
+    Key.first  = ((guint64)(guint16)Position[ 0 ] << 32 )
+               | ((guint64)(guint16)Position[ 1 ] << 16 )
+               | (guint64)(guint16)Position[ 2 ];
+
+    Key.second = ( Colour[ 0 ] << 24 )
+               | ( Colour[ 1 ] << 16 )
+               | ( Colour[ 2 ] << 8 )
+               | Colour[ 3 ];
+
+    std::map<std::pair<guint64, guint32>, guint32>::iterator Found =
+      Welded.find( Key );
+
+    if ( Found == Welded.end() )
+    {
+      Found = Welded.insert(
+        std::make_pair( Key, (guint32)( aState.iPositions.size() / 3 ))).first;
+
+      aState.iPositions.insert( aState.iPositions.end(),
+                                Position,
+                                Position + 3 );
+
+      aState.iColours.insert( aState.iColours.end(), Colour, Colour + 4 );
+    }
+
+    Remap[ Vertex ] = (*Found).second;
+  }
+
+  for ( guint32& Index : aIndices )
+    Index = Remap[ Index ];
+
+  return TRUE;
+}
+
+//*---------------------------------------------------------------*
+//* This function returns the score of a vertex, used to choose   *
+//* the next triangle to draw.  Vertices recently used by drawn   *
+//* triangles, and vertices with few triangles left to draw, have *
+//* higher scores (Tom Forsyth, "Linear-Speed Vertex Cache        *
+//* Optimisation").                                               *
+//*---------------------------------------------------------------*
+//* aPosition: Position in the vertex cache, or -1 if not cached. *
+//* aValence:  Number of triangles still to be drawn.             *
+//* RETURN:    Vertex score.                                      *
+//*---------------------------------------------------------------*
+
+gdouble VertexScore( gint aPosition, guint32 aValence )
+{
+  if ( aValence == 0 )
+    return -1.0;
+
+  gdouble Score = 0.0;
+
+  // The vertices of the last triangle drawn have a fixed score, so the
+  // next triangle does not simply reuse its most recent edge.
+
+  if ( aPosition >= 3 )
+  {
+    Score = pow( 1.0 - ( (gdouble)( aPosition - 3 ) / ( KCacheSize - 3 )),
+                 1.5 );
+  }
+  else if ( aPosition >= 0 )
+    Score = 0.75;
+
+  return Score + ( 2.0 / sqrt( (gdouble)aValence ));
+}
+
+//*-------------------------------------------------------------------*
+//* This function reorders the triangles of an image mesh, so the     *
+//* vertices they use are likely to still be in the post-transform    *
+//* vertex cache.  The cache is modelled as least-recently-used.      *
+//*-------------------------------------------------------------------*
+//* aIndices:  Triangle vertex indices to be reordered.               *
+//* aVertices: Number of vertices.                                    *
+//*-------------------------------------------------------------------*
+
+void OptimizeTriangles( std::vector<guint32>& aIndices, guint32 aVertices )
+{
+  guint32 Triangles = aIndices.size() / 3;
+
+  // Find the triangles using each vertex.
+
+  std::vector<guint32> Valences( aVertices, 0 );
+  std::vector<guint32> Starts( aVertices + 1, 0 );
+  std::vector<guint32> Users( aIndices.size() );
+
+  for ( guint32 Index : aIndices )
+    ++ Valences[ Index ];
+
+  for ( guint32 Vertex = 0; Vertex < aVertices; ++ Vertex )
+    Starts[ Vertex + 1 ] = Starts[ Vertex ] + Valences[ Vertex ];
+
+  std::vector<guint32> Fill( Starts.begin(), Starts.end() - 1 );
+
+  for ( guint32 Index = 0; Index < aIndices.size(); ++ Index )
+    Users[ Fill[ aIndices[ Index ]] ++ ] = Index / 3;
+
+  // Score every vertex and triangle.
+
+  std::vector<gint> Positions( aVertices, -1 );
+  std::vector<gdouble> VertexScores( aVertices );
+  std::vector<gdouble> TriangleScores( Triangles, 0.0 );
+  std::vector<gboolean> Drawn( Triangles, FALSE );
+
+  for ( guint32 Vertex = 0; Vertex < aVertices; ++ Vertex )
+    VertexScores[ Vertex ] = VertexScore( -1, Valences[ Vertex ] );
+
+  for ( guint32 Index = 0; Index < aIndices.size(); ++ Index )
+    TriangleScores[ Index / 3 ] += VertexScores[ aIndices[ Index ]];
+
+  // Repeatedly draw the best triangle using a cached vertex.  If no
+  // cached vertex has triangles left to draw, the best remaining triangle
+  // of the whole mesh is drawn.
+
+  std::vector<guint32> Order;
+  std::vector<guint32> Cache;
+  std::vector<guint32> Changed;
+  guint32 Best = G_MAXUINT32;
+
+  Order.reserve( aIndices.size() );
+
+  while ( Order.size() < aIndices.size() )
+  {
+    if ( Best == G_MAXUINT32 )
+    {
+      for ( guint32 Triangle = 0; Triangle < Triangles; ++ Triangle )
+      {
+        if (( !Drawn[ Triangle ] )
+         && (( Best == G_MAXUINT32 )
+          || ( TriangleScores[ Triangle ] > TriangleScores[ Best ] )))
+        {
+          Best = Triangle;
+        }
+      }
+    }
+
+    // Draw the triangle, and move its vertices to the front of the cache.
+
+    Drawn[ Best ] = TRUE;
+    Changed = Cache;
+
+    for ( gint Corner = 0; Corner < 3; ++ Corner )
+      Order.push_back( aIndices[ ( Best * 3 ) + Corner ] );
+
+    for ( gint Corner = 2; Corner >= 0; -- Corner )
+    {
+      guint32 Vertex = aIndices[ ( Best * 3 ) + Corner ];
+
+      -- Valences[ Vertex ];
+
+      std::vector<guint32>::iterator Found =
+        std::find( Cache.begin(), Cache.end(), Vertex );
+
+      if ( Found != Cache.end() )
+        Cache.erase( Found );
+
+      Cache.insert( Cache.begin(), Vertex );
+      Changed.push_back( Vertex );
+    }
+
+    // Rescore the vertices whose cache positions or valences changed,
+    // including those pushed out of the cache, then their triangles.  A
+    // vertex listed twice has no score change the second time.
+
+    for ( guint32 Vertex : Cache )
+      Positions[ Vertex ] = -1;
+
+    if ( Cache.size() > KCacheSize )
+      Cache.resize( KCacheSize );
+
+    for ( guint32 Position = 0; Position < Cache.size(); ++ Position )
+      Positions[ Cache[ Position ]] = Position;
+
+    Best = G_MAXUINT32;
+
+    for ( guint32 Vertex : Changed )
+    {
+      gdouble Score = VertexScore( Positions[ Vertex ], Valences[ Vertex ] );
+      gdouble Change = Score - VertexScores[ Vertex ];
+
+      VertexScores[ Vertex ] = Score;
+
+      for ( guint32 User = Starts[ Vertex ];
+            User < Starts[ Vertex + 1 ];
+            ++ User )
+      {
+        TriangleScores[ Users[ User ]] += Change;
+      }
+    }
+
+    for ( guint32 Vertex : Cache )
+    {
+      for ( guint32 User = Starts[ Vertex ];
+            User < Starts[ Vertex + 1 ];
+            ++ User )
+      {
+        guint32 Triangle = Users[ User ];
+
+        if (( !Drawn[ Triangle ] )
+         && (( Best == G_MAXUINT32 )
+          || ( TriangleScores[ Triangle ] > TriangleScores[ Best ] )))
+        {
+          Best = Triangle;
+        }
+      }
+    }
+  }
+
+  aIndices.swap( Order );
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This function returns the average number of vertices transformed *
+//* for each triangle of an image mesh, using a first-in-first-out   *
+//* vertex cache.                                                    *
+//*------------------------------------------------------------------*
+//* aIndices:  Triangle vertex indices.                              *
+//* aVertices: Number of vertices.                                   *
+//* RETURN:    Average cache miss ratio.                             *
+//*------------------------------------------------------------------*
+
+gdouble CacheMissRatio( const std::vector<guint32>& aIndices,
+                        guint32 aVertices )
+{
+  if ( aIndices.empty() )
+    return 0.0;
+
+  std::vector<guint64> Entered( aVertices, 0 );
+  guint64 Misses = 0;
+
+  for ( guint32 Index : aIndices )
+  {
+    if (( Entered[ Index ] == 0 )
+     || ( Misses - Entered[ Index ] >= KCacheSize ))
+    {
+      ++ Misses;
+      Entered[ Index ] = Misses;
+    }
+  }
+
+  return (gdouble)Misses / ( aIndices.size() / 3 );
+}
+
+//*-------------------------------------------------------------------*
+//* This function renumbers the vertices of an image mesh in the      *
+//* order the triangles first use them, so vertex data is fetched in  *
+//* sequence.  Unused vertices are removed.                           *
+//*-------------------------------------------------------------------*
+//* aIndices: Triangle vertex indices, which are renumbered.          *
+//* aState:   Mesh state holding the vertices, which are reordered.   *
+//*-------------------------------------------------------------------*
+
+void OrderVertices( std::vector<guint32>& aIndices, CMesh::CState& aState )
+{
+  std::vector<guint32> Remap( aState.iPositions.size() / 3, G_MAXUINT32 );
+  std::vector<GLshort> Positions;
+  std::vector<GLubyte> Colours;
+
+  for ( guint32& Index : aIndices )
+  {
+    if ( Remap[ Index ] == G_MAXUINT32 )
+    {
+      Remap[ Index ] = Positions.size() / 3;
+
+      Positions.insert( Positions.end(),
+                        &aState.iPositions[ Index * 3 ],
+                        &aState.iPositions[ Index * 3 ] + 3 );
+
+      Colours.insert( Colours.end(),
+                      &aState.iColours[ Index * 4 ],
+                      &aState.iColours[ Index * 4 ] + 4 );
+    }
+
+    Index = Remap[ Index ];
+  }
+
+  aState.iPositions.swap( Positions );
+  aState.iColours.swap( Colours );
+  return;
+}
+
+//*---------------------------------------------------------*
+//* This function appends a little-endian integer to data.  *
+//*---------------------------------------------------------*
+//* aData:  Data to be extended.                            *
+//* aValue: Integer value.                                  *
+//* aBytes: Number of bytes in integer.                     *
+//*---------------------------------------------------------*
+
+void WriteInteger( std::string& aData, guint32 aValue, gint aBytes )
+{
+  for ( gint Byte = 0; Byte < aBytes; ++ Byte )
+    aData.push_back( (gchar)( aValue >> ( Byte * 8 )));
+
+  return;
+}
+
+int main( int argc, char *argv[] )
+{
+  if ( argc != 3 )
+  {
+    std::cerr << "Usage: " << argv[ 0 ] << " INPUT OUTPUT" << std::endl;
+    std::cerr << "Compile an ASCII .ply image mesh into a .msh image mesh."
+              << std::endl;
+    return 2;
+  }
+
+  // Read the image mesh.
+
+  std::vector<gdouble> Positions;
+  std::vector<gdouble> Colours;
+  std::vector<guint32> Indices;
+
+  if ( !ReadPolygonFile( argv[ 1 ], Positions, Colours, Indices ))
+  {
+    std::cerr << argv[ 1 ] << ": not a valid ASCII .ply image mesh"
+              << std::endl;
+    return 1;
+  }
+
+  // Weld identical vertices, and reorder the triangles and vertices for
+  // the vertex cache.
+
+  CMesh::CState State;
+
+  if ( !WeldVertices( Positions, Colours, Indices, State ))
+  {
+    std::cerr << argv[ 1 ] << ": vertex position out of range" << std::endl;
+    return 1;
+  }
+
+  guint32 Vertices = State.iPositions.size() / 3;
+  gdouble Before   = CacheMissRatio( Indices, Vertices );
+
+  OptimizeTriangles( Indices, Vertices );
+  OrderVertices( Indices, State );
+  Vertices = State.iPositions.size() / 3;
+
+  if ( Vertices > G_MAXUINT16 + 1 )
+  {
+    std::cerr << argv[ 1 ] << ": more than 65536 vertices" << std::endl;
+    return 1;
+  }
+
+  // Write the "msh2" image mesh.
+
+  std::string Data( "msh2" );
+
+  WriteInteger( Data, Vertices, 4 );
+  WriteInteger( Data, Indices.size(), 4 );
+
+  for ( GLshort Position : State.iPositions )
+    WriteInteger( Data, (guint16)Position, 2 );
+
+  Data.append( State.iColours.begin(), State.iColours.end() );
+
+  for ( guint32 Index : Indices )
+    WriteInteger( Data, Index, 2 );
+
+  std::ofstream File( argv[ 2 ], std::ios::binary );
+  File.write( Data.data(), Data.size() );
+  File.close();
+
+  if ( !File )
+  {
+    std::cerr << argv[ 2 ] << ": could not be written" << std::endl;
+    return 1;
+  }
+
+  std::cout << argv[ 2 ] << ": "
+            << ( Positions.size() / 3 ) << " -> " << Vertices
+            << " vertices, " << ( Indices.size() / 3 ) << " triangles, "
+            << "ACMR " << Before << " -> "
+            << CacheMissRatio( Indices, Vertices ) << ", "
+            << Data.size() << " bytes" << std::endl;
+
+  return 0;
+}
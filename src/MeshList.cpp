@@ -18,6 +18,7 @@
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <cstring>
 #define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
 #include <GL/glext.h>
@@ -30,6 +31,10 @@
 //*---------------------*
 
 #define KPlayerLimit 0.65           // Distance limit from Player center.
+#define KMatrixSize  16             // Transformation matrix elements.
+#define KVertexSize  12             // Bytes in a stored vertex.
+#define KStoreCapacity 65536        // Initial mesh store capacity.
+#define KUploadTime  2000           // Microseconds of mesh copying per call.
 
 #define KLightBeamOffsetX -0.090    // Offset from center of LightBeam mesh.
 #define KLightBeamOffsetY  0.220
@@ -175,7 +180,7 @@ static const gint8 KViewerRotateZ[ (int)EnigmaWC::Direction::TOTAL ] =
 // surface facing Above onto another surface.  The rotations are in
 // units of quarter-turns (+/- 90 degrees).
 
-static const gint8 KObjectRotateX[ (int)EnigmaWC::Direction::TOTAL ] =
+static constexpr gint8 KObjectRotateX[ (int)EnigmaWC::Direction::TOTAL ] =
 //----------------------------------------------
 // .   n   s   e   w   a   b   c    <-- Surface
 //----------------------------------------------
@@ -183,7 +188,7 @@ static const gint8 KObjectRotateX[ (int)EnigmaWC::Direction::TOTAL ] =
    0,  0,  0,  0,  0,  1, -1,  0
 };
 
-static const gint8 KObjectRotateY[ (int)EnigmaWC::Direction::TOTAL ] =
+static constexpr gint8 KObjectRotateY[ (int)EnigmaWC::Direction::TOTAL ] =
 //----------------------------------------------
 // .   n   s   e   w   a   b   c    <-- Surface
 //----------------------------------------------
@@ -194,7 +199,7 @@ static const gint8 KObjectRotateY[ (int)EnigmaWC::Direction::TOTAL ] =
 // This table is used for rotating an object on a surface around
 // an axis perpendicular to the surface.
 
-static const gint8 KObjectRotateZ[ (int)EnigmaWC::Direction::TOTAL ]
+static constexpr gint8 KObjectRotateZ[ (int)EnigmaWC::Direction::TOTAL ]
                                  [ (int)EnigmaWC::Direction::TOTAL ] =
 
 //-------------------------------------------------
@@ -211,6 +216,115 @@ static const gint8 KObjectRotateZ[ (int)EnigmaWC::Direction::TOTAL ]
   { 0,  0,  0,  0,  0,  0,  0,  0 }     // On ECenter surface.
 };
 
+// An object's surface and rotation give one of 24 orientations, each made
+// of quarter-turns.  Every column of an orientation matrix has a single
+// element of 1 or -1, so it is kept as the row and sign of that element.
+// Multiplying a matrix by an orientation then only selects its columns.
+
+class COrientation
+{
+  public:
+    gint8 iRows[ 3 ];               // Row of the element in each column.
+    gint8 iSigns[ 3 ];              // Sign of the element in each column.
+};
+
+class COrientationTable
+{
+  public:
+    COrientation iOrientations[ (int)EnigmaWC::Direction::TOTAL ]
+                              [ (int)EnigmaWC::Direction::TOTAL ];
+};
+
+//*---------------------------------------------------------------*
+//* This function multiplies a 3 x 3 matrix by a quarter-turn     *
+//* rotation, in the same way as the Matrix4 rotate methods.      *
+//* Matrix elements are in column order.                          *
+//*---------------------------------------------------------------*
+//* aMatrix: Matrix to be rotated.                                *
+//* aAxis:   Rotation axis (0 = X, 1 = Y, 2 = Z).                 *
+//* aTurns:  Number of quarter-turns (+/- 90 degrees).            *
+//*---------------------------------------------------------------*
+
+constexpr void QuarterTurn( gint8 aMatrix[ 9 ], gint aAxis, gint aTurns )
+{
+  constexpr gint8 KCosines[ 4 ] = { 1, 0, -1, 0 };
+  constexpr gint8 KSines[ 4 ]   = { 0, 1, 0, -1 };
+
+  gint Turn   = (( aTurns % 4 ) + 4 ) % 4;
+  gint First  = ( aAxis + 1 ) % 3;
+  gint Second = ( aAxis + 2 ) % 3;
+  gint8 Rotation[ 9 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  gint8 Product[ 9 ]  = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+  Rotation[ aAxis + ( aAxis * 3 ) ]   = 1;
+  Rotation[ First + ( First * 3 ) ]   = KCosines[ Turn ];
+  Rotation[ Second + ( First * 3 ) ]  = KSines[ Turn ];
+  Rotation[ First + ( Second * 3 ) ]  = -KSines[ Turn ];
+  Rotation[ Second + ( Second * 3 ) ] = KCosines[ Turn ];
+
+  for ( gint Row = 0; Row < 3; ++ Row )
+  {
+    for ( gint Column = 0; Column < 3; ++ Column )
+    {
+      for ( gint Index = 0; Index < 3; ++ Index )
+      {
+        Product[ Row + ( Column * 3 ) ] += Rotation[ Row + ( Index * 3 ) ]
+                                         * aMatrix[ Index + ( Column * 3 ) ];
+      }
+    }
+  }
+
+  for ( gint Index = 0; Index < 9; ++ Index )
+    aMatrix[ Index ] = Product[ Index ];
+}
+
+//*----------------------------------------------------------------*
+//* This function builds the orientation of an object for every    *
+//* surface and rotation.  An object is rotated around the Z axis  *
+//* on its surface, then around the Y and X axes onto the surface. *
+//*----------------------------------------------------------------*
+//* RETURN: Table of orientations.                                 *
+//*----------------------------------------------------------------*
+
+constexpr COrientationTable BuildOrientations()
+{
+  COrientationTable Table = {};
+
+  for ( gint Surface = 0;
+        Surface < (int)EnigmaWC::Direction::TOTAL;
+        ++ Surface )
+  {
+    for ( gint Rotation = 0;
+          Rotation < (int)EnigmaWC::Direction::TOTAL;
+          ++ Rotation )
+    {
+      gint8 Matrix[ 9 ] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+      QuarterTurn( Matrix, 2, KObjectRotateZ[ Surface ][ Rotation ] );
+      QuarterTurn( Matrix, 1, KObjectRotateY[ Surface ] );
+      QuarterTurn( Matrix, 0, KObjectRotateX[ Surface ] );
+
+      COrientation& Orientation = Table.iOrientations[ Surface ][ Rotation ];
+
+      for ( gint Column = 0; Column < 3; ++ Column )
+      {
+        for ( gint Row = 0; Row < 3; ++ Row )
+        {
+          if ( Matrix[ Row + ( Column * 3 ) ] != 0 )
+          {
+            Orientation.iRows[ Column ]  = Row;
+            Orientation.iSigns[ Column ] = Matrix[ Row + ( Column * 3 ) ];
+          }
+        }
+      }
+    }
+  }
+
+  return Table;
+}
+
+static constexpr COrientationTable KOrientations = BuildOrientations();
+
 // These arrays are used for translating an object from its initial location
 // of (0, 0, 0) to its proper location in a room.
 
@@ -374,11 +488,225 @@ CMeshList::CMeshList()
   
 	ivPosition  = 0;
 	ivColour    = 0;
-	imTransform = 0;
+	ivTransform = 0;
+	iInstanceBO = 0;
+
+	iStoreBO       = 0;
+	iStoreSize     = 0;
+	iStoreCapacity = 0;
+	iIndexBO       = 0;
+	iIndexSize     = 0;
+	iIndexCapacity = 0;
+
+  iDecodedTotal  = 0;
+  iUploadedTotal = 0;
+  iPreloadStop   = false;
+  iPreloadStart  = 0;
+  iViewerValid   = FALSE;
+
+  // Prepare an empty batch for each state of each object image mesh.
+
+  iBatches.resize( (int)EnigmaWC::ID::TOTAL * 2 );
   
   return;
 }
 
+//*-----------------------------------------------------*
+//* Destructor.  A preload thread is stopped and ended. *
+//*-----------------------------------------------------*
+
+CMeshList::~CMeshList()
+{
+  StopPreload();
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This method begins preloading the image meshes of a game map.    *
+//* The meshes are decoded by another thread, then copied into the   *
+//* mesh store by calling Upload() while the OpenGL context is       *
+//* current.  A mesh needed before then is loaded when first drawn.  *
+//*------------------------------------------------------------------*
+//* aIDs: IDs of objects in the game map.                            *
+//*------------------------------------------------------------------*
+
+void CMeshList::Preload( const std::vector<EnigmaWC::ID>& aIDs )
+{
+  // End an earlier preload.  Meshes it decoded but did not copy into the
+  // mesh store are decoded again if still needed.
+
+  StopPreload();
+  iPreloadIDs.clear();
+
+  for ( EnigmaWC::ID ID : aIDs )
+  {
+    guint Index = (guint)ID;
+
+    if (( Index < size() )
+     && ( KMeshNames[ Index ] != NULL )
+     && ( !at( Index ).iInitialized ))
+    {
+      iPreloadIDs.push_back( Index );
+    }
+  }
+
+  iDecoded.assign( iPreloadIDs.size(), CMesh() );
+  iDecodedTotal  = 0;
+  iUploadedTotal = 0;
+  iPreloadStop   = false;
+  iPreloadStart  = g_get_monotonic_time();
+
+  if ( !iPreloadIDs.empty() )
+    iPreloadThread = std::thread( &CMeshList::DecodeMeshes, this );
+
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This private method is run by the preload thread.  Each mesh is *
+//* decoded in turn, then handed to the rendering thread.           *
+//*-----------------------------------------------------------------*
+
+void CMeshList::DecodeMeshes()
+{
+  for ( gsize Entry = 0; Entry < iPreloadIDs.size(); ++ Entry )
+  {
+    if ( iPreloadStop )
+      break;
+
+    Decode( (EnigmaWC::ID)iPreloadIDs[ Entry ], iDecoded[ Entry ] );
+    iDecodedTotal = Entry + 1;
+  }
+
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This private method stops a preload thread and waits for it to   *
+//* end.  Meshes it has not yet decoded are no longer preloaded, and *
+//* will be loaded when first drawn.                                 *
+//*------------------------------------------------------------------*
+
+void CMeshList::StopPreload()
+{
+  iPreloadStop = true;
+
+  if ( iPreloadThread.joinable() )
+    iPreloadThread.join();
+
+  iPreloadIDs.resize( iDecodedTotal );
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This method copies preloaded meshes into the mesh store, for a   *
+//* limited time so a frame is not delayed.  The OpenGL context must *
+//* be current.  The time taken to preload all meshes is reported as *
+//* a debug message when the last mesh has been copied.              *
+//*------------------------------------------------------------------*
+//* RETURN: TRUE if meshes remain to be copied.                      *
+//*------------------------------------------------------------------*
+
+gboolean CMeshList::Upload()
+{
+  gint64 Start = g_get_monotonic_time();
+  gsize Total  = iDecodedTotal;
+
+  while ( iUploadedTotal < Total )
+  {
+    // A mesh already drawn was loaded by Load(), which may have taken the
+    // decoded mesh.
+
+    guint Index = iPreloadIDs[ iUploadedTotal ];
+
+    if ( !at( Index ).iInitialized )
+      Load( Index );
+
+    iDecoded[ iUploadedTotal ] = CMesh();
+    ++ iUploadedTotal;
+
+    if ( g_get_monotonic_time() - Start >= KUploadTime )
+      break;
+  }
+
+  if ( iUploadedTotal < iPreloadIDs.size() )
+    return TRUE;
+
+  // All meshes have been copied, so the finished thread can be ended.
+
+  if ( iPreloadThread.joinable() )
+    iPreloadThread.join();
+
+  if ( iPreloadStart != 0 )
+  {
+    g_debug( "Preloaded %" G_GSIZE_FORMAT " image meshes in %.1f ms",
+             iPreloadIDs.size(),
+             ( g_get_monotonic_time() - iPreloadStart ) / 1000.0 );
+
+    iPreloadStart = 0;
+  }
+
+  return FALSE;
+}
+
+//*-----------------------------------------------------------------*
+//* This method decodes both states of an image mesh from resource  *
+//* data.  It may be called by any thread.                          *
+//*-----------------------------------------------------------------*
+//* aID:   Object ID.                                               *
+//* aMesh: Image mesh to be filled.                                 *
+//*-----------------------------------------------------------------*
+
+void CMeshList::Decode( EnigmaWC::ID aID, CMesh& aMesh )
+{
+  guint Index = (guint)aID;
+
+  if (( Index < (guint)EnigmaWC::ID::TOTAL )
+   && ( KMeshNames[ Index ] != NULL ))
+  {
+    CResources Resources;
+    Resources.LoadImageMesh( aMesh, KMeshNames[ Index ] );
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method copies an image mesh into the mesh store. *
+//* A mesh decoded by the preload thread is used if available,    *
+//* otherwise the mesh is decoded now.                            *
+//*---------------------------------------------------------------*
+//* aIndex: Index of image mesh.                                  *
+//*---------------------------------------------------------------*
+
+void CMeshList::Load( guint aIndex )
+{
+  CMesh& Mesh = at( aIndex );
+  gsize Total = iDecodedTotal;
+  gsize Entry;
+
+  for ( Entry = iUploadedTotal; Entry < Total; ++ Entry )
+  {
+    if ( iPreloadIDs[ Entry ] == aIndex )
+      break;
+  }
+
+  if ( Entry < Total )
+  {
+    Mesh.iInactive = std::move( iDecoded[ Entry ].iInactive );
+    Mesh.iActive   = std::move( iDecoded[ Entry ].iActive );
+  }
+  else
+    Decode( (EnigmaWC::ID)aIndex, Mesh );
+
+  // Copy both states of the mesh into the mesh store.
+
+  Store( Mesh.iInactive );
+  Store( Mesh.iActive );
+  Mesh.iInitialized = true;
+  return;
+}
+
 //*---------------------------------------------------------*
 //* This method renders an object image as a triangle mesh. *
 //*---------------------------------------------------------*
@@ -388,13 +716,160 @@ CMeshList::CMeshList()
 
 void CMeshList::Render( const CMapObject& aObject,
                         const CMapPlayer& aViewer )
+{
+  Enigma::Matrix4 Transform;
+  const CMesh::CState* State = Prepare( aObject, aViewer, Transform );
+
+  if ( State == NULL )
+    return;
+
+  // Pass the transformation matrix to the mTransform attribute.  Its
+  // attribute arrays are disabled, so all vertices use the same matrix.
+
+  for ( GLuint Column = 0; Column < 4; ++ Column )
+  {
+    glVertexAttrib4fv( ivTransform + Column,
+                       Transform.array() + ( 4 * Column ));
+  }
+
+  Draw( aObject.iID, *State, 1 );
+  return;
+}
+
+//*----------------------------------------------------------------*
+//* This method queues an object image to be rendered by Flush().  *
+//* Objects sharing a mesh and state are drawn together as         *
+//* instances of one mesh, which needs far fewer OpenGL calls than *
+//* rendering each object.                                         *
+//*----------------------------------------------------------------*
+//* aObject: Object being viewed.                                  *
+//* aViewer: Player viewing the object.                            *
+//*----------------------------------------------------------------*
+
+void CMeshList::Queue( const CMapObject& aObject,
+                       const CMapPlayer& aViewer )
+{
+  Enigma::Matrix4 Transform;
+
+  if ( Prepare( aObject, aViewer, Transform ) == NULL )
+    return;
+
+  // Append the object's transformation matrix to the batch for its mesh
+  // and state.  Batches are later drawn in the order they were started,
+  // so the closest objects still tend to be drawn first.
+
+  guint Batch = ( (guint)aObject.iID * 2 )
+              + ( aObject.iState.GetState() ? 1 : 0 );
+
+  if ( iBatches[ Batch ].empty() )
+    iBatchOrder.push_back( Batch );
+
+  iBatches[ Batch ].insert( iBatches[ Batch ].end(),
+                            Transform.array(),
+                            Transform.array() + KMatrixSize );
+  return;
+}
+
+//*----------------------------------------------------------------*
+//* This method renders all objects queued by Queue(), drawing all *
+//* instances of each mesh and state with one OpenGL draw call.    *
+//*----------------------------------------------------------------*
+
+void CMeshList::Flush()
+{
+  if ( iBatchOrder.empty() )
+    return;
+
+  // Copy the transformation matrices of all batches into the instance
+  // buffer.  The previous buffer contents are discarded, so OpenGL need
+  // not wait for the last frame to be drawn before replacing them.
+
+  gsize Total = 0;
+
+  for ( guint Batch : iBatchOrder )
+    Total += iBatches[ Batch ].size();
+
+  glBindBuffer( GL_ARRAY_BUFFER, iInstanceBO );
+
+  glBufferData( GL_ARRAY_BUFFER,
+                Total * sizeof( GLfloat ),
+                NULL,
+                GL_STREAM_DRAW );
+
+  gsize Offset = 0;
+
+  for ( guint Batch : iBatchOrder )
+  {
+    glBufferSubData( GL_ARRAY_BUFFER,
+                     Offset * sizeof( GLfloat ),
+                     iBatches[ Batch ].size() * sizeof( GLfloat ),
+                     iBatches[ Batch ].data() );
+
+    Offset += iBatches[ Batch ].size();
+  }
+
+  // Draw each batch, with the mTransform attribute advancing once per
+  // instance through the batch's matrices.  The instance buffer remains
+  // bound, since the meshes are drawn from the mesh store.
+
+  for ( GLuint Column = 0; Column < 4; ++ Column )
+    glEnableVertexAttribArray( ivTransform + Column );
+
+  Offset = 0;
+
+  for ( guint Batch : iBatchOrder )
+  {
+    guint Index = Batch / 2;
+    const CMesh::CState& State = ( Batch & 1 ) ? at( Index ).iActive
+                                               : at( Index ).iInactive;
+
+    for ( GLuint Column = 0; Column < 4; ++ Column )
+    {
+      glVertexAttribPointer( ivTransform + Column,
+                             4,
+                             GL_FLOAT,
+                             GL_FALSE,
+                             KMatrixSize * sizeof( GLfloat ),
+                             (const GLvoid*)(( Offset + ( 4 * Column ))
+                                             * sizeof( GLfloat )));
+    }
+
+    Draw( (EnigmaWC::ID)Index,
+          State,
+          iBatches[ Batch ].size() / KMatrixSize );
+
+    Offset += iBatches[ Batch ].size();
+    iBatches[ Batch ].clear();
+  }
+
+  for ( GLuint Column = 0; Column < 4; ++ Column )
+    glDisableVertexAttribArray( ivTransform + Column );
+
+  iBatchOrder.clear();
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This private method prepares an object image for rendering.     *
+//* The object's meshes are loaded if necessary, and the object's   *
+//* transformation matrix is found.                                 *
+//*-----------------------------------------------------------------*
+//* aObject:    Object being viewed.                                *
+//* aViewer:    Player viewing the object.                          *
+//* aTransform: Receives the object's transformation matrix.        *
+//* RETURN:     Mesh data to be drawn, or NULL if nothing is drawn. *
+//*-----------------------------------------------------------------*
+
+const CMesh::CState* CMeshList::Prepare( const CMapObject& aObject,
+                                         const CMapPlayer& aViewer,
+                                         Enigma::Matrix4& aTransform )
 {
   // Exit immediately if the object is not visible or present.
   
   if ( !aObject.iVisibility.GetState()
     || !aObject.iPresence.GetState() )
   {
-    return;
+    return NULL;
   }
     
   // Exit immediately if the object ID exceeds the mesh and mesh name
@@ -403,89 +878,36 @@ void CMeshList::Render( const CMapObject& aObject,
   guint Index = (guint)aObject.iID;
 
   if ( Index >= size() )
-    return;
+    return NULL;
 
   // Exit immediately if the mesh name is NULL (object has no mesh).
   
   if ( KMeshNames[ Index ] == NULL )
-    return;
+    return NULL;
 
-	// Initialize object meshes if necessary.
+	// Load object meshes if they have not been preloaded.
 
 	if ( !at( Index ).iInitialized )
-	{
-		// Load inactive and active object mesh data from resources.
-		
-		CResources Resources;
-    Resources.LoadImageMesh( at( Index ), KMeshNames[ Index ] );
-		
-		if ( at( Index ).iInactive.iVertices.size() != 0 )
-		{
-			// Create server-side buffer object to contain vertex positions,
-			// and copy the client-side data to this buffer. 
+		Load( Index );
 
-			glGenBuffers(1, &at( Index ).iInactive.iPositionBO);
-			glBindBuffer(GL_ARRAY_BUFFER, at( Index ).iInactive.iPositionBO);
-		
-			glBufferData(GL_ARRAY_BUFFER,
-				           at( Index ).iInactive.iVertices.size() * sizeof(GL_FLOAT),
-				           at( Index ).iInactive.iVertices.data(),
-				           GL_STATIC_DRAW);
-		
-			at( Index ).iInactive.iVertices.clear();
-		}
-		
-		if ( at( Index ).iInactive.iColours.size() != 0 )
-		{
-			glGenBuffers(1, &at( Index ).iInactive.iColourBO);
-			glBindBuffer(GL_ARRAY_BUFFER, at( Index ).iInactive.iColourBO);
-	
-			glBufferData(GL_ARRAY_BUFFER,
-	    		         at( Index ).iInactive.iColours.size() * sizeof(GL_FLOAT),
-	    		         at( Index ).iInactive.iColours.data(),
-	    		         GL_STATIC_DRAW);
-		
-			at( Index ).iInactive.iColours.clear();
-		}
-		
-		if ( at( Index ).iActive.iVertices.size() != 0 )
-		{
-			// Create server-side buffer object to contain vertex positions,
-			// and copy the client-side data to this buffer. 
+	// Find the viewer matrix again if the viewer has moved since the last
+	// object was prepared, which is usually once for each frame.
 
-			glGenBuffers(1, &at( Index ).iActive.iPositionBO);
-			glBindBuffer(GL_ARRAY_BUFFER, at( Index ).iActive.iPositionBO);
-		
-			glBufferData(GL_ARRAY_BUFFER,
-				           at( Index ).iActive.iVertices.size() * sizeof(GL_FLOAT),
-				           at( Index ).iActive.iVertices.data(),
-				           GL_STATIC_DRAW);
-				           
-			at( Index ).iActive.iVertices.clear();
-		}
-		
-		if ( at( Index ).iActive.iColours.size() != 0 )
-		{
-			glGenBuffers(1, &at( Index ).iActive.iColourBO);
-			glBindBuffer(GL_ARRAY_BUFFER, at( Index ).iActive.iColourBO);
-	
-			glBufferData(GL_ARRAY_BUFFER,
-	    		         at( Index ).iActive.iColours.size() * sizeof(GL_FLOAT),
-	    		         at( Index ).iActive.iColours.data(),
-	    		         GL_STATIC_DRAW);
-		
-			at( Index ).iActive.iColours.clear();
-		}
-		
-		// Set flag to indicate object meshes have been initialized.
-		
-		at( Index ).iInitialized = true;
+	if (( !iViewerValid )
+	 || ( aViewer.iSurface != iViewerSurface )
+	 || ( aViewer.iRotation != iViewerRotation )
+	 || ( aViewer.iOffset.iRotateNorth != iViewerRotateNorth )
+	 || ( aViewer.iOffset.iRotateAbove != iViewerRotateAbove )
+	 || ( aViewer.iOffset.iRotateEast != iViewerRotateEast ))
+	{
+		SetViewer( aViewer );
 	}
 
-	glEnable(GL_CULL_FACE);
+	// Objects that move within their room are transformed by a matrix
+	// before being oriented on their surface.
 
 	Enigma::Matrix4 matrix;
-	matrix.identity();  
+	gboolean Moving = FALSE;
 
   GLfloat TranslateX;
   GLfloat TranslateY;
@@ -493,12 +915,9 @@ void CMeshList::Render( const CMapObject& aObject,
   
   GLfloat RotateX;
   GLfloat RotateY;
-  GLfloat RotateZ;
   
   int ObjectSurface  = (int)aObject.iSurface;
   int ObjectRotation = (int)aObject.iRotation;
-  int ViewerSurface  = (int)aViewer.iSurface;
-  int ViewerRotation = (int)aViewer.iRotation;
 
 	// Translate the object within model space.  SkyObjects remain in a fixed
   // location around the viewer.
@@ -548,7 +967,7 @@ void CMeshList::Render( const CMapObject& aObject,
       && ( PlayerZ > -KPlayerLimit )
       && ( PlayerZ < KPlayerLimit ))
     {
-      return;
+      return NULL;
     }
   }
   else if ( aObject.iID == EnigmaWC::ID::EWallEyes )
@@ -557,6 +976,8 @@ void CMeshList::Render( const CMapObject& aObject,
     // Translate the image mesh so the eyes are centered in the X-Y plane
     // before being rotated.
  
+    matrix.identity();
+    Moving = TRUE;
     matrix.translate(-KWallEyesOffsetX, -KWallEyesOffsetY, -KWallEyesOffsetZ);
 
     // Transform the translation values into those for a WallEyes in the
@@ -622,13 +1043,15 @@ void CMeshList::Render( const CMapObject& aObject,
       || ( DeltaY > KLightBeamWidth )
       || ( DeltaY < -KLightBeamWidth ))
     {
-      return;
+      return NULL;
     }
   }
   else if ( aObject.iID == EnigmaWC::ID::EFish )
   {
     // Apply a small rotation around the center of a Fish object.
   
+    matrix.identity();
+    Moving = TRUE;
   	matrix.translate(-KFishOffsetX, -KFishOffsetY, 0);
     matrix.rotate_z((GLfloat)iFishTurn);
     matrix.translate(KFishOffsetX, KFishOffsetY, 0);
@@ -637,99 +1060,296 @@ void CMeshList::Render( const CMapObject& aObject,
   
     matrix.rotate_z((GLfloat)iFishSwim);
   }
-  else if ( aObject.iID == EnigmaWC::ID::EWaterLayer )
-  {    
-    // Disable back-face culling for the WaterLayer so the underside will be
-    // visible when the player is under it.
 
-    glDisable(GL_CULL_FACE);
+	// All object meshes are drawn centered at the origin (0, 0, 0) on the
+  // model space X-Y plane, rising up along the positive Z axis.  The object
+  // is oriented on its surface, translated to its location, then viewed
+  // by the viewer.  Orienting only selects columns of the viewer matrix,
+  // with the translation added to its last column.
+
+  const COrientation& Orientation =
+    KOrientations.iOrientations[ ObjectSurface ][ ObjectRotation ];
+
+  const GLfloat* Viewer = iViewer.array();
+  GLfloat* Element      = aTransform.array();
+
+  for ( gint Column = 0; Column < 3; ++ Column )
+  {
+    const GLfloat* Source = Viewer + ( Orientation.iRows[ Column ] * 4 );
+    GLfloat Sign          = Orientation.iSigns[ Column ];
+
+    for ( gint Row = 0; Row < 4; ++ Row )
+      Element[ ( Column * 4 ) + Row ] = Source[ Row ] * Sign;
   }
 
-	// All object meshes are drawn centered at the origin (0, 0, 0) on the
-  // model space X-Y plane, rising up along the positive Z axis.  Rotate
-  // the view so the object will be oriented properly on its surface.
-  
-  RotateZ = (GLfloat)KObjectRotateZ[ ObjectSurface ][ ObjectRotation ] * 90;
-  matrix.rotate_z(RotateZ);
-  
-  // Rotate the view so the object is on its surface.  The object will
-  // appear as it should to a viewer on the Below surface facing North.
-  
-  RotateX = (GLfloat)KObjectRotateX[ ObjectSurface ] * 90;
-  RotateY = (GLfloat)KObjectRotateY[ ObjectSurface ] * 90;
+  for ( gint Row = 0; Row < 4; ++ Row )
+  {
+    Element[ 12 + Row ] = ( Viewer[ Row ] * TranslateX )
+                        + ( Viewer[ 4 + Row ] * TranslateY )
+                        + ( Viewer[ 8 + Row ] * TranslateZ )
+                        + Viewer[ 12 + Row ];
+  }
 
-  matrix.rotate_y(RotateY);          
-  matrix.rotate_x(RotateX);
+  // Apply the movement of a moving object first.
 
-	// Apply all transations.
- 	
- 	matrix.translate(TranslateX, TranslateY, TranslateZ);
+  if ( Moving )
+  {
+    matrix.multiply( aTransform );
+    aTransform = matrix;
+  }
+
+  // The object is now positioned properly in the viewer's space.
+  // Choose object mesh data based on the object's state.
+
+	const CMesh::CState* State;
+
+	if ( aObject.iState.GetState() )
+		State = &at( Index ).iActive;
+	else
+		State = &at( Index ).iInactive;
+
+	if ( State->iTotal == 0 )
+		return NULL;
 
-	// Rotate the translated view of the object so it appears correctly
-  // to a viewer from the viewer's surface.
+	return State;
+}
+
+//*-------------------------------------------------------------*
+//* This private method finds the viewer matrix, which rotates  *
+//* model space so objects appear as seen from the viewer's     *
+//* surface and rotation, including any partial rotation of the *
+//* viewer during a view transition.                            *
+//*-------------------------------------------------------------*
+//* aViewer: Player viewing objects.                            *
+//*-------------------------------------------------------------*
 
-  RotateX = (GLfloat)KViewerRotateX[ ViewerSurface ] * -90;
-  RotateY = (GLfloat)KViewerRotateY[ ViewerSurface ][ ViewerRotation ] * -90;
-  RotateZ = (GLfloat)KViewerRotateZ[ ViewerSurface ] * -90;
+void CMeshList::SetViewer( const CMapPlayer& aViewer )
+{
+  int ViewerSurface  = (int)aViewer.iSurface;
+  int ViewerRotation = (int)aViewer.iRotation;
 
-  matrix.rotate_x(RotateX);
-  matrix.rotate_z(RotateZ);
-  matrix.rotate_y(RotateY);   
+  iViewer.identity();
+
+  // Rotate the view so objects appear correctly to a viewer from the
+  // viewer's surface.
+
+  iViewer.rotate_x( (GLfloat)KViewerRotateX[ ViewerSurface ] * -90 );
+  iViewer.rotate_z( (GLfloat)KViewerRotateZ[ ViewerSurface ] * -90 );
+
+  iViewer.rotate_y(
+    (GLfloat)KViewerRotateY[ ViewerSurface ][ ViewerRotation ] * -90 );
 
   // Apply player fine rotation offset.
 
-  matrix.rotate_z((GLfloat)aViewer.iOffset.iRotateNorth * 90);
-  matrix.rotate_y((GLfloat)aViewer.iOffset.iRotateAbove * -90); 
-  matrix.rotate_x((GLfloat)aViewer.iOffset.iRotateEast * -90);
+  iViewer.rotate_z( (GLfloat)aViewer.iOffset.iRotateNorth * 90 );
+  iViewer.rotate_y( (GLfloat)aViewer.iOffset.iRotateAbove * -90 );
+  iViewer.rotate_x( (GLfloat)aViewer.iOffset.iRotateEast * -90 );
 
-	// Move camera slightly away from viewer.
+  // Move camera slightly away from viewer.
 
-  matrix.translate(0, 0, CAMERA_OFFSET);
- 	
-  // Pass the transformation matrix to the mTransform uniform.
+  iViewer.translate( 0, 0, CAMERA_OFFSET );
 
-	glUniformMatrix4fv(imTransform, 1, GL_FALSE, matrix.array());
-  
-  // The object is now positioned properly in the viewer's space.
-  // Choose object mesh data based on the object's state.
+  iViewerSurface     = aViewer.iSurface;
+  iViewerRotation    = aViewer.iRotation;
+  iViewerRotateNorth = aViewer.iOffset.iRotateNorth;
+  iViewerRotateAbove = aViewer.iOffset.iRotateAbove;
+  iViewerRotateEast  = aViewer.iOffset.iRotateEast;
+  iViewerValid       = TRUE;
+  return;
+}
 
-	GLuint PositionBO = 0;
-	GLuint ColourBO   = 0;
+//*---------------------------------------------------------------*
+//* This private method draws instances of an object image mesh.  *
+//* The mTransform attribute must already hold the transformation *
+//* matrix of each instance.                                      *
+//*---------------------------------------------------------------*
+//* aID:        Object ID.                                        *
+//* aState:     Mesh data to be drawn.                            *
+//* aInstances: Number of instances.                              *
+//*---------------------------------------------------------------*
+
+void CMeshList::Draw( EnigmaWC::ID aID,
+                      const CMesh::CState& aState,
+                      GLsizei aInstances )
+{
+	// Disable back-face culling for the WaterLayer so the underside will be
+	// visible when the player is under it.
 
-	if ( aObject.iState.GetState() )
+	if ( aID == EnigmaWC::ID::EWaterLayer )
+		glDisable(GL_CULL_FACE);
+	else
+		glEnable(GL_CULL_FACE);
+
+	// Draw the mesh.
+
+	const GLvoid* Indices = (const GLvoid*)(aState.iIndex * sizeof(GLushort));
+
+	if ( aInstances == 1 )
 	{
-		PositionBO = at( Index ).iActive.iPositionBO;
-		ColourBO   = at( Index ).iActive.iColourBO;
+		glDrawElementsBaseVertex(GL_TRIANGLES,
+		                         aState.iTotal,
+		                         GL_UNSIGNED_SHORT,
+		                         Indices,
+		                         aState.iFirst);
 	}
 	else
 	{
-		PositionBO = at( Index ).iInactive.iPositionBO;
-		ColourBO   = at( Index ).iInactive.iColourBO;
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+		                                  aState.iTotal,
+		                                  GL_UNSIGNED_SHORT,
+		                                  Indices,
+		                                  aInstances,
+		                                  aState.iFirst);
 	}
 
-	if (( PositionBO != 0 ) && ( ColourBO != 0 ))
+	return;
+}
+
+//*------------------------------------------------------------------*
+//* This private method copies the vertex data of a mesh state into  *
+//* the mesh store, which holds the vertices and triangle indices of *
+//* all meshes in two buffer objects.  The position and colour of    *
+//* each vertex are interleaved.  The mesh store is enlarged if it   *
+//* has too little room, so all meshes are still drawn without       *
+//* binding other buffer objects.                                    *
+//*------------------------------------------------------------------*
+//* aState: Mesh data to be stored.  Its vertex data is cleared.     *
+//*------------------------------------------------------------------*
+
+void CMeshList::Store( CMesh::CState& aState )
+{
+	GLsizei Vertices = aState.iPositions.size() / 3;
+	GLsizei Indices  = aState.iIndices.size();
+
+	// A mesh state is only drawn if every vertex has a position and colour.
+
+	if (( Indices != 0 )
+	 && ( aState.iColours.size() == (gsize)Vertices * 4 ))
 	{
-		// Attach vertex position buffer to the vPosition vertex attribute.
+		if ( Reserve( iStoreBO, iStoreCapacity, iStoreSize + Vertices,
+		              KVertexSize ))
+		{
+			// Attach the new vertex buffer object to the vPosition and vColour
+			// attributes.  Positions are fixed-point values, which the vertex
+			// shader scales.
+
+			glBindBuffer(GL_ARRAY_BUFFER, iStoreBO);
+
+			glVertexAttribPointer(ivPosition,
+			                      3,
+			                      GL_SHORT,
+			                      GL_FALSE,
+			                      KVertexSize,
+			                      (const GLvoid*)0);
+
+			glVertexAttribPointer(ivColour,
+			                      4,
+			                      GL_UNSIGNED_BYTE,
+			                      GL_TRUE,
+			                      KVertexSize,
+			                      (const GLvoid*)(4 * sizeof(GLshort)));
+		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, PositionBO);
-		glVertexAttribPointer(ivPosition, 3, GL_FLOAT, GL_FALSE, 0, 0);
-				
-		// Calculate the total number of vertices to be rendered.
-		
-		GLint total;
+		if ( Reserve( iIndexBO, iIndexCapacity, iIndexSize + Indices,
+		              sizeof(GLushort) ))
+		{
+			// Attach the new index buffer object to the vertex array object.
 
-		glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &total);
-		total = total / (sizeof(GL_FLOAT) * 3);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iIndexBO);
+		}
 
-		// Attach vertex colour buffer to the vColour vertex attribute.
-		
-		glBindBuffer(GL_ARRAY_BUFFER, ColourBO);
-		glVertexAttribPointer(ivColour, 4, GL_FLOAT, GL_FALSE, 0, 0);
-		
-		// Draw the mesh.
-		
-		glDrawArrays(GL_TRIANGLES, 0, total);
+		// Interleave the vertex positions and colours, then copy them and
+		// the triangle indices to the end of the mesh store.  Each position
+		// is padded to four values, keeping the colours aligned.
+
+		std::vector<GLubyte> Data( Vertices * KVertexSize );
+		GLubyte* Vertex = Data.data();
+
+		for ( GLsizei Index = 0; Index < Vertices; ++ Index )
+		{
+			GLshort Position[ 4 ] = { aState.iPositions[ ( Index * 3 ) + 0 ],
+			                          aState.iPositions[ ( Index * 3 ) + 1 ],
+			                          aState.iPositions[ ( Index * 3 ) + 2 ],
+			                          0 };
+
+			memcpy( Vertex, Position, sizeof( Position ));
+			memcpy( Vertex + sizeof( Position ), &aState.iColours[ Index * 4 ], 4 );
+			Vertex += KVertexSize;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, iStoreBO);
+
+		glBufferSubData(GL_ARRAY_BUFFER,
+		                iStoreSize * KVertexSize,
+		                Data.size(),
+		                Data.data());
+
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+		                iIndexSize * sizeof(GLushort),
+		                Indices * sizeof(GLushort),
+		                aState.iIndices.data());
+
+		aState.iFirst = iStoreSize;
+		aState.iIndex = iIndexSize;
+		aState.iTotal = Indices;
+		iStoreSize   += Vertices;
+		iIndexSize   += Indices;
+	}
+
+	aState.iPositions.clear();
+	aState.iColours.clear();
+	aState.iIndices.clear();
+	return;
+}
+
+//*--------------------------------------------------------------------*
+//* This private method ensures a buffer object of the mesh store has  *
+//* room for a number of elements.  A larger buffer object is created  *
+//* if necessary, with the contents of the old one copied into it.     *
+//* This rarely happens, since the capacity doubles.                   *
+//*--------------------------------------------------------------------*
+//* aBO:       Buffer object, which may be replaced.                   *
+//* aCapacity: Element capacity of buffer object, which is updated.    *
+//* aSize:     Number of elements needed.                              *
+//* aUnit:     Size of an element in bytes.                            *
+//* RETURN:    TRUE if the buffer object was replaced.                 *
+//*--------------------------------------------------------------------*
+
+gboolean CMeshList::Reserve( GLuint& aBO,
+                             GLsizei& aCapacity,
+                             GLsizei aSize,
+                             GLsizei aUnit )
+{
+	if ( aSize <= aCapacity )
+		return FALSE;
+
+	GLsizei Capacity = MAX( aCapacity * 2, KStoreCapacity );
+
+	while ( Capacity < aSize )
+		Capacity *= 2;
+
+	GLuint BO;
+
+	glGenBuffers(1, &BO);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, BO);
+	glBufferData(GL_COPY_WRITE_BUFFER, Capacity * aUnit, NULL, GL_STATIC_DRAW);
+
+	if ( aBO != 0 )
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, aBO);
+
+		glCopyBufferSubData(GL_COPY_READ_BUFFER,
+		                    GL_COPY_WRITE_BUFFER,
+		                    0,
+		                    0,
+		                    aCapacity * aUnit);
+
+		glDeleteBuffers(1, &aBO);
 	}
+
+	aBO       = BO;
+	aCapacity = Capacity;
+	return TRUE;
 }
 
 //*--------------------------------------------*
@@ -882,7 +1502,7 @@ void CMeshList::Initialize()
 	
 	ivPosition   = glGetAttribLocation(program, "vPosition");
 	ivColour     = glGetAttribLocation(program, "vColour");
-	imTransform  = glGetUniformLocation(program, "mTransform");
+	ivTransform  = glGetAttribLocation(program, "mTransform");
 	
 	// Unbind and delete the shaders since they are no longer needed
 	// once the program has been linked.
@@ -903,6 +1523,17 @@ void CMeshList::Initialize()
 	
 	glEnableVertexAttribArray(ivPosition);
 	glEnableVertexAttribArray(ivColour);
+
+	// The mTransform attribute occupies one location for each matrix column.
+	// Its attribute arrays are only enabled when drawing queued objects, and
+	// advance once per instance.
+
+	for ( GLuint Column = 0; Column < 4; ++ Column )
+		glVertexAttribDivisor(ivTransform + Column, 1);
+
+	// Create a buffer object to stream instance transformation matrices.
+
+	glGenBuffers(1, &iInstanceBO);
 	
 	// Set a perspective projection matrix.  This remains constant
 	// for all rendering.
@@ -918,4 +1549,9 @@ void CMeshList::Initialize()
 	                NEAR_CLIP, FAR_CLIP);
 
 	glUniformMatrix4fv(mProjection, 1, GL_FALSE, matrix.array());
+
+	// Set the size of a unit of the fixed-point vertex positions.
+
+	GLint fPositionUnit = glGetUniformLocation(program, "fPositionUnit");
+	glUniform1f(fPositionUnit, 1.0f / KMeshPositionUnits);
 }
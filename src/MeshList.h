@@ -20,8 +20,11 @@
 #ifndef __MESHLIST_H__
 #define __MESHLIST_H__
 
+#include <atomic>
+#include <thread>
 #include "MapPlayer.h"
 #include <GL/gl.h>
+#include "Matrix4.h"
 #include "Mesh.h"
 
 class CMeshList : public std::vector<CMesh>
@@ -30,26 +33,96 @@ class CMeshList : public std::vector<CMesh>
     // Public methods.
 
     CMeshList();
+    ~CMeshList();
 
     void Render( const CMapObject& aObject,
                  const CMapPlayer& aViewer );
-                 
+
+    void Queue( const CMapObject& aObject,
+                const CMapPlayer& aViewer );
+
+    void Flush();
     void Animate();   
     void Initialize();
+    void Preload( const std::vector<EnigmaWC::ID>& aIDs );
+    gboolean Upload();
+    static void Decode( EnigmaWC::ID aID, CMesh& aMesh );
                  
   private:
+    // Private methods.
+
+    const CMesh::CState* Prepare( const CMapObject& aObject,
+                                  const CMapPlayer& aViewer,
+                                  Enigma::Matrix4& aTransform );
+
+    void SetViewer( const CMapPlayer& aViewer );
+
+    void Draw( EnigmaWC::ID aID,
+               const CMesh::CState& aState,
+               GLsizei aInstances );
+
+    void Load( guint aIndex );
+    void DecodeMeshes();
+    void StopPreload();
+    void Store( CMesh::CState& aState );
+
+    gboolean Reserve( GLuint& aBO,
+                      GLsizei& aCapacity,
+                      GLsizei aSize,
+                      GLsizei aUnit );
+
     // Private data.
 
     int iFishSwim;                // Fish swimming around viewer.
     int iFishTurn;                // Fish turning in place.
     int iFishState;               // Fish movement state.
+
+    // Viewer matrix, and the viewer orientation it was found for.
+
+    Enigma::Matrix4 iViewer;                 // Viewer matrix.
+    EnigmaWC::Direction iViewerSurface;      // Viewer surface.
+    EnigmaWC::Direction iViewerRotation;     // Viewer rotation.
+    gfloat iViewerRotateNorth;               // Viewer fine rotations.
+    gfloat iViewerRotateAbove;
+    gfloat iViewerRotateEast;
+    gboolean iViewerValid;                   // TRUE if iViewer was found.
     
 		// Vertex shader attribute and uniform locations.  These will be initialized
 		// after the shader program has been compiled and linked.
 
 		GLint ivPosition;
 		GLint ivColour;
-		GLint imTransform;
+		GLint ivTransform;
+
+    // Transformation matrices of queued objects, with a batch for each state
+    // of each image mesh.  Batches keep their capacity between frames.
+
+    std::vector<std::vector<GLfloat>> iBatches;
+    std::vector<guint> iBatchOrder;    // Batches in the order started.
+    GLuint iInstanceBO;                // Instance matrix buffer object.
+
+    // Vertices and triangle indices of all loaded meshes are kept in two
+    // buffer objects, the mesh store, so drawing any mesh only needs its
+    // range of indices.
+
+    GLuint iStoreBO;                   // Mesh store vertex buffer object.
+    GLsizei iStoreSize;                // Vertices in mesh store.
+    GLsizei iStoreCapacity;            // Vertex capacity of mesh store.
+    GLuint iIndexBO;                   // Mesh store index buffer object.
+    GLsizei iIndexSize;                // Indices in mesh store.
+    GLsizei iIndexCapacity;            // Index capacity of mesh store.
+
+    // Meshes of a game map are decoded by a preload thread, then copied into
+    // the mesh store a few at a time.  Decoded meshes before iDecodedTotal
+    // belong to the rendering thread.
+
+    std::vector<guint> iPreloadIDs;      // Mesh IDs being preloaded.
+    std::vector<CMesh> iDecoded;         // Decoded meshes, in the same order.
+    std::atomic<gsize> iDecodedTotal;    // Meshes decoded.
+    gsize iUploadedTotal;                // Decoded meshes handled.
+    std::atomic<bool> iPreloadStop;      // TRUE if decoding must stop.
+    std::thread iPreloadThread;          // Thread decoding meshes.
+    gint64 iPreloadStart;                // Preload start time, or 0.
 };
 
 #endif // __MESHLIST_H__
@@ -318,8 +318,9 @@ void CPlayRoom::SetMap( std::shared_ptr<CMap> aMap )
     (*Player).iWater              = FALSE;
     
     iObjects.clear();
+    iMap->Objects().Touch( (*Player).iLocation, 0 );
     iMap->Objects().Read( (*Player).iLocation, iObjects );
-    std::list<std::list<CMapObject>::iterator>::iterator Object;
+    std::list<CMapObjectList::iterator>::iterator Object;
   
     for ( Object = iObjects.begin();
           Object != iObjects.end();
@@ -412,6 +413,7 @@ void CPlayRoom::Prepare()
   // Initialize the list of objects in the player's room.
       
   iObjects.clear();
+  iMap->Objects().Touch( (*iPlayer).iLocation, 0 );
   iMap->Objects().Read( (*iPlayer).iLocation, iObjects );
 
   iTeleporters.clear();
@@ -632,7 +634,7 @@ void CPlayRoom::Explore( CPlayRoom::Action aAction )
 
   gboolean SenseChange = FALSE;
   CSounds::ID SoundID  = CSounds::ID::ENone;
-  std::list<std::list<CMapObject>::iterator>::iterator Object;
+  std::list<CMapObjectList::iterator>::iterator Object;
 
   if ( LocationNext != Location )
   {
@@ -661,12 +663,13 @@ void CPlayRoom::Explore( CPlayRoom::Action aAction )
     
     // Update the player's location variables (local and player copies).
 
-    (*iPlayer).iLocation = LocationNext;
-    Location             = LocationNext;
+    iMap->Players().Move( iPlayer, LocationNext );
+    Location = LocationNext;
  
     // Obtain a list of objects in the new room.
 
     iObjects.clear();
+    iMap->Objects().Touch( Location, 0 );
     iMap->Objects().Read( Location, iObjects );
 
     iTeleporters.clear();
@@ -1797,7 +1800,8 @@ void CPlayRoom::Explore( CPlayRoom::Action aAction )
     // If Stairs are present in the player's next location, find the surface
     // of these stairs.  This allows planning a transition path to avoid them.
 
-    std::list<std::list<CMapObject>::iterator> ObjectsNext;
+    std::list<CMapObjectList::iterator> ObjectsNext;
+    iMap->Objects().Touch( (*iPlayer).iLocationNext, 0 );
     iMap->Objects().Read( (*iPlayer).iLocationNext, ObjectsNext );
       
     for ( Object = ObjectsNext.begin();
@@ -1908,7 +1912,7 @@ void CPlayRoom::UpdateSense( gboolean& aChange, CSounds::ID& aSound )
   aChange = FALSE;
   guint8 Contact;
   
-  std::list<std::list<CMapObject>::iterator>::iterator Object;
+  std::list<CMapObjectList::iterator>::iterator Object;
   
   for ( Object = iObjects.begin();
         Object != iObjects.end();
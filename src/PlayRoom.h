@@ -92,7 +92,7 @@ class CPlayRoom : public sigc::trackable
     
     // Lists of iterators to objects in the source room.
 
-    std::list<std::list<CMapObject>::iterator> iObjects;
+    std::list<CMapObjectList::iterator> iObjects;
     std::list<std::list<CMapTeleporter>::iterator> iTeleporters;
     std::list<std::list<CMapItem>::iterator> iItems;
     std::list<std::list<CMapItem>::iterator> iFoundItems;
@@ -20,6 +20,12 @@
 #include "EnigmaWC.h"
 #include "PlayerView.h"
 
+//*---------------------*
+//* Local declarations. *
+//*---------------------*
+
+#define KUploadInterval 10          // Milliseconds between mesh copying.
+
 //*--------------------------*
 //* C++ default constructor. *
 //*--------------------------*
@@ -313,9 +319,37 @@ void CPlayerView::SetMap( std::shared_ptr<CMap> aMap )
 
   iViewCone.SetMap( aMap );
 	iPlayRoom.SetMap( aMap );
+
+  // Preload the image meshes of the game map, copying them into OpenGL
+  // buffers a few at a time.
+
+  iViewCone.Preload();
+  iUploadConnection.disconnect();
+
+  iUploadConnection = Glib::signal_timeout().connect(
+    sigc::mem_fun( *this, &CPlayerView::On_Upload ),
+    KUploadInterval );
+
 	return;
 }
 
+//*-----------------------------------------------------------------*
+//* This method is called periodically while image meshes are being *
+//* preloaded.  Preloaded meshes are copied into OpenGL buffers     *
+//* once the widget has an OpenGL context.                          *
+//*-----------------------------------------------------------------*
+//* RETURN: TRUE if the method should be called again.              *
+//*-----------------------------------------------------------------*
+
+bool CPlayerView::On_Upload()
+{
+  if ( !get_realized() )
+    return TRUE;
+
+  make_current();
+  return iViewCone.Upload();
+}
+
 //*-------------------------------------------------------------*
 //* This method makes the active player select an item for use. *
 //*-------------------------------------------------------------*
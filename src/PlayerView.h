@@ -75,6 +75,7 @@ class CPlayerView : public Gtk::GLArea //public CGLArea
     void Do_Switch_Player();
     void On_View( guint8 aSelect );
     void On_Orientation( const Glib::ustring& aString );
+    bool On_Upload();
 
     // Private data.
 
@@ -89,6 +90,7 @@ class CPlayerView : public Gtk::GLArea //public CGLArea
     int iTurnRightKey;                      // Turn Right key value.
     int iInventoryKey;                      // Inventory key value.
     int iSwitchPlayerKey;                   // Switch player key value.
+    sigc::connection iUploadConnection;     // Mesh preload connection.
 
     // Signal servers and slots.
 
@@ -17,6 +17,9 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cmath>
+#include <cstring>
+#include <map>
 #include "EnigmaWC.gresource.h"
 #include "Resources.h"
 
@@ -141,6 +144,196 @@ void ReadLine( std::string& aString, guchar** aArray, gsize* aLength )
 	return;
 }
 
+//----------------------------------------------------------------------
+// This private function returns a little-endian 4-byte integer value.
+//----------------------------------------------------------------------
+// aByte:  Pointer to the first byte of the value.
+// RETURN: Integer value.
+//----------------------------------------------------------------------
+
+guint32 ReadInteger( const guint8* aByte )
+{
+	return (*(aByte + 0) 
+	     + (*(aByte + 1) << 8)
+	     + (*(aByte + 2) << 16)
+	     + ((guint32)*(aByte + 3) << 24));
+}
+
+//----------------------------------------------------------------------
+// This private function reads an indexed "msh2" image mesh, which
+// follows the file identifier.
+//----------------------------------------------------------------------
+// aState: Mesh state to be filled.
+// aByte:  Mesh data following the file identifier.
+// aSize:  Size of mesh data.
+//----------------------------------------------------------------------
+
+void ReadIndexedData( CMesh::CState& aState, const guint8* aByte, gsize aSize )
+{
+	// Return immediately if there is too little data for the vertex and
+	// index totals, or for the arrays they describe.  Each vertex uses 10
+	// bytes (3 x 2-byte positions, 4 x 1-byte colours), and each index uses
+	// 2 bytes.
+
+	if (aSize < 8)
+		return;
+
+	guint32 vertex_total = ReadInteger(aByte);
+	guint32 index_total  = ReadInteger(aByte + 4);
+
+	aByte += 8;
+	aSize -= 8;
+
+	if ((vertex_total > G_MAXUINT16 + 1)
+		|| (index_total % 3 != 0)
+		|| (aSize < ((gsize)vertex_total * 10) + ((gsize)index_total * 2)))
+	{
+		return;
+	}
+
+	aState.iPositions.resize(vertex_total * 3);
+
+	for (GLshort& position : aState.iPositions)
+	{
+		position = (GLshort)(*(aByte + 0) + (*(aByte + 1) << 8));
+		aByte   += 2;
+	}
+
+	aState.iColours.assign(aByte, aByte + (vertex_total * 4));
+	aByte += vertex_total * 4;
+
+	aState.iIndices.resize(index_total);
+
+	for (GLushort& index : aState.iIndices)
+	{
+		index  = (GLushort)(*(aByte + 0) + (*(aByte + 1) << 8));
+		aByte += 2;
+
+		// Discard the whole mesh if an index is outside the vertex array.
+
+		if (index >= vertex_total)
+		{
+			aState.iPositions.clear();
+			aState.iColours.clear();
+			aState.iIndices.clear();
+			return;
+		}
+	}
+
+	return;
+}
+
+//----------------------------------------------------------------------
+// This private function reads an original "msh\n" image mesh, which
+// follows the file identifier.  The mesh holds unindexed triangles with
+// float values, which are converted to the values of an indexed mesh.
+// Identical vertices are shared by all triangles using them.
+//----------------------------------------------------------------------
+// aState: Mesh state to be filled.
+// aByte:  Mesh data following the file identifier.
+// aSize:  Size of mesh data.
+//----------------------------------------------------------------------
+
+void ReadTriangleData( CMesh::CState& aState, const guint8* aByte, gsize aSize )
+{
+	// Return immediately if there is too little data for the vertex total,
+	// or for the vertex data.  Each vertex coordinate uses 12 bytes (x,y,z
+	// 3-tuples), and each vertex colour uses 16 bytes (r,g,b,a 4-tuples).
+
+	if (aSize < 4)
+		return;
+
+	guint32 vertex_total = ReadInteger(aByte);
+
+	aByte += 4;
+	aSize -= 4;
+
+	if ((vertex_total % 3 != 0) || (aSize < (gsize)vertex_total * (12 + 16)))
+		return;
+
+	// Declare a structure to convert from GLuint and GLfloat types.
+	
+	union
+	{
+		GLuint gl_integer;
+		GLfloat gl_float;
+	} convert;
+
+	const guint8* coordinates = aByte;
+	const guint8* colours     = aByte + (vertex_total * 12);
+
+	std::map<std::pair<guint64, guint32>, GLushort> vertices;
+	std::pair<guint64, guint32> key;
+	GLshort position[3];
+	GLubyte colour[4];
+
+	aState.iIndices.reserve(vertex_total);
+
+	for (guint32 vertex = 0; vertex < vertex_total; ++ vertex)
+	{
+		// Convert the vertex position to fixed-point values, and the vertex
+		// colour to byte values.
+
+		for (int part = 0; part < 3; ++ part)
+		{
+			convert.gl_integer = ReadInteger(coordinates);
+			coordinates       += 4;
+
+			position[part] =
+				(GLshort)CLAMP(lround(convert.gl_float * KMeshPositionUnits),
+				               G_MININT16,
+				               G_MAXINT16);
+		}
+
+		for (int part = 0; part < 4; ++ part)
+		{
+			convert.gl_integer = ReadInteger(colours);
+			colours           += 4;
+
+			colour[part] = (GLubyte)CLAMP(lround(convert.gl_float * 255), 0, 255);
+		}
+
+		key.first  = ((guint64)(guint16)position[0] << 32)
+		           | ((guint64)(guint16)position[1] << 16)
+		           | (guint64)(guint16)position[2];
+
+		key.second = ReadInteger(colour);
+
+		// Add the vertex if it has not been seen before, then use it for
+		// the triangle.
+
+		std::map<std::pair<guint64, guint32>, GLushort>::iterator found =
+			vertices.find(key);
+
+		if (found == vertices.end())
+		{
+			// Return an empty mesh if there are too many vertices for
+			// 2-byte indices.
+
+			if (vertices.size() > G_MAXUINT16)
+			{
+				aState.iPositions.clear();
+				aState.iColours.clear();
+				aState.iIndices.clear();
+				return;
+			}
+
+			found = vertices.insert(
+				std::make_pair(key, (GLushort)vertices.size())).first;
+
+			aState.iPositions.insert(aState.iPositions.end(),
+			                         position,
+			                         position + 3);
+
+			aState.iColours.insert(aState.iColours.end(), colour, colour + 4);
+		}
+
+		aState.iIndices.push_back((*found).second);
+	}
+
+	return;
+}
+
 //----------------------------------------------------------------------
 // This private function reads image mesh state data from the resources.
 //----------------------------------------------------------------------
@@ -168,96 +361,16 @@ void ReadStateData( CMesh::CState& aState, const std::string& aPath )
 	gsize size;
 	guint8* byte = (guint8*)byte_array->get_data(size);
 	
-	// Return immediately if there is too little remaining data,
-	// or the header ID ("mesh\n") is wrong.
+	// Return immediately if there is too little data for the header ID,
+	// otherwise read the mesh in the format given by its header ID.
 
 	if (size < 4)
 		return;
-	
-	if  ((*(byte + 0) != 'm')
-		|| (*(byte + 1) != 's')
-		|| (*(byte + 2) != 'h')
-		|| (*(byte + 3) != '\n'))
-	{	
-		return;
-	}
-	
-	// Skip over header ID to the vertex total (4 bytes).
-	// Return immediately if there is too little remaining data.
-	
-	byte += 4;
-	size -= 4;
-	
-	if (size < 4)
-		return;
-	
-	int vertex_total = (*(byte + 0) 
-	                 + (*(byte + 1) << 8)
-	                 + (*(byte + 2) << 16)
-	                 + (*(byte + 3) << 24));
-	
-	// Skip over the vertex total to the vertex data (array of 4-byte values).
-	// Return immediately if there is too little remaining data.  Each vertex
-	// coordinate uses 12 bytes (x,y,z 3-tuples), and each vertex colour uses
-	// 16 bytes (r,g,b,a 4-tuples).
-
-	byte += 4;
-	size -= 4;
-		
-	if (size < vertex_total * (12 + 16))
-		return;
-	
-	// Declare a structure to convert from GLuint and GLfloat types.
-	
-	union
-	{
-		GLuint gl_integer;
-		GLfloat gl_float;
-	} convert;
 
-	// Stream resource data into the vertex position buffer.
-	
-	aState.iVertices.reserve(vertex_total * 3);
-	int total = vertex_total * 3;
-	
-	while (total > 0)
-	{
-		// Extract a vertex position stored as a 4-byte OpenGL integer
-		// value, and convert it into an OpenGL floating-point value.
-		
-		convert.gl_integer = (*(byte + 0) 
-                       + (*(byte + 1) << 8)
-                       + (*(byte + 2) << 16)
-                       + (*(byte + 3) << 24));
-		
-		aState.iVertices.push_back(convert.gl_float);
-		//position.emplace_back(convert.gl_float);
-		
-		total -= 1;
-		byte  += 4;
-	}
-	
-	// Stream resource data into the vertex colour buffers.
-	
-	aState.iColours.reserve(vertex_total * 4);
-	total = vertex_total * 4;
-	
-	while (total > 0)
-	{
-		// Extract a vertex colour stored as a 4-byte OpenGL integer
-		// value, and convert it to an OpenGL floating-point value.
-		
-		convert.gl_integer = (*(byte + 0) 
-                       + (*(byte + 1) << 8)
-                       + (*(byte + 2) << 16)
-                       + (*(byte + 3) << 24));
-                      
-		aState.iColours.push_back(convert.gl_float);
-		//colour.emplace_back(convert.gl_float);
-		
-		total -= 1;
-		byte  += 4;
-	}
+	if (memcmp(byte, "msh2", 4) == 0)
+		ReadIndexedData(aState, byte + 4, size - 4);
+	else if (memcmp(byte, "msh\n", 4) == 0)
+		ReadTriangleData(aState, byte + 4, size - 4);
 }
 
 //*------------------------------------------------------------*
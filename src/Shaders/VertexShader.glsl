@@ -3,12 +3,14 @@
 #version 330
 in vec4 vPosition;
 in vec4 vColour;
+in mat4 mTransform;
 uniform mat4 mProjection;
-uniform mat4 mTransform;
+uniform float fPositionUnit;
 out vec4 fcolour;
 
 void main()
 {
-  gl_Position = mProjection * mTransform * vPosition;
+  gl_Position = mProjection * mTransform
+              * vec4( vPosition.xyz * fPositionUnit, 1.0 );
   fcolour = vColour;
 }
\ No newline at end of file
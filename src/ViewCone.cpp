@@ -17,6 +17,7 @@
 // You should have received a copy of the GNU General Public License along
 // with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include "ViewCone.h"
 
 //*---------------------*
@@ -102,6 +103,38 @@ static const gint8* KOffsetMatrices[ (int)EnigmaWC::Direction::TOTAL ] =
   KNone, KNorth, KSouth, KEast, KWest, KAbove, KBelow, KNone
 };
 
+// This array contains the offset (East, Above, North) in map space to the
+// neighbouring room through each surface of a room.
+
+static const gint8 KSurfaceSteps[ (int)EnigmaWC::Direction::TOTAL ][ 3 ] =
+{
+  {  0,  0,  0 },  // None
+  {  0,  0,  1 },  // North
+  {  0,  0, -1 },  // South
+  {  1,  0,  0 },  // East
+  { -1,  0,  0 },  // West
+  {  0,  1,  0 },  // Above
+  {  0, -1,  0 },  // Below
+  {  0,  0,  0 }   // Center
+};
+
+// Faces of a room in the player's view space.  A face with an odd value is
+// opposite the face before it.
+
+#define KRight 0
+#define KLeft  1
+#define KUp    2
+#define KDown  3
+#define KFront 4
+#define KBack  5
+#define KFaces 6
+
+// Reach states of a ViewPoint.
+
+#define KUnreached 0    // ViewPoint cannot be seen.
+#define KSeen      1    // Only a wall facing the viewer can be seen.
+#define KEntered   2    // ViewPoint can be seen through an open face.
+
 // This table contains all valid rotations on a surface.  It is used for
 // randomizing a WaterLayer rotation.  The first index is the Waterlayer
 // object Surface, while the second index is a Rotation selection value.
@@ -137,7 +170,14 @@ CViewCone::CViewCone()
 {  
   // Initialize instance data.
 
-  iDepth = 0;
+  iDepth       = 0;
+  iGridOffsets = NULL;
+  iGridVersion = 0;
+
+  iOriginOffsets    = NULL;
+  iOriginVersion    = 0;
+  iOriginGeneration = 0;
+  iPrefill          = 0;
   
   // Prepare the Outdoor sky objects MapObject.
   
@@ -176,6 +216,7 @@ void CViewCone::SetDepth( gint aDepth )
 {
 	iDepth      = aDepth;
 	iRenderTime = 0;
+	Forget();
 	return;
 }
 
@@ -192,9 +233,43 @@ void CViewCone::SetMap( std::shared_ptr<CMap> aMap )
 	
   iMap    = aMap; 
   iPlayer = iMap->Players().GetActive();
+
+  // The rooms of a previous game map cannot be reused.
+
+  iGridOffsets = NULL;
+  Forget();
 	return;
 }
 
+//*--------------------------------------------------------------*
+//* This method begins preloading the image meshes of all        *
+//* objects in the game map, so they are not loaded while the    *
+//* game is being played.  Upload() must then be called until it *
+//* returns FALSE.                                               *
+//*--------------------------------------------------------------*
+
+void CViewCone::Preload()
+{
+  std::vector<EnigmaWC::ID> IDs;
+
+  iMap->ListIDs( IDs );
+  IDs.push_back( iSkyObjects.iID );
+  iMeshList.Preload( IDs );
+  return;
+}
+
+//*------------------------------------------------------------------*
+//* This method copies preloaded image meshes into the mesh store    *
+//* for a limited time.  The OpenGL context must be current.         *
+//*------------------------------------------------------------------*
+//* RETURN: TRUE if image meshes remain to be copied.                *
+//*------------------------------------------------------------------*
+
+gboolean CViewCone::Upload()
+{
+  return iMeshList.Upload();
+}
+
 //*---------------------------------------------------------------*
 //* This method gets the time taken to render the previous frame. *
 //*---------------------------------------------------------------*
@@ -291,7 +366,7 @@ void CViewCone::Render()
 
     // Layer any Indoor/Outdoor environment regions on the background.
   
-    std::list<std::list<CMapObject>::iterator>::iterator MapObject;
+    std::vector<CMapObjectList::iterator>::iterator MapObject;
 
     if ( !iEnvironments.empty() )
     {
@@ -320,7 +395,8 @@ void CViewCone::Render()
           // SkyObjects to be visible within an Outdoor region.
         
           glStencilFunc(GL_ALWAYS, 0x01, 0xFF);     
-          iMeshList.Render( *(*MapObject), *iPlayer );
+          (*MapObject).Unpack( iUnpacked );
+          iMeshList.Render( iUnpacked, *iPlayer );
           DrawSkyObjects = TRUE;
         }
         else
@@ -329,7 +405,8 @@ void CViewCone::Render()
           // SkyObjects from being visible within an Indoor region.
       
           glStencilFunc(GL_ALWAYS, 0x00, 0xFF);
-          iMeshList.Render( *(*MapObject), *iPlayer );
+          (*MapObject).Unpack( iUnpacked );
+          iMeshList.Render( iUnpacked, *iPlayer );
         }
       }
 
@@ -356,40 +433,47 @@ void CViewCone::Render()
       glDisable( GL_STENCIL_TEST );
     }
 
-    // Render all objects in the appropriate object buffer.
+    // Queue all objects in the appropriate object buffer.  Objects sharing
+    // an image mesh are then rendered together.
 
     for ( MapObject = iObjects.begin();
           MapObject != iObjects.end();
           ++ MapObject )
     {    
-      // Render an object.
+      // Queue an object.  The mesh list draws objects of all kinds, so a
+      // packed map object is unpacked first.
 
-      iMeshList.Render( *(*MapObject), *iPlayer );
+      (*MapObject).Unpack( iUnpacked );
+      iMeshList.Queue( iUnpacked, *iPlayer );
     }
 
-    std::list<std::list<CMapTeleporter>::iterator>::iterator MapTeleporter;
+    std::vector<std::list<CMapTeleporter>::iterator>::iterator MapTeleporter;
   
     for ( MapTeleporter = iTeleporters.begin();
           MapTeleporter != iTeleporters.end();
           ++ MapTeleporter )
     {
-      // Render a teleporter.
+      // Queue a teleporter.
 
-      iMeshList.Render( *(*MapTeleporter), *iPlayer );
+      iMeshList.Queue( *(*MapTeleporter), *iPlayer );
     }
 
-    std::list<std::list<CMapItem>::iterator>::iterator MapItem;
+    std::vector<std::list<CMapItem>::iterator>::iterator MapItem;
     
     for ( MapItem = iItems.begin();
           MapItem != iItems.end();
           ++ MapItem )
     {
-      // Render an item if it has not yet been found.
+      // Queue an item if it has not yet been found.
 
       if ( (*(*MapItem)).iActive )
-        iMeshList.Render( *(*MapItem), *iPlayer );
+        iMeshList.Queue( *(*MapItem), *iPlayer );
     }
 
+    // Render all queued objects, teleporters, and items.
+
+    iMeshList.Flush();
+
     CFinePoint Offset;
 
     // Draw all players except the active one.  This player is not visible
@@ -397,7 +481,7 @@ void CViewCone::Render()
     // map location of the active player is not updated until the end of
     // a transition, so it will not be present in the end view buffer.
     
-    std::list<std::list<CMapPlayer>::iterator>::iterator Player;
+    std::vector<std::list<CMapPlayer>::iterator>::iterator Player;
 
     for ( Player = iPlayers.begin();
           Player != iPlayers.end();
@@ -546,106 +630,708 @@ void CViewCone::Fill( guint8 aSelect )
     Offsets      = KOffsetMatrices[ (int)(*iPlayer).iRotationNext ];
   } 
   
+  // Use the buffers filled while idle if this orientation was expected,
+  // otherwise fill the buffers now.
+
+  if ( !Recall( ViewLocation, Offsets ))
+    Build( ViewLocation, Offsets );
+
+  // Players move between rooms all the time, so they are not kept in the
+  // bricks.  There are only a few players, so each is examined instead.
+  // Players in the same room keep their list order.  The ViewPoint is
+  // combined with the player's list position, since std::stable_sort()
+  // would allocate a temporary buffer.
+
+  typedef std::pair<gint64, std::list<CMapPlayer>::iterator> ViewPlayer;
+  std::list<CMapPlayer>::iterator Player;
+  gint64 Position = 0;
+  gint32 ViewPoint;
+
+  iPlayers.clear();
+  iViewPlayers.clear();
+
+  for ( Player = iMap->Players().begin();
+        Player != iMap->Players().end();
+        ++ Player )
+  {
+    ViewPoint = GetViewPoint( (*Player).iLocation );
+
+    if (( ViewPoint >= 0 ) && ( iCells[ ViewPoint ].iReach != KUnreached ))
+    {
+      iViewPlayers.push_back(
+        std::make_pair(((gint64)ViewPoint << 32 ) | Position, Player ));
+    }
+
+    ++ Position;
+  }
+
+  std::sort( iViewPlayers.begin(),
+             iViewPlayers.end(),
+             []( const ViewPlayer& aFirst, const ViewPlayer& aSecond )
+             { return aFirst.first < aSecond.first; } );
+
+  for ( ViewPlayer& Visible : iViewPlayers )
+    iPlayers.push_back( Visible.second );
+
+  // Randomize rotation of WaterLayer objects in buffer.  This is done
+  // only when the buffer is filled, since randomizing each time a
+  // WaterLayer object is drawn during a transition would be visually
+  // too busy.
+
+  for ( CMapObjectList::iterator& Object : iObjects )
+  {
+    if ( (*Object).iID == EnigmaWC::ID::EWaterLayer )
+    {
+      (*Object).iRotation =
+        (EnigmaWC::Direction)KRotations[ (int)(*Object).iSurface ]
+                                       [ iRandom.get_int_range( 0, 3 ) ];
+    }
+  }
+
+  if ( aSelect == 2 )
+  {
+    // The player is moving to the expected orientation, so the others
+    // will not be needed.
+
+    Forget();
+  }
+  else if (( ViewLocation != iOriginLocation )
+        || ( Offsets != iOriginOffsets )
+        || ( iMap->Bricks().GetVersion() != iOriginVersion )
+        || ( CMapController::GetGeneration() != iOriginGeneration ))
+  {
+    // The player is at a new orientation, or the map has changed.  While
+    // the game is idle, fill the buffers for each orientation that can be
+    // reached by one action.  Regions of a streamed game map may be
+    // evicted while filling, so these are not filled in advance.
+
+    Forget();
+
+    if ( !iMap->Objects().GetStreamed() && ( Offsets != KNone ))
+    {
+      iOriginLocation   = ViewLocation;
+      iOriginOffsets    = Offsets;
+      iOriginVersion    = iMap->Bricks().GetVersion();
+      iOriginGeneration = CMapController::GetGeneration();
+      iPrefill          = 0;
+
+      iPrefillConnection =
+        Glib::signal_idle().connect(
+          sigc::mem_fun( *this, &CViewCone::On_Prefill ),
+          Glib::PRIORITY_DEFAULT_IDLE );
+    }
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method fills the object buffers with the objects *
+//* of all rooms that can be seen from an orientation.            *
+//*---------------------------------------------------------------*
+//* aLocation: Viewer location.                                   *
+//* aOffsets:  Offset matrix of viewer rotation.                  *
+//*---------------------------------------------------------------*
+
+void CViewCone::Build( const CMapLocation& aLocation,
+                       const gint8* aOffsets )
+{
   // Clear old objects from the buffer.
 
   iEnvironments.clear();
   iObjects.clear();
   iTeleporters.clear();
   iItems.clear();
-  iPlayers.clear();
   
-  gint32 MapEast;
-  gint32 MapNorth;
-  gint32 MapAbove;
+  // For a streamed game map, ensure all map regions within the viewing cone
+  // are resident.  Regions may be evicted, so this must follow clearing of
+  // the buffer.
+
+  iMap->Stream( aLocation, iDepth );
+
+  // Find the translation of the viewing cone since the last fill, in the
+  // player's view space.  The rooms of the last fill are reused if the
+  // viewing cone has only moved along the view axes.  A rotation, a new
+  // depth, or changed room contents requires all rooms to be read again.
+
+  CMapBricks& Bricks = iMap->Bricks();
+  
+  gint32 Limit = iDepth - 1;
+  gint32 Width = ( 2 * Limit ) + 1;
+  gint32 Shift[ 3 ];
 
-  // Fill all ViewPoints with object from the game map.  The closest ViewPoints
-  // are filled first (they will be rendered first) in order to fill the OpenGL
-  // Z-Buffer quickly during rendering, hopefully improving performance during
-  // the rasterization process.
+  gint32 East  = (gint32)aLocation.iEast - iGridLocation.iEast;
+  gint32 Above = (gint32)aLocation.iAbove - iGridLocation.iAbove;
+  gint32 North = (gint32)aLocation.iNorth - iGridLocation.iNorth;
 
-  CMapLocation MapLocation; 
-  gint8 ViewFront;
-  gint8 ViewRight;
-  gint8 ViewUp;
+  for ( gint Axis = 0; Axis < 3; ++ Axis )
+  {
+    Shift[ Axis ] = ( East * aOffsets[ Axis ] )
+                  + ( Above * aOffsets[ 3 + Axis ] )
+                  + ( North * aOffsets[ 6 + Axis ] );
+  }
 
-  gint8 Limit = iDepth - 1;
+  gboolean Refill = ( aOffsets != iGridOffsets )
+                 || ( iCells.size() != (gsize)( iDepth * Width * Width ))
+                 || ( Bricks.GetVersion() != iGridVersion )
+                 || ( ABS( Shift[ 0 ] ) >= Width )
+                 || ( ABS( Shift[ 1 ] ) >= Width )
+                 || ( ABS( Shift[ 2 ] ) >= iDepth );
 
-  for ( ViewFront = 0; ViewFront < iDepth; ++ ViewFront )
+  iGridLocation = aLocation;
+  iGridOffsets  = aOffsets;
+  iGridVersion  = Bricks.GetVersion();
+
+  // The lower and upper corners of the viewing cone in view space, with
+  // Right, Up, and Front values.
+
+  gint32 Lower[ 3 ] = { -Limit, -Limit, 0 };
+  gint32 Upper[ 3 ] = { Limit, Limit, Limit };
+
+  if ( Refill )
   {
-    for ( ViewRight = -Limit; ViewRight <= Limit; ++ ViewRight )
-    {  
-      for ( ViewUp = -Limit; ViewUp <= Limit; ++ ViewUp )
-      {   
-        // Determine the map location of the ViewPoint in map space
-        // from the ViewPoint location in the player's view space.
-        
-        MapEast = (guint32)ViewLocation.iEast
-                + ViewRight * Offsets[ 0 ]
-                + ViewUp * Offsets[ 1 ]
-                + ViewFront * Offsets[ 2 ];
-
-        MapAbove = (guint32)ViewLocation.iAbove
-                 + ViewRight * Offsets[ 3 ]
-                 + ViewUp * Offsets[ 4 ]
-                 + ViewFront * Offsets[ 5 ];
-        
-        MapNorth = (guint32)ViewLocation.iNorth
-                 + ViewRight * Offsets[ 6 ]
-                 + ViewUp * Offsets[ 7 ]
-                 + ViewFront * Offsets[ 8 ];
+    // Read the rooms of the whole viewing cone.
+
+    iCells.assign( iDepth * Width * Width, CCell() );
+    Query( Lower, Upper );
+  }
+  else if (( Shift[ 0 ] != 0 ) || ( Shift[ 1 ] != 0 ) || ( Shift[ 2 ] != 0 ))
+  {
+    // Move the rooms still within the viewing cone to their new
+    // ViewPoints, and empty all other ViewPoints.
 
-	      // Skip all ViewPoints that lie beyond the limits of a guint16
-	      // value (outside map boundary limits).
+    std::swap( iCells, iSpareCells );
+    iCells.resize( iSpareCells.size() );
 
-        if  (( MapEast >= 0 ) && ( MapEast <= G_MAXUINT16 )
-          && ( MapNorth >= 0 ) && ( MapNorth <= G_MAXUINT16 )
-          && ( MapAbove >= 0 ) && ( MapAbove <= G_MAXUINT16 ))
+    // Rows of Up ViewPoints are contiguous, so each row is copied at once.
+
+    gint32 UpFirst = MAX( -Limit, -Limit - Shift[ 1 ] );
+    gint32 UpLast  = MIN( Limit, Limit - Shift[ 1 ] );
+    gint32 Row     = 0;
+
+    for ( gint32 Front = 0; Front <= Limit; ++ Front )
+    {
+      for ( gint32 Right = -Limit; Right <= Limit; ++ Right )
+      {
+        std::vector<CCell>::iterator Cells = iCells.begin() + Row;
+        gint32 Source = GetViewPoint( Right + Shift[ 0 ],
+                                      UpFirst + Shift[ 1 ],
+                                      Front + Shift[ 2 ] );
+
+        std::fill( Cells, Cells + Width, CCell() );
+
+        if (( Source >= 0 ) && ( UpFirst <= UpLast ))
         {
-          MapLocation.iEast  = (guint16)MapEast;
-          MapLocation.iNorth = (guint16)MapNorth;
-          MapLocation.iAbove = (guint16)MapAbove;
-
-          iMap->Objects().Read( MapLocation, iObjects );
-          iMap->Teleporters().Read( MapLocation, iTeleporters );
-          iMap->Items().Read( MapLocation, iItems );
-          iMap->Players().Read( MapLocation, iPlayers );
+          std::copy( iSpareCells.begin() + Source,
+                     iSpareCells.begin() + Source + ( UpLast - UpFirst ) + 1,
+                     Cells + UpFirst + Limit );
         }
+
+        Row += Width;
       }
     }
+
+    // Read the rooms of the slab newly exposed along each view axis.
+
+    gint32 SlabLower[ 3 ];
+    gint32 SlabUpper[ 3 ];
+
+    for ( gint Axis = 0; Axis < 3; ++ Axis )
+    {
+      if ( Shift[ Axis ] == 0 )
+        continue;
+
+      std::copy( Lower, Lower + 3, SlabLower );
+      std::copy( Upper, Upper + 3, SlabUpper );
+
+      if ( Shift[ Axis ] > 0 )
+        SlabLower[ Axis ] = Upper[ Axis ] - Shift[ Axis ] + 1;
+      else
+        SlabUpper[ Axis ] = Lower[ Axis ] - Shift[ Axis ] - 1;
+
+      Query( SlabLower, SlabUpper );
+    }
   }
 
-  std::list<std::list<CMapObject>::iterator>::iterator Object;
-  std::list<std::list<CMapObject>::iterator>::iterator NextObject;
-  Object = iObjects.begin();
+  // Find the face of the player's view space matching each map surface.
+
+  guint8 SurfaceFaces[ (int)EnigmaWC::Direction::TOTAL ];
+
+  for ( gint Surface = 0;
+        Surface < (gint)EnigmaWC::Direction::TOTAL;
+        ++ Surface )
+  {
+    SurfaceFaces[ Surface ] = KFaces;
+
+    for ( gint Axis = 0; Axis < 3; ++ Axis )
+    {
+      gint32 Step = ( KSurfaceSteps[ Surface ][ 0 ] * aOffsets[ Axis ] )
+                  + ( KSurfaceSteps[ Surface ][ 1 ] * aOffsets[ 3 + Axis ] )
+                  + ( KSurfaceSteps[ Surface ][ 2 ] * aOffsets[ 6 + Axis ] );
+
+      if ( Step != 0 )
+        SurfaceFaces[ Surface ] = ( 2 * Axis ) + ( Step < 0 );
+    }
+  }
+
+  // Record the faces of each room blocked by an opaque wall.  Walls may
+  // have changed state since the rooms were read, so this is always done
+  // for every room.  The faces of the rooms at the sides of the viewing
+  // cone are also noted, since nothing beyond them is in the viewing cone.
+
+  std::vector<CCell>::iterator Cell = iCells.begin();
+
+  for ( gint32 Front = 0; Front <= Limit; ++ Front )
+  {
+    for ( gint32 Right = -Limit; Right <= Limit; ++ Right )
+    {
+      for ( gint32 Up = -Limit; Up <= Limit; ++ Up )
+      {
+        (*Cell).iWalls = 0;
+        (*Cell).iReach = KUnreached;
+        (*Cell).iEdges = (( Right == Limit ) << KRight )
+                       | (( Right == -Limit ) << KLeft )
+                       | (( Up == Limit ) << KUp )
+                       | (( Up == -Limit ) << KDown )
+                       | (( Front == Limit ) << KFront )
+                       | (( Front == 0 ) << KBack );
+
+        if ( (*Cell).iOccupied )
+          SetWalls( *Cell, SurfaceFaces );
+
+        ++ Cell;
+      }
+    }
+  }
+
+  // Find all ViewPoints that can be seen from the player's ViewPoint, which
+  // is at the back of the viewing cone in the centre.
+
+  Reach( GetViewPoint( 0, 0, 0 ));
+
+  // Fill all ViewPoints with objects from the game map.  The closest
+  // ViewPoints are filled first (they will be rendered first) in order to
+  // fill the OpenGL Z-Buffer quickly during rendering, hopefully improving
+  // performance during the rasterization process.  Rooms hidden behind
+  // walls are skipped.
+
+  for ( Cell = iCells.begin(); Cell != iCells.end(); ++ Cell )
+  {
+    if ( !(*Cell).iOccupied || ( (*Cell).iReach == KUnreached ))
+      continue;
+
+    const CMapBricks::CRoom& Room = (*Cell).iRoom;
+
+    iObjects.insert( iObjects.end(),
+                     Room.iObjects,
+                     Room.iObjects + Room.iObjectCount );
+
+    iTeleporters.insert( iTeleporters.end(),
+                         Room.iTeleporters,
+                         Room.iTeleporters + Room.iTeleporterCount );
+
+    iItems.insert( iItems.end(),
+                   Room.iItems,
+                   Room.iItems + Room.iItemCount );
+  }
+
+  // Move Outdoor and Indoor objects into an environment object buffer.
+  // This avoids a search for these objects in a larger object buffer for
+  // each view transitions frame.  The remaining objects are moved down to
+  // fill the gaps, keeping their order.
+
+  std::vector<CMapObjectList::iterator>::iterator Object;
+  std::vector<CMapObjectList::iterator>::iterator Kept;
+  Kept = iObjects.begin();
   
-  while ( Object != iObjects.end() )
+  for ( Object = iObjects.begin(); Object != iObjects.end(); ++ Object )
   {
     if  (((*(*Object)).iID == EnigmaWC::ID::EOutdoor )
       || ((*(*Object)).iID == EnigmaWC::ID::EIndoor ))
     {
-      // Move Outdoor and Indoor objects into an environment object
-      // buffer.  This avoids a search for these objects in a larger object
-      // buffer for each view transitions frame.
-      
-      NextObject = Object;
-      ++ NextObject;
-      iEnvironments.splice( iEnvironments.end(), iObjects, Object );
-      Object = NextObject;
+      iEnvironments.push_back( *Object );
+      continue;
+    }
+    
+    *Kept = *Object;
+    ++ Kept;
+  }
+
+  iObjects.erase( Kept, iObjects.end() );
+  return;
+}
+
+//*--------------------------------------------------------------*
+//* This private method exchanges the object buffers with those  *
+//* filled in advance for an orientation, if they are still      *
+//* valid.                                                       *
+//*--------------------------------------------------------------*
+//* aLocation: Viewer location.                                  *
+//* aOffsets:  Offset matrix of viewer rotation.                 *
+//* RETURN:    TRUE if the buffers were exchanged.               *
+//*--------------------------------------------------------------*
+
+gboolean CViewCone::Recall( const CMapLocation& aLocation,
+                            const gint8* aOffsets )
+{
+  for ( CSpeculation& Entry : iSpeculations )
+  {
+    // Walls may have opened or closed, or the room contents changed,
+    // since the buffers were filled.
+
+    if ( Entry.iValid
+      && ( Entry.iGridLocation == aLocation )
+      && ( Entry.iGridOffsets == aOffsets )
+      && ( Entry.iGridVersion == iMap->Bricks().GetVersion() )
+      && ( Entry.iGeneration == CMapController::GetGeneration() ))
+    {
+      Exchange( Entry );
+      Entry.iValid = FALSE;
+      return TRUE;
     }
-    else if ( (*(*Object)).iID == EnigmaWC::ID::EWaterLayer )
+  }
+
+  return FALSE;
+}
+
+//*-------------------------------------------------------------*
+//* This private method exchanges the object buffers and rooms  *
+//* with those of an orientation filled in advance.  Only their *
+//* contents are exchanged, so no memory is allocated.          *
+//*-------------------------------------------------------------*
+//* aEntry: Orientation filled in advance.                      *
+//*-------------------------------------------------------------*
+
+void CViewCone::Exchange( CSpeculation& aEntry )
+{
+  std::swap( iEnvironments, aEntry.iEnvironments );
+  std::swap( iObjects, aEntry.iObjects );
+  std::swap( iTeleporters, aEntry.iTeleporters );
+  std::swap( iItems, aEntry.iItems );
+  std::swap( iCells, aEntry.iCells );
+  std::swap( iGridLocation, aEntry.iGridLocation );
+  std::swap( iGridOffsets, aEntry.iGridOffsets );
+  std::swap( iGridVersion, aEntry.iGridVersion );
+  return;
+}
+
+//*---------------------------------------------------------*
+//* This private method discards all orientations filled in *
+//* advance, and stops filling any more.                    *
+//*---------------------------------------------------------*
+
+void CViewCone::Forget()
+{
+  iPrefillConnection.disconnect();
+
+  for ( CSpeculation& Entry : iSpeculations )
+    Entry.iValid = FALSE;
+
+  iOriginOffsets = NULL;
+  return;
+}
+
+//*-----------------------------------------------------------------*
+//* This method is a signal handler called while the game is idle.  *
+//* It fills the buffers for one orientation that can be reached    *
+//* from the player's orientation by a single action: moving Front, *
+//* Back, Right or Left, or turning Right or Left.                  *
+//*-----------------------------------------------------------------*
+//* RETURN: TRUE if more orientations remain to be filled.          *
+//*-----------------------------------------------------------------*
+
+bool CViewCone::On_Prefill()
+{
+  CSpeculation& Entry   = iSpeculations[ iPrefill ];
+  CMapLocation Location = iOriginLocation;
+  const gint8* Offsets  = iOriginOffsets;
+  gint32 Sign           = ( iPrefill & 1 ) ? -1 : 1;
+
+  if ( iPrefill < 4 )
+  {
+    // Move one room along the Front or Right axis of the view space.
+
+    gint Axis    = ( iPrefill < 2 ) ? 2 : 0;
+    gint32 East  = (gint32)Location.iEast + ( Sign * Offsets[ Axis ] );
+    gint32 Above = (gint32)Location.iAbove + ( Sign * Offsets[ 3 + Axis ] );
+    gint32 North = (gint32)Location.iNorth + ( Sign * Offsets[ 6 + Axis ] );
+
+    if (( East < 0 ) || ( East > G_MAXUINT16 )
+      || ( Above < 0 ) || ( Above > G_MAXUINT16 )
+      || ( North < 0 ) || ( North > G_MAXUINT16 ))
     {
-      // Randomize rotation of WaterLayer objects in buffer.  This is done
-      // only when the buffer is filled, since randomizing each time a
-      // WaterLayer object is drawn during a transition would be visually
-      // too busy.
-      
-      (*(*Object)).iRotation =
-        (EnigmaWC::Direction)KRotations[ (int)(*(*Object)).iSurface ]
-                                       [ iRandom.get_int_range( 0, 3 ) ];
-      ++ Object;
+      Offsets = NULL;
+    }
+
+    Location.iEast  = (guint16)East;
+    Location.iAbove = (guint16)Above;
+    Location.iNorth = (guint16)North;
+  }
+  else
+  {
+    // Turn to face the Right or Left axis of the view space.
+
+    Offsets = NULL;
+
+    for ( gint Rotation = 0;
+          Rotation < (gint)EnigmaWC::Direction::TOTAL;
+          ++ Rotation )
+    {
+      const gint8* Turned = KOffsetMatrices[ Rotation ];
+
+      if (( Turned[ 2 ] == Sign * iOriginOffsets[ 0 ] )
+        && ( Turned[ 5 ] == Sign * iOriginOffsets[ 3 ] )
+        && ( Turned[ 8 ] == Sign * iOriginOffsets[ 6 ] ))
+      {
+        Offsets = Turned;
+      }
+    }
+  }
+
+  if ( Offsets != NULL )
+  {
+    // Fill the buffers as if the player had taken the action.  The rooms
+    // of the current view are copied first, so those still within the
+    // viewing cone are reused.
+
+    Entry.iCells        = iCells;
+    Entry.iGridLocation = iGridLocation;
+    Entry.iGridOffsets  = iGridOffsets;
+    Entry.iGridVersion  = iGridVersion;
+
+    Exchange( Entry );
+    Build( Location, Offsets );
+    Exchange( Entry );
+
+    Entry.iGeneration = CMapController::GetGeneration();
+    Entry.iValid      = TRUE;
+  }
+
+  ++ iPrefill;
+  return ( iPrefill < KSpeculations );
+}
+
+//*----------------------------------------------------------------*
+//* This private method returns the ViewPoint of a position in the *
+//* player's view space, in the order ViewPoints are filled.       *
+//*----------------------------------------------------------------*
+//* aRight: Right offset from the viewer.                          *
+//* aUp:    Up offset from the viewer.                             *
+//* aFront: Front offset from the viewer.                          *
+//* RETURN: ViewPoint, or -1 if outside the viewing cone.          *
+//*----------------------------------------------------------------*
+
+gint32 CViewCone::GetViewPoint( gint32 aRight, gint32 aUp, gint32 aFront )
+{
+  gint32 Limit = iDepth - 1;
+  gint32 Width = ( 2 * Limit ) + 1;
+
+  if (( aFront < 0 ) || ( aFront > Limit )
+    || ( aRight < -Limit ) || ( aRight > Limit )
+    || ( aUp < -Limit ) || ( aUp > Limit ))
+  {
+    return -1;
+  }
+
+  return ((( aFront * Width ) + aRight + Limit ) * Width ) + aUp + Limit;
+}
+
+//*----------------------------------------------------------------*
+//* This private method returns the ViewPoint of a map location.   *
+//* The transposed offset matrix reverses the mapping from view    *
+//* space to map space.                                            *
+//*----------------------------------------------------------------*
+//* aLocation: Map location.                                       *
+//* RETURN:    ViewPoint, or -1 if outside the viewing cone.       *
+//*----------------------------------------------------------------*
+
+gint32 CViewCone::GetViewPoint( const CMapLocation& aLocation )
+{
+  gint32 East  = (gint32)aLocation.iEast - iGridLocation.iEast;
+  gint32 Above = (gint32)aLocation.iAbove - iGridLocation.iAbove;
+  gint32 North = (gint32)aLocation.iNorth - iGridLocation.iNorth;
+
+  return GetViewPoint( ( East * iGridOffsets[ 0 ] )
+                       + ( Above * iGridOffsets[ 3 ] )
+                       + ( North * iGridOffsets[ 6 ] ),
+                       ( East * iGridOffsets[ 1 ] )
+                       + ( Above * iGridOffsets[ 4 ] )
+                       + ( North * iGridOffsets[ 7 ] ),
+                       ( East * iGridOffsets[ 2 ] )
+                       + ( Above * iGridOffsets[ 5 ] )
+                       + ( North * iGridOffsets[ 8 ] ));
+}
+
+//*----------------------------------------------------------------*
+//* This private method reads the occupied rooms in a box of the   *
+//* player's view space into their ViewPoints.                     *
+//*----------------------------------------------------------------*
+//* aLower: Lower corner of box (Right, Up, Front).                *
+//* aUpper: Upper corner of box (Right, Up, Front).                *
+//*----------------------------------------------------------------*
+
+void CViewCone::Query( const gint32 aLower[ 3 ], const gint32 aUpper[ 3 ] )
+{
+  // Find the box of map locations enclosing the view space box.  The
+  // offset matrix rows are East, Above, and North, while the columns are
+  // Right, Up, and Front.  Map locations beyond the limits of a guint16
+  // value (outside map boundary limits) are excluded.
+
+  const gint32 Origin[ 3 ] = { iGridLocation.iEast,
+                               iGridLocation.iAbove,
+                               iGridLocation.iNorth };
+  gint32 Lower[ 3 ];
+  gint32 Upper[ 3 ];
+
+  for ( gint Row = 0; Row < 3; ++ Row )
+  {
+    Lower[ Row ] = Origin[ Row ];
+    Upper[ Row ] = Origin[ Row ];
+
+    for ( gint Column = 0; Column < 3; ++ Column )
+    {
+      gint32 First  = iGridOffsets[ 3 * Row + Column ] * aLower[ Column ];
+      gint32 Second = iGridOffsets[ 3 * Row + Column ] * aUpper[ Column ];
+
+      Lower[ Row ] += MIN( First, Second );
+      Upper[ Row ] += MAX( First, Second );
+    }
+
+    // Skip a box lying entirely outside the map boundary limits.
+
+    if (( Upper[ Row ] < 0 ) || ( Lower[ Row ] > G_MAXUINT16 ))
+      return;
+
+    Lower[ Row ] = CLAMP( Lower[ Row ], 0, G_MAXUINT16 );
+    Upper[ Row ] = CLAMP( Upper[ Row ], 0, G_MAXUINT16 );
+  }
+
+  CMapLocation LowerLocation( Lower[ 0 ], Lower[ 2 ], Lower[ 1 ] );
+  CMapLocation UpperLocation( Upper[ 0 ], Upper[ 2 ], Upper[ 1 ] );
+
+  iRooms.clear();
+  iMap->Bricks().Read( LowerLocation, UpperLocation, iRooms );
+
+  gint32 ViewPoint;
+
+  for ( const CMapBricks::CRoom& Room : iRooms )
+  {
+    ViewPoint = GetViewPoint( Room.iLocation );
+
+    if ( ViewPoint >= 0 )
+    {
+      iCells[ ViewPoint ].iRoom     = Room;
+      iCells[ ViewPoint ].iOccupied = TRUE;
+    }
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method records the faces of a room closed by an  *
+//* opaque wall.  A WoodDoor is only opaque while closed          *
+//* (active), like the PlayRoom treats it.                        *
+//*---------------------------------------------------------------*
+//* aCell:         ViewPoint of the room.                         *
+//* aSurfaceFaces: Face matching each map surface.                *
+//*---------------------------------------------------------------*
+
+void CViewCone::SetWalls( CCell& aCell, const guint8* aSurfaceFaces )
+{
+  for ( guint16 Index = 0; Index < aCell.iRoom.iObjectCount; ++ Index )
+  {
+    CMapObjectList::CObject Object = *aCell.iRoom.iObjects[ Index ];
+    gboolean Opaque;
+
+    switch ( Object.iID )
+    {
+      case EnigmaWC::ID::EBlockWall:
+      case EnigmaWC::ID::EStoneWall:
+      case EnigmaWC::ID::EWoodWall:
+      case EnigmaWC::ID::EEarthWall:
+        Opaque = TRUE;
+        break;
+
+      case EnigmaWC::ID::EWoodDoor:
+        Opaque = Object.iState.GetState();
+        break;
+
+      default:
+        Opaque = FALSE;
+        break;
+    }
+
+    if ( Opaque
+      && Object.iPresence.GetState()
+      && Object.iVisibility.GetState()
+      && ( aSurfaceFaces[ (int)Object.iSurface ] < KFaces ))
+    {
+      aCell.iWalls |= 1 << aSurfaceFaces[ (int)Object.iSurface ];
+    }
+  }
+
+  return;
+}
+
+//*---------------------------------------------------------------*
+//* This private method finds all ViewPoints that can be seen     *
+//* from a ViewPoint, by spreading front to back through the open *
+//* faces of the rooms in the viewing cone.  A face is closed by  *
+//* an opaque wall on either side.  A room with a wall facing the *
+//* viewer is seen, but nothing beyond the wall is.               *
+//*---------------------------------------------------------------*
+//* aViewPoint: ViewPoint of the viewer.                          *
+//*---------------------------------------------------------------*
+
+void CViewCone::Reach( gint32 aViewPoint )
+{
+  gint32 Width = ( 2 * iDepth ) - 1;
+
+  // Find the change of ViewPoint through each face.
+
+  const gint32 Strides[ KFaces ] =
+  {
+    Width, -Width, 1, -1, Width * Width, -( Width * Width )
+  };
+
+  iQueue.clear();
+  iQueue.push_back( aViewPoint );
+  iCells[ aViewPoint ].iReach = KEntered;
+
+  // The queue is read in the order it is filled.
+
+  for ( gsize Next = 0; Next < iQueue.size(); ++ Next )
+  {
+    gint32 ViewPoint = iQueue[ Next ];
+
+    // Nothing can be seen through a wall of this room, or beyond the
+    // viewing cone.
+
+    guint8 Closed = iCells[ ViewPoint ].iWalls | iCells[ ViewPoint ].iEdges;
+
+    for ( gint Face = 0; Face < KFaces; ++ Face )
+    {
+      if ( Closed & ( 1 << Face ))
+        continue;
+
+      gint32 Neighbour = ViewPoint + Strides[ Face ];
+      CCell& Cell      = iCells[ Neighbour ];
+
+      if ( Cell.iReach == KEntered )
+        continue;
+
+      // Only the wall can be seen in a neighbouring room with a wall on
+      // the opposite face.
+
+      if ( Cell.iWalls & ( 1 << ( Face ^ 1 )))
+        Cell.iReach = KSeen;
+      else
+      {
+        Cell.iReach = KEntered;
+        iQueue.push_back( Neighbour );
+      }
     }
-    else
-      ++ Object;
   }
 
   return;
@@ -24,6 +24,8 @@
 #include "MeshList.h"
 #include "Map.h"
 
+#define KSpeculations 6   // Orientations reached by one player action.
+
 class CViewCone : public sigc::trackable
 {
   public:        
@@ -32,12 +34,54 @@ class CViewCone : public sigc::trackable
     CViewCone();
     void SetDepth( gint aDepth );
     void SetMap( std::shared_ptr<CMap> aMap );
+    void Preload();
+    gboolean Upload();
     gint64 GetRenderTime();
     void Fill( guint8 aSelect );
     void Render();
     void Initialize();
 
   private:
+    // Private classes.
+
+    class CCell
+    {
+      public:
+        CMapBricks::CRoom iRoom;         // Room contents.
+        gboolean iOccupied = FALSE;      // TRUE if the room has contents.
+        guint8 iWalls = 0;               // Faces closed by walls.
+        guint8 iEdges = 0;               // Faces at sides of viewing cone.
+        guint8 iReach = 0;               // Reach state.
+    };
+
+    class CSpeculation
+    {
+      public:
+        std::vector<CMapObjectList::iterator> iEnvironments;
+        std::vector<CMapObjectList::iterator> iObjects;
+        std::vector<std::list<CMapTeleporter>::iterator> iTeleporters;
+        std::vector<std::list<CMapItem>::iterator> iItems;
+        std::vector<CCell> iCells;          // ViewPoints of viewing cone.
+        CMapLocation iGridLocation;         // Viewer location of cells.
+        const gint8* iGridOffsets = NULL;   // Offset matrix of cells.
+        guint64 iGridVersion = 0;           // Brick version of cells.
+        guint64 iGeneration = 0;            // Signal generation of walls.
+        gboolean iValid = FALSE;            // TRUE if buffers can be used.
+    };
+
+    // Private methods.
+
+    void Build( const CMapLocation& aLocation, const gint8* aOffsets );
+    gboolean Recall( const CMapLocation& aLocation, const gint8* aOffsets );
+    void Exchange( CSpeculation& aEntry );
+    void Forget();
+    bool On_Prefill();
+    gint32 GetViewPoint( gint32 aRight, gint32 aUp, gint32 aFront );
+    gint32 GetViewPoint( const CMapLocation& aLocation );
+    void Query( const gint32 aLower[ 3 ], const gint32 aUpper[ 3 ] );
+    void SetWalls( CCell& aCell, const guint8* aSurfaceFaces );
+    void Reach( gint32 aViewPoint );
+
     // Private data.
 
     std::shared_ptr<CMap> iMap;                // Game map being viewed.
@@ -47,15 +91,41 @@ class CViewCone : public sigc::trackable
     gint64 iRenderTime;                        // Rendering time.
     Glib::Rand iRandom;                        // Random number generator.
    
-    // View objects and lists.
+    // View objects and buffers.  The buffers are vectors that keep their
+    // capacity, so filling and rendering the same view again does not
+    // allocate memory.
     
     CMapObject iSkyObjects;
     CMapObject iUseObject;
-    std::list<std::list<CMapObject>::iterator> iEnvironments;
-    std::list<std::list<CMapObject>::iterator> iObjects;
-    std::list<std::list<CMapTeleporter>::iterator> iTeleporters;
-    std::list<std::list<CMapItem>::iterator> iItems;
-    std::list<std::list<CMapPlayer>::iterator> iPlayers;
+    CMapObject iUnpacked;                      // Map object being drawn.
+    std::vector<CMapObjectList::iterator> iEnvironments;
+    std::vector<CMapObjectList::iterator> iObjects;
+    std::vector<std::list<CMapTeleporter>::iterator> iTeleporters;
+    std::vector<std::list<CMapItem>::iterator> iItems;
+    std::vector<std::list<CMapPlayer>::iterator> iPlayers;
+
+    // Working buffers used while filling.
+
+    std::vector<CMapBricks::CRoom> iRooms;
+    std::vector<std::pair<gint64,
+                          std::list<CMapPlayer>::iterator>> iViewPlayers;
+    std::vector<CCell> iCells;                 // ViewPoints of viewing cone.
+    std::vector<CCell> iSpareCells;            // ViewPoints of last fill.
+    std::vector<gint32> iQueue;                // ViewPoints being reached.
+    CMapLocation iGridLocation;                // Viewer location of cells.
+    const gint8* iGridOffsets;                 // Offset matrix of cells.
+    guint64 iGridVersion;                      // Brick version of cells.
+
+    // Orientations reached by one action from the player's orientation,
+    // filled while the game is idle.
+
+    CSpeculation iSpeculations[ KSpeculations ];
+    CMapLocation iOriginLocation;              // Viewer location when idle.
+    const gint8* iOriginOffsets;               // Offset matrix when idle.
+    guint64 iOriginVersion;                    // Brick version when idle.
+    guint64 iOriginGeneration;                 // Signal generation when idle.
+    gint iPrefill;                             // Next orientation to fill.
+    sigc::connection iPrefillConnection;       // Idle fill connection.
 };
 
 #endif /* VIEWCONE_H_ */